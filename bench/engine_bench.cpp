@@ -0,0 +1,70 @@
+// bench/engine_bench.cpp
+// Масштабирование пакетного вычисления по числу потоков.
+// Использование: engine_bench [строк] [максимум потоков] [выражение от x и y]
+#include "../src/engine/compiled_expr.hpp"
+#include "../src/engine/dispatch.hpp"
+#include "../src/engine/parallel_batch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000000;
+    size_t max_threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : default_thread_count();
+    std::string expr = argc > 3 ? argv[3] : "sqrt(x^2+y^2)*sin(x)+ln(|y|+1)";
+
+    std::vector<double> xs(rows), ys(rows), out(rows);
+    std::vector<uint64_t> mask(error_mask_words(rows));
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> dist(-100.0, 100.0);
+    for (size_t r = 0; r < rows; ++r)
+    {
+        xs[r] = dist(rng);
+        ys[r] = dist(rng);
+    }
+    const double *columns[] = {xs.data(), ys.data()};
+
+    std::printf("expr: %s\nrows: %zu\n%s\n\n", expr.c_str(), rows,
+                std::string(simd_level_name(active_simd_level())).c_str());
+    for (Accuracy accuracy : {Accuracy::STRICT, Accuracy::FAST})
+    {
+        CompileOptions options;
+        options.accuracy = accuracy;
+        CompiledExpr compiled(expr, {"x", "y"}, options);
+        std::printf("accuracy: %s\n%8s %10s %12s %8s %8s\n", accuracy == Accuracy::FAST ? "fast" : "strict",
+                    "threads", "ms", "Mrows/s", "speedup", "eff");
+        double base = 0.0;
+        for (size_t threads = 1; threads <= max_threads; ++threads)
+        {
+            ThreadPool pool(threads);
+            ParallelBatchEvaluator batch(compiled.program(), pool);
+            batch.evaluate(columns, rows, out.data(), mask.data()); // прогрев
+            double best = 1e30;
+            for (int rep = 0; rep < 3; ++rep)
+            {
+                auto start = std::chrono::steady_clock::now();
+                batch.evaluate(columns, rows, out.data(), mask.data());
+                best = std::min(best, seconds_since(start));
+            }
+            if (threads == 1)
+                base = best;
+            std::printf("%8zu %10.1f %12.1f %8.2f %7.0f%%\n", threads, best * 1e3, double(rows) / best / 1e6,
+                        base / best, 100.0 * base / best / double(threads));
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
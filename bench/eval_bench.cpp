@@ -0,0 +1,66 @@
+// bench/eval_bench.cpp
+// Стоимость одного вызова eval_func: значение double напрямую против
+// прежнего пути через запись в 15 символов и std::stod.
+// Использование: eval_bench [вызовов]
+#include "../src/calc.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Прежний eval_func: значение проходило через format_number и обратно
+    double eval_round_trip(const std::string &input)
+    {
+        EvalResult result = try_eval_func(input);
+        if (!result)
+            throw CalcError(error_message(result, input));
+        return std::stod(format_number(result.value));
+    }
+
+    template <class F>
+    double ns_per_call(const std::vector<std::string> &exprs, size_t calls, F &&eval)
+    {
+        double sink = 0.0;
+        double best = 1e30;
+        for (int rep = 0; rep < 3; ++rep)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t k = 0; k < calls; ++k)
+                sink += eval(exprs[k % exprs.size()]);
+            best = std::min(best, seconds_since(start));
+        }
+        if (sink == 0.125) // не даёт компилятору выбросить вычисления
+            std::printf(" ");
+        return best * 1e9 / double(calls);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    size_t calls = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const std::vector<std::string> exprs = {
+        "1+2*3",
+        "sqrt(2)*sin(30')+ln(10)",
+        "(1.5+2.25)^3/7",
+        "log(1024,2)+abs(-4)!",
+        "pi*e/phi-0.1",
+    };
+
+    double direct = ns_per_call(exprs, calls, [](const std::string &s)
+                                { return eval_func(s); });
+    double round_trip = ns_per_call(exprs, calls, eval_round_trip);
+    std::printf("%-16s %10s\n", "", "ns/call");
+    std::printf("%-16s %10.1f\n", "eval_func", direct);
+    std::printf("%-16s %10.1f\n", "format + stod", round_trip);
+    std::printf("%-16s %10.1f\n", "saving", round_trip - direct);
+    return 0;
+}
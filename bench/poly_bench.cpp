@@ -0,0 +1,87 @@
+// bench/poly_bench.cpp
+// Многочлены: исходное дерево со степенями против схем Горнера и Эстрина,
+// которые строятся в режиме fast-math. Время на одно значение в ВМ, JIT и
+// пакете (один поток).
+// Использование: poly_bench [строк]
+#include "../src/engine/batch.hpp"
+#include "../src/engine/compiled_expr.hpp"
+#include "../src/engine/jit.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template <class F>
+    double ns_per_row(size_t rows, F &&run)
+    {
+        run(); // прогрев
+        double best = 1e30;
+        for (int rep = 0; rep < 3; ++rep)
+        {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            best = std::min(best, seconds_since(start));
+        }
+        return best * 1e9 / double(rows);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    struct Poly
+    {
+        int degree;
+        const char *expr;
+    };
+    const Poly polys[] = {
+        {3, "3*x^3-2*x^2+x-7"},
+        {6, "0.5*x^6-1.25*x^5+2*x^4-x^3+0.75*x^2-3*x+1"},
+        {12, "x^12/12-x^11/11+x^10/10-x^9/9+x^8/8-x^7/7+x^6/6-x^5/5+x^4/4-x^3/3+x^2/2-x"},
+    };
+
+    std::vector<double> xs(rows), out(rows);
+    std::vector<uint64_t> mask(error_mask_words(rows));
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (double &x : xs)
+        x = dist(rng);
+    const double *columns[] = {xs.data()};
+
+    std::printf("rows: %zu, ns/row\n%-8s %-7s %8s %8s %8s\n", rows, "degree", "mode", "vm", "jit", "batch");
+    for (const Poly &poly : polys)
+    {
+        for (bool fast : {false, true})
+        {
+            CompileOptions options;
+            options.fast_math = fast;
+            CompiledExpr compiled(poly.expr, {"x"}, options);
+            double vm = ns_per_row(rows, [&]
+                                   {
+                                       for (size_t r = 0; r < rows; ++r)
+                                           compiled.try_evaluate(&xs[r], out[r]); });
+            double jit = 0.0;
+            if (auto code = JitCode::compile(compiled.program()))
+                jit = ns_per_row(rows, [&]
+                                 {
+                                     for (size_t r = 0; r < rows; ++r)
+                                         code->run(&xs[r], out[r]); });
+            BatchEvaluator batch(compiled.program());
+            double packed = ns_per_row(rows, [&]
+                                       { batch.evaluate(columns, rows, out.data(), mask.data()); });
+            // с 8-й степени вместо Горнера строится схема Эстрина
+            const char *mode = !fast ? "tree" : poly.degree >= 8 ? "estrin" : "horner";
+            std::printf("%-8d %-7s %8.2f %8.2f %8.2f\n", poly.degree, mode, vm, jit, packed);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+/* include/fast_calc.h */
+#ifndef FAST_CALC_H
+#define FAST_CALC_H
+
+/*
+ * Стабильный C ABI вычислительного ядра fast_calc (библиотека fast_calc_core).
+ * Исключения C++ не пересекают границу: ошибки возвращаются кодами.
+ * Новые функции добавляются только в конец, существующие не меняются;
+ * FAST_CALC_ABI_VERSION растёт при несовместимых изменениях.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(FAST_CALC_SHARED)
+#ifdef FAST_CALC_BUILDING
+#define FAST_CALC_API __declspec(dllexport)
+#else
+#define FAST_CALC_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define FAST_CALC_API __attribute__((visibility("default")))
+#else
+#define FAST_CALC_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FAST_CALC_ABI_VERSION 1
+
+/* Результат вычисления: 0 — успех, 1..16 — ошибка области определения */
+enum fast_calc_status
+{
+    FAST_CALC_OK = 0,
+    FAST_CALC_DIV_ZERO,
+    FAST_CALC_ZERO_POW_ZERO,
+    FAST_CALC_FACT_INVALID,
+    FAST_CALC_FACT_NEGATIVE,
+    FAST_CALC_FACT_NON_INTEGER,
+    FAST_CALC_FACT_TOO_LARGE,
+    FAST_CALC_TAN_POLE,
+    FAST_CALC_ASIN_RANGE,
+    FAST_CALC_ACOS_RANGE,
+    FAST_CALC_SQRT_NEGATIVE,
+    FAST_CALC_LN_DOMAIN,
+    FAST_CALC_LG_DOMAIN,
+    FAST_CALC_ROOT_ZERO_DEGREE,
+    FAST_CALC_ROOT_EVEN_NEGATIVE,
+    FAST_CALC_LOG_DOMAIN,
+    FAST_CALC_LOG_BASE,
+    /* неверные аргументы вызова */
+    FAST_CALC_INVALID = 255
+};
+
+/* Флаги fast_calc_compile */
+#define FAST_CALC_FLAG_JIT 1u       /* машинный код, если JIT собран */
+#define FAST_CALC_FLAG_FAST_MATH 2u /* полиномиальные ядра в пакетном режиме и упрощения fast-math */
+
+typedef struct fast_calc_expr fast_calc_expr;
+
+FAST_CALC_API int fast_calc_abi_version(void);
+
+/*
+ * Разбирает и компилирует выражение с переменными variables[0..var_count).
+ * При ошибке возвращает NULL и, если error не NULL, записывает в него текст
+ * ошибки (UTF-8, с завершающим нулём, обрезается до error_size).
+ */
+FAST_CALC_API fast_calc_expr *fast_calc_compile(const char *expr, const char *const *variables, size_t var_count,
+                                                unsigned flags, char *error, size_t error_size);
+
+FAST_CALC_API size_t fast_calc_var_count(const fast_calc_expr *expr);
+
+/*
+ * Вычисляет выражение над values (по значению на переменную). Возвращает
+ * fast_calc_status; при ошибке *result = NaN. Можно вызывать одновременно
+ * из разных потоков для одного выражения.
+ */
+FAST_CALC_API int fast_calc_eval(const fast_calc_expr *expr, const double *values, double *result);
+
+/*
+ * Вычисляет выражение для rows строк: columns[v] — rows значений переменной v.
+ * out — rows результатов (NaN для строк с ошибкой), status (может быть NULL) —
+ * код каждой строки. Возвращает число строк с ошибкой. Использует буферы
+ * выражения: одновременные вызовы для одного выражения недопустимы.
+ */
+FAST_CALC_API size_t fast_calc_eval_batch(fast_calc_expr *expr, const double *const *columns, size_t rows,
+                                          double *out, uint8_t *status);
+
+/* Текст ошибки для кода fast_calc_status (UTF-8, статическая строка) */
+FAST_CALC_API const char *fast_calc_error_message(int status);
+
+FAST_CALC_API void fast_calc_free(fast_calc_expr *expr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAST_CALC_H */
@@ -2,36 +2,82 @@
 // Выполняет Иванов Константин и Копать Пётр
 #include "AST.hpp"
 
-using std::make_shared;
-using std::move;
-using std::shared_ptr;
 using std::string;
-using std::vector;
+using std::string_view;
 
+// Все функции калькулятора принимают не больше двух аргументов;
+// лишние аргументы только подсчитываются для сообщения об арности
+static constexpr uint32_t kMaxArgs = 2;
+
+// Разбор без исключений: при ошибке функции возвращают kFail, а первая
+// ошибка записывается в error; вызывающий проверяет результат каждого шага
 class Parser
 {
 public:
-    Parser(const vector<Token> &tt) : t(tt) {}
+    static constexpr uint32_t kFail = UINT32_MAX;
+
+    Parser(ArenaSpan<const Token> tt, Ast &out, const std::vector<string> *vars, EvalError &error)
+        : t(tt), ast(out), vars(vars), error(error) {}
 
-    shared_ptr<Node> parse()
+    bool parse()
     {
         auto n = parseExpr();
+        if (n == kFail)
+            return false;
         if (!end())
-            throw CalcError("Лишние токены в конце выражения");
-        return n;
+            return fail(CalcErrc::TRAILING, i, t[i].text.size()) != kFail;
+        return true;
     }
 
+    // Участок выражения, на который указывает ошибка
+    string_view fragment() const { return fragment_; }
+
 private:
-    const vector<Token> &t;
+    ArenaSpan<const Token> t;
+    Ast &ast;
+    const std::vector<string> *vars;
+    EvalError &error;
+    string_view fragment_;
     size_t i = 0;
 
-    bool end() const { return i >= t.size(); }
-    const Token &peek() const
+    bool find_var(string_view name, uint8_t &out) const
     {
-        if (end())
-            throw CalcError("Неожиданный конец выражения");
-        return t[i];
+        if (!vars)
+            return false;
+        for (size_t k = 0; k < vars->size(); ++k)
+            if ((*vars)[k] == name)
+            {
+                out = uint8_t(k);
+                return true;
+            }
+        return false;
+    }
+
+    // Позиция токена k; за последним токеном — конец выражения
+    uint32_t pos_at(size_t k) const
+    {
+        if (k < t.size)
+            return t[k].pos;
+        return t.size ? uint32_t(t[t.size - 1].pos + t[t.size - 1].text.size()) : 0;
     }
+
+    uint32_t fail(CalcErrc code, size_t token, size_t length = 0)
+    {
+        error.code = code;
+        error.position = pos_at(token);
+        error.length = uint32_t(length);
+        fragment_ = length ? t[token].text : string_view();
+        return kFail;
+    }
+
+    // Узел добавляется после своих детей, поэтому массив получается в пост-порядке
+    uint32_t emit(NodeOp op, size_t token, uint8_t id = 0, uint32_t a = 0, uint32_t b = 0, double number = 0.0)
+    {
+        ast.nodes.push_back(AstNode{op, id, {a, b}, t[token].pos, number});
+        return static_cast<uint32_t>(ast.nodes.size() - 1);
+    }
+
+    bool end() const { return i >= t.size; }
     bool eat(TokType tp)
     {
         if (!end() && t[i].type == tp)
@@ -41,7 +87,7 @@ private:
         }
         return false;
     }
-    bool eatOp(const string &s)
+    bool eatOp(string_view s)
     {
         if (!end() && t[i].type == TokType::OP && t[i].text == s)
         {
@@ -52,23 +98,24 @@ private:
     }
 
     // expr := add
-    shared_ptr<Node> parseExpr() { return parseAdd(); }
+    uint32_t parseExpr() { return parseAdd(); }
 
     // add := mul (('+'|'-') mul)*
-    shared_ptr<Node> parseAdd()
+    uint32_t parseAdd()
     {
         auto n = parseMul();
-        while (!end())
+        while (n != kFail && !end())
         {
+            size_t op = i;
             if (eatOp("+"))
             {
                 auto r = parseMul();
-                n = Node::binary("+", n, r);
+                n = r == kFail ? kFail : emit(NodeOp::ADD, op, 0, n, r);
             }
             else if (eatOp("-"))
             {
                 auto r = parseMul();
-                n = Node::binary("-", n, r);
+                n = r == kFail ? kFail : emit(NodeOp::SUB, op, 0, n, r);
             }
             else
                 break;
@@ -77,20 +124,21 @@ private:
     }
 
     // mul := pow (('*'|'/') pow)*
-    shared_ptr<Node> parseMul()
+    uint32_t parseMul()
     {
         auto n = parsePow();
-        while (!end())
+        while (n != kFail && !end())
         {
+            size_t op = i;
             if (eatOp("*"))
             {
                 auto r = parsePow();
-                n = Node::binary("*", n, r);
+                n = r == kFail ? kFail : emit(NodeOp::MUL, op, 0, n, r);
             }
             else if (eatOp("/"))
             {
                 auto r = parsePow();
-                n = Node::binary("/", n, r);
+                n = r == kFail ? kFail : emit(NodeOp::DIV, op, 0, n, r);
             }
             else
                 break;
@@ -99,153 +147,191 @@ private:
     }
 
     // pow := unary ('^' pow)?   // правая ассоциативность
-    shared_ptr<Node> parsePow()
+    uint32_t parsePow()
     {
         auto left = parseUnary();
-        if (eatOp("^"))
+        size_t op = i;
+        if (left != kFail && eatOp("^"))
         {
             auto right = parsePow();
-            return Node::binary("^", left, right);
+            return right == kFail ? kFail : emit(NodeOp::POW, op, 0, left, right);
         }
         return left;
     }
 
     // unary := ('+'|'-') unary | postfix
-    shared_ptr<Node> parseUnary()
+    uint32_t parseUnary()
     {
+        size_t op = i;
         if (eatOp("+"))
-            return Node::unary("u+", parseUnary());
+        {
+            auto n = parseUnary();
+            return n == kFail ? kFail : emit(NodeOp::POS, op, 0, n);
+        }
         if (eatOp("-"))
-            return Node::unary("u-", parseUnary());
+        {
+            auto n = parseUnary();
+            return n == kFail ? kFail : emit(NodeOp::NEG, op, 0, n);
+        }
         return parsePostfix();
     }
 
     // postfix := primary ('!')*
-    shared_ptr<Node> parsePostfix()
+    uint32_t parsePostfix()
     {
         auto n = parsePrimary();
-        while (!end() && t[i].type == TokType::FACT)
+        while (n != kFail && !end() && t[i].type == TokType::FACT)
         {
+            n = emit(NodeOp::FACT, i, 0, n);
             ++i;
-            n = Node::unary("!", n);
         }
         return n;
     }
 
-    // primary := NUMBER | CONST | FUNC '(' args ')' | '(' expr ')' | '|' expr '|'
-    shared_ptr<Node> parsePrimary()
+    // primary := NUMBER | CONST | VAR | FUNC '(' args ')' | '(' expr ')' | '|' expr '|'
+    uint32_t parsePrimary()
     {
         if (end())
-            throw CalcError("Ожидалось выражение");
+            return fail(CalcErrc::EXPECTED_EXPR, i);
 
+        size_t first = i;
         if (t[i].type == TokType::NUMBER)
         {
             double v = t[i].value;
             ++i;
-            return Node::num(v);
+            return emit(NodeOp::NUMBER, first, 0, 0, 0, v);
+        }
+
+        if (t[i].type == TokType::CONST)
+        {
+            uint8_t c = t[i].id;
+            ++i;
+            return emit(NodeOp::CONST, first, c);
         }
 
         if (t[i].type == TokType::IDENT)
         {
-            string id = t[i].text;
+            string_view id = t[i].text;
+            ++i;
+            uint8_t var;
+            if (!find_var(id, var))
+                return fail(CalcErrc::UNKNOWN_NAME, first, id.size());
+            return emit(NodeOp::VAR, first, var);
+        }
+
+        // функция: '(' args ')'
+        if (t[i].type == TokType::FUNC)
+        {
+            FuncId f = FuncId(t[i].id);
             ++i;
-            if (isConstName(id))
-                return Node::cnst(id);
-            // функция: '(' args ')'
-            if (!isFuncName(id))
-                throw CalcError("Неизвестная функция или константа: " + id);
             if (!eat(TokType::LPAREN))
-                throw CalcError("Ожидалась '(' после имени функции");
-            vector<shared_ptr<Node>> args;
+                return fail(CalcErrc::EXPECTED_LPAREN, i);
+            uint32_t args[kMaxArgs] = {0, 0};
+            uint32_t argc = 0;
             if (!eat(TokType::RPAREN))
             {
                 while (true)
                 {
-                    args.push_back(parseExpr());
+                    uint32_t arg = parseExpr();
+                    if (arg == kFail)
+                        return kFail;
+                    if (argc < kMaxArgs)
+                        args[argc] = arg;
+                    ++argc;
                     if (eat(TokType::RPAREN))
                         break;
                     if (!eat(TokType::COMMA))
-                        throw CalcError("Ожидалась ',' или ')' в списке аргументов функции");
+                        return fail(CalcErrc::EXPECTED_SEPARATOR, i);
                 }
             }
-            // проверка арности
-            if (id == "pow" || id == "root" || id == "log")
-            {
-                if (args.size() != 2)
-                    throw CalcError("Функция " + id + " требует ровно 2 аргумента");
-            }
-            else if (id == "sin" || id == "cos" || id == "tan" || id == "asin" || id == "acos" || id == "atan" || id == "sqrt" || id == "ln" || id == "lg" || id == "abs")
-            {
-                if (args.size() != 1)
-                    throw CalcError("Функция " + id + " требует ровно 1 аргумент");
-            }
-            return Node::call(id, move(args));
+            // проверка арности по таблице функций
+            uint8_t arity = func_info(f).arity;
+            if (argc != arity)
+                return fail(arity == 2 ? CalcErrc::ARITY_TWO : CalcErrc::ARITY_ONE, first, t[first].text.size());
+            return emit(NodeOp::CALL, first, uint8_t(f), args[0], args[1]);
         }
 
         if (eat(TokType::LPAREN))
         {
             auto n = parseExpr();
+            if (n == kFail)
+                return kFail;
             if (!eat(TokType::RPAREN))
-                throw CalcError("Скобки не сбалансированы: ожидается ')'");
+                return fail(CalcErrc::UNBALANCED, i);
             return n;
         }
 
         if (eat(TokType::BAR))
         {
             auto inner = parseExpr();
+            if (inner == kFail)
+                return kFail;
             if (!eat(TokType::BAR))
-                throw CalcError("Отсутствует закрывающий символ '|'");
-            vector<shared_ptr<Node>> a;
-            a.push_back(inner);
-            return Node::call("abs", move(a));
+                return fail(CalcErrc::UNCLOSED_BAR, i);
+            return emit(NodeOp::CALL, first, uint8_t(FuncId::ABS), inner);
         }
 
-        throw CalcError("Ожидалось число, константа, функция или '('");
+        return fail(CalcErrc::EXPECTED_OPERAND, i);
     }
 };
 
-shared_ptr<Node> Node::num(double v)
+bool parsing_to_ast(ArenaSpan<const Token> tokens, Ast &out, EvalError &error,
+                    const std::vector<string> *variables)
 {
-    auto n = make_shared<Node>();
-    n->type = NodeType::NUMBER;
-    n->number = v;
-    return n;
+    out.nodes.clear();
+    if (variables && variables->size() > kMaxVariables)
+    {
+        error = EvalError{CalcErrc::TOO_MANY_VARIABLES};
+        return false;
+    }
+    Parser p(tokens, out, variables, error);
+    return p.parse();
 }
 
-shared_ptr<Node> Node::cnst(const string &name)
+static void parse_or_throw(ArenaSpan<const Token> tokens, Ast &out, const std::vector<string> *variables)
 {
-    auto n = make_shared<Node>();
-    n->type = NodeType::CONST;
-    n->const_name = name;
-    return n;
+    out.nodes.clear();
+    EvalError error;
+    if (variables && variables->size() > kMaxVariables)
+        throw CalcError(error_message(EvalError{CalcErrc::TOO_MANY_VARIABLES}, {}));
+    Parser p(tokens, out, variables, error);
+    if (!p.parse())
+        throw CalcError(error_message(error, p.fragment()));
 }
-shared_ptr<Node> Node::unary(const string &o, shared_ptr<Node> a)
+
+void parsing_to_ast(ArenaSpan<const Token> tokens, Ast &out)
 {
-    auto n = make_shared<Node>();
-    n->type = NodeType::UNARY;
-    n->op = o;
-    n->kids = {move(a)};
-    return n;
+    parse_or_throw(tokens, out, nullptr);
 }
-shared_ptr<Node> Node::binary(const string &o, shared_ptr<Node> a, shared_ptr<Node> b)
+
+void parsing_to_ast(ArenaSpan<const Token> tokens, Ast &out, const std::vector<string> &variables)
 {
-    auto n = make_shared<Node>();
-    n->type = NodeType::BINARY;
-    n->op = o;
-    n->kids = {move(a), move(b)};
-    return n;
+    parse_or_throw(tokens, out, &variables);
 }
-shared_ptr<Node> Node::call(const string &name, vector<shared_ptr<Node>> args)
+
+bool is_valid_variable_name(string_view name)
 {
-    auto n = make_shared<Node>();
-    n->type = NodeType::CALL;
-    n->op = name;
-    n->kids = move(args);
-    return n;
+    if (name.empty() || !isLowerAlpha(name[0]))
+        return false;
+    for (char c : name)
+        if (!isLowerAlpha(c) && !(c >= '0' && c <= '9'))
+            return false;
+    return lookup_name(name).kind == NameKind::NONE;
 }
 
-shared_ptr<Node> parsing_to_ast(const vector<Token> &tokens)
+std::vector<string> referenced_names(const string &expr)
 {
-    Parser p(tokens);
-    return p.parse();
-}
\ No newline at end of file
+    Arena arena;
+    std::vector<string> names;
+    for (const Token &t : lexing(expr, arena))
+    {
+        if (t.type != TokType::IDENT)
+            continue;
+        bool seen = false;
+        for (const string &name : names)
+            seen = seen || name == t.text;
+        if (!seen)
+            names.emplace_back(t.text);
+    }
+    return names;
+}
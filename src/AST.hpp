@@ -1,35 +1,105 @@
 // src/AST.hpp
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <memory>
 
+#include "names.hpp"
 #include "token.hpp"
+#include "engine/arena.hpp"
+#include "engine/domain.hpp"
 
-enum class NodeType
+enum class NodeOp : uint8_t
 {
     NUMBER,
     CONST,
-    UNARY,
-    BINARY,
+    VAR, // id — индекс переменной
+    POS, // унарный '+'
+    NEG, // унарный '-'
+    FACT,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    POW,
     CALL
 };
 
-struct Node
+// Узел плоского AST. Узлы хранятся в пост-порядке: дети всегда
+// стоят раньше родителя, корень — последний элемент массива. Каждый узел
+// достижим из корня; после share_subexpressions у узла может быть несколько
+// родителей, и дерево становится DAG.
+struct AstNode
 {
-    NodeType type;
-    std::string op;                          // "+","-","*","/","^","!","u+","u-" или имя функции (для CALL)
-    double number{};                         // для NUMBER
-    std::string const_name;                  // для CONST
-    std::vector<std::shared_ptr<Node>> kids; // аргументы/подузлы
-
-    static std::shared_ptr<Node> num(double v);
-    static std::shared_ptr<Node> cnst(const std::string &name);
-    static std::shared_ptr<Node> unary(const std::string &o, std::shared_ptr<Node> a);
-    static std::shared_ptr<Node> binary(const std::string &o, std::shared_ptr<Node> a, std::shared_ptr<Node> b);
-    static std::shared_ptr<Node> call(const std::string &name, std::vector<std::shared_ptr<Node>> args);
+    NodeOp op;
+    uint8_t id;        // FuncId для CALL, ConstId для CONST, индекс для VAR
+    uint32_t kids[2];  // индексы детей (у унарных узлов и функций одного аргумента — только kids[0])
+    uint32_t pos;      // смещение токена в выражении без пробелов (для сообщений об ошибках)
+    double number;     // для NUMBER
 };
+static_assert(sizeof(AstNode) == 24, "AstNode должен оставаться компактным");
 
-std::shared_ptr<Node> parsing_to_ast(const std::vector<Token> &tokens);
-std::string executing(const std::shared_ptr<Node> &ast);
\ No newline at end of file
+// Число детей узла: 0 у листьев, 2 у бинарных операций и функций двух аргументов
+inline uint32_t kid_count(const AstNode &n)
+{
+    switch (n.op)
+    {
+    case NodeOp::NUMBER:
+    case NodeOp::CONST:
+    case NodeOp::VAR:
+        return 0;
+    case NodeOp::POS:
+    case NodeOp::NEG:
+    case NodeOp::FACT:
+        return 1;
+    case NodeOp::CALL:
+        return func_info(FuncId(n.id)).arity;
+    default:
+        return 2;
+    }
+}
+
+// Не больше 256 переменных: индекс хранится в AstNode::id
+static constexpr size_t kMaxVariables = 256;
+
+struct Ast
+{
+    std::vector<AstNode> nodes;
+
+    uint32_t root() const { return static_cast<uint32_t>(nodes.size() - 1); }
+    const AstNode &operator[](uint32_t i) const { return nodes[i]; }
+};
+
+// Разбирает токены в out (предыдущее содержимое отбрасывается, ёмкость сохраняется).
+// Идентификаторы из variables становятся узлами VAR с индексом в этом списке.
+// Бросает CalcError.
+void parsing_to_ast(ArenaSpan<const Token> tokens, Ast &out);
+void parsing_to_ast(ArenaSpan<const Token> tokens, Ast &out, const std::vector<std::string> &variables);
+// То же без исключений: при ошибке возвращает false и заполняет error
+bool parsing_to_ast(ArenaSpan<const Token> tokens, Ast &out, EvalError &error,
+                    const std::vector<std::string> *variables = nullptr);
+
+// true, если имя можно использовать как переменную: строчные латинские
+// буквы и цифры, не совпадает с функцией или константой
+bool is_valid_variable_name(std::string_view name);
+
+// Имена переменных, которые встречаются в expr, без повторов и в порядке
+// первого появления. Нужно, чтобы связать с выражением только его столбцы
+// из широкой таблицы: переменных не больше kMaxVariables. Лексическая
+// ошибка — CalcError.
+std::vector<std::string> referenced_names(const std::string &expr);
+
+double get_const(ConstId c);
+// Операция узла над уже вычисленными детьми a и b (лишние аргументы не
+// используются). При ошибке области определения возвращает NaN и код в code.
+// VAR здесь не вычисляется: значение переменной знает только вызывающий
+double apply_node(const AstNode &n, double a, double b, ErrorCode &code);
+// Эталонное вычисление обходом дерева (каждый узел — один раз); vars — значения переменных.
+// Бросает CalcError при ошибке области определения.
+double evaluate(const Ast &ast, const double *vars = nullptr);
+// То же без исключений: при ошибке возвращает NaN и заполняет error
+// (код DOMAIN, позиция узла с первой ошибкой в порядке вычисления)
+double evaluate(const Ast &ast, const double *vars, EvalError &error);
+std::string executing(const Ast &ast);
@@ -0,0 +1,136 @@
+// src/c_api.cpp
+#include "fast_calc.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+
+#include "engine/batch.hpp"
+#include "engine/compiled_expr.hpp"
+
+static_assert(FAST_CALC_LOG_BASE == int(ErrorCode::LOG_BASE) && FAST_CALC_LOG_BASE + 1 == int(ErrorCode::COUNT),
+              "fast_calc_status должен повторять ErrorCode");
+
+struct fast_calc_expr
+{
+    CompiledExpr compiled;
+    std::unique_ptr<BatchEvaluator> batch; // создаётся при первом пакетном вызове
+    std::vector<uint64_t> mask;
+    std::vector<ErrorCode> codes;
+};
+
+namespace
+{
+    // Строк за один вызов BatchEvaluator: ограничивает буферы маски и кодов
+    constexpr size_t kBatchStep = kBatchBlock * 32;
+
+    void copy_error(char *error, size_t error_size, const char *text)
+    {
+        if (!error || error_size == 0)
+            return;
+        size_t n = std::min(std::strlen(text), error_size - 1);
+        // обрезается по границе символа UTF-8
+        while (n > 0 && (uint8_t(text[n]) & 0xC0) == 0x80)
+            --n;
+        std::memcpy(error, text, n);
+        error[n] = '\0';
+    }
+} // namespace
+
+extern "C" {
+
+int fast_calc_abi_version(void) { return FAST_CALC_ABI_VERSION; }
+
+fast_calc_expr *fast_calc_compile(const char *expr, const char *const *variables, size_t var_count,
+                                  unsigned flags, char *error, size_t error_size)
+{
+    if (!expr || (var_count && !variables))
+    {
+        copy_error(error, error_size, "Неверные аргументы");
+        return nullptr;
+    }
+    try
+    {
+        std::vector<std::string> names;
+        for (size_t k = 0; k < var_count; ++k)
+            names.emplace_back(variables[k] ? variables[k] : "");
+        CompileOptions options;
+        options.use_jit = (flags & FAST_CALC_FLAG_JIT) != 0;
+        options.accuracy = (flags & FAST_CALC_FLAG_FAST_MATH) ? Accuracy::FAST : Accuracy::STRICT;
+        options.fast_math = (flags & FAST_CALC_FLAG_FAST_MATH) != 0;
+        return new fast_calc_expr{CompiledExpr(expr, std::move(names), options), nullptr, {}, {}};
+    }
+    catch (const std::bad_alloc &)
+    {
+        copy_error(error, error_size, "Недостаточно памяти");
+    }
+    catch (const std::exception &e)
+    {
+        copy_error(error, error_size, e.what());
+    }
+    return nullptr;
+}
+
+size_t fast_calc_var_count(const fast_calc_expr *expr)
+{
+    return expr ? expr->compiled.variables().size() : 0;
+}
+
+int fast_calc_eval(const fast_calc_expr *expr, const double *values, double *result)
+{
+    if (!expr || !result || (!values && !expr->compiled.variables().empty()))
+        return FAST_CALC_INVALID;
+    ErrorCode code = expr->compiled.try_evaluate(values, *result);
+    if (code != ErrorCode::OK)
+        *result = std::numeric_limits<double>::quiet_NaN();
+    return int(code);
+}
+
+size_t fast_calc_eval_batch(fast_calc_expr *expr, const double *const *columns, size_t rows,
+                            double *out, uint8_t *status)
+{
+    if (!expr || !out || (!columns && !expr->compiled.variables().empty()))
+        return rows;
+    try
+    {
+        if (!expr->batch)
+            expr->batch = std::make_unique<BatchEvaluator>(expr->compiled.program());
+        const size_t vars = expr->compiled.variables().size();
+        std::vector<const double *> shifted(vars);
+        size_t failed = 0;
+        for (size_t first = 0; first < rows; first += kBatchStep)
+        {
+            size_t n = std::min(kBatchStep, rows - first);
+            for (size_t v = 0; v < vars; ++v)
+                shifted[v] = columns[v] + first;
+            expr->mask.resize(error_mask_words(n));
+            expr->codes.resize(n);
+            failed += expr->batch->evaluate(shifted.data(), n, out + first, expr->mask.data(),
+                                            status ? expr->codes.data() : nullptr);
+            if (status)
+                for (size_t r = 0; r < n; ++r)
+                    status[first + r] = uint8_t(expr->codes[r]);
+        }
+        return failed;
+    }
+    catch (...)
+    {
+        // выделение буферов — единственное, что здесь может бросить
+        return rows;
+    }
+}
+
+const char *fast_calc_error_message(int status)
+{
+    if (status == FAST_CALC_INVALID)
+        return "Неверные аргументы";
+    if (status < 0 || status >= int(ErrorCode::COUNT))
+        return error_message(ErrorCode::COUNT);
+    return error_message(ErrorCode(status));
+}
+
+void fast_calc_free(fast_calc_expr *expr) { delete expr; }
+
+} // extern "C"
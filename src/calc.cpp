@@ -1,8 +1,13 @@
 // src/calc.cpp
 // Выполняет Тычина Ян
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 
 #include "AST.hpp"
+#include "engine/expr_cache.hpp"
+#include "engine/optimize.hpp"
 
 using std::cout;
 
@@ -17,7 +22,7 @@ static void init()
     show_menu();
 }
 
-static void debug1(const std::vector<Token> &tokens)
+static void debug1(ArenaSpan<const Token> tokens)
 {
     cout << "\nDEBUG 1: \n";
     for (const auto &token : tokens)
@@ -28,44 +33,152 @@ static void debug1(const std::vector<Token> &tokens)
     }
 }
 
-static void debug2_rec(const std::shared_ptr<Node> &node, int depth = 0)
+static void debug2(const Ast &ast)
 {
-    if (!node)
-        return;
-    for (int i = 0; i < depth; ++i)
-        cout << "  ";
-    cout << "Тип узла: " << static_cast<int>(node->type)
-         << "\tОперация/Имя: \"" << node->op << "\""
-         << "\tЗначение: " << node->number
-         << "\tИмя константы: " << node->const_name << "\n";
-    for (const auto &kid : node->kids)
+    cout << "\nDEBUG 2: \n";
+    for (uint32_t i = 0; i < ast.nodes.size(); ++i)
     {
-        debug2_rec(kid, depth + 1);
+        const AstNode &node = ast[i];
+        cout << i << ": Операция: " << static_cast<int>(node.op)
+             << "\tИдентификатор: " << static_cast<int>(node.id)
+             << "\tДети: " << node.kids[0] << ", " << node.kids[1]
+             << "\tЗначение: " << node.number << "\n";
     }
+    cout << "\n\n";
 }
 
-static void debug2(const std::shared_ptr<Node> &node)
+static const char *const kCalcMessages[] = {
+    "",
+    "Длина выражения превышает 128 символов",
+    "Неверный формат числа",
+    "Двойная точка в числе",
+    "Разрешены только строчные латинские буквы в именах функций и констант",
+    "Недопустимый символ: ",
+    "Лишние токены в конце выражения",
+    "Ожидалось выражение",
+    "Неизвестная функция или константа: ",
+    "Ожидалась '(' после имени функции",
+    "Ожидалась ',' или ')' в списке аргументов функции",
+    " требует ровно 1 аргумент",
+    " требует ровно 2 аргумента",
+    "Скобки не сбалансированы: ожидается ')'",
+    "Отсутствует закрывающий символ '|'",
+    "Ожидалось число, константа, функция или '('",
+    "Слишком много переменных",
+    "",
+    "Результат не является числом",
+    "Результат слишком велик по модулю",
+};
+static_assert(sizeof(kCalcMessages) / sizeof(kCalcMessages[0]) == size_t(CalcErrc::COUNT), "таблица сообщений не соответствует CalcErrc");
+
+std::string error_message(const EvalError &error, std::string_view fragment)
 {
-    cout << "\nDEBUG 2: \n";
-    debug2_rec(node, 0);
-    cout << "\n\n";
+    switch (error.code)
+    {
+    case CalcErrc::DOMAIN:
+        return error_message(error.domain);
+    case CalcErrc::BAD_CHAR:
+    case CalcErrc::UNKNOWN_NAME:
+        return kCalcMessages[size_t(error.code)] + std::string(fragment);
+    case CalcErrc::ARITY_ONE:
+    case CalcErrc::ARITY_TWO:
+        return "Функция " + std::string(fragment) + kCalcMessages[size_t(error.code)];
+    default:
+        if (error.code >= CalcErrc::COUNT)
+            return "Неизвестная ошибка";
+        return kCalcMessages[size_t(error.code)];
+    }
 }
 
-double eval_func(const std::string &input)
+std::string error_message(const EvalResult &result, std::string_view input)
 {
+    // Фрагмент ищется заново: позиция указывает в исходную строку,
+    // а имя в ней может быть разорвано пробелами
+    std::string fragment;
+    for (size_t k = result.error.position; k < input.size() && fragment.size() < result.error.length; ++k)
+        if (!isspace((unsigned char)input[k]))
+            fragment += input[k];
+    return error_message(result.error, fragment);
+}
 
-    // init();
-    // std::string input;
+// Позиция ошибки в строке без пробелов переводится в позицию в input
+static EvalResult fail_at(std::string_view input, EvalResult result)
+{
+    size_t compact = 0, k = 0;
+    for (; k < input.size(); ++k)
+        if (!isspace((unsigned char)input[k]) && compact++ == result.error.position)
+            break;
+    result.error.position = uint32_t(k);
+    result.value = std::numeric_limits<double>::quiet_NaN();
+    return result;
+}
 
-    // if (!std::getline(std::cin, input))
-    // {
-    //     throw std::runtime_error("Фатальная ошибка: не удалось прочитать ввод");
-    // }
+static void check_finite(EvalResult &result)
+{
+    if (result.error.code != CalcErrc::OK)
+        return;
+    if (std::isnan(result.value))
+        result.error.code = CalcErrc::NOT_A_NUMBER;
+    else if (std::isinf(result.value))
+        result.error.code = CalcErrc::TOO_LARGE;
+}
+
+EvalResult try_eval_func(std::string_view input)
+{
+    static thread_local Arena arena;
+    static thread_local Ast ast;
+    Arena::Scope scope(arena);
+
+    EvalResult result;
+    EvalError &error = result.error;
+    std::string_view s = removing_spaces(input, arena);
+
+    // Повторное выражение берётся из кэша без разбора. Ошибка области
+    // определения в байт-коде не несёт позиции, поэтому за ней выражение
+    // разбирается заново и вычисляется обходом дерева
+    ExprCache &cache = expr_cache();
+    char *tagged = arena.allocate_array<char>(s.size() + 1);
+    tagged[0] = ExprCache::kEvalTag;
+    std::copy(s.begin(), s.end(), tagged + 1);
+    std::string_view key(tagged, s.size() + 1);
+    if (auto compiled = cache.find(key))
+    {
+        if (compiled->try_evaluate(nullptr, result.value) == ErrorCode::OK)
+        {
+            check_finite(result);
+            return error.code == CalcErrc::OK ? result : fail_at(input, result);
+        }
+    }
 
-    std::vector<Token> tokens = lexing(input);
-    // debug1(tokens);
-    std::shared_ptr<Node> ast = parsing_to_ast(tokens);
-    // debug2(ast);
-    std::string output = executing(ast);
-    return std::stod(output);
+    ArenaSpan<const Token> tokens;
+    if (lexing(s, arena, tokens, error) && parsing_to_ast(tokens, ast, error))
+    {
+        fold_constants(ast);
+        simplify(ast);
+        share_subexpressions(ast);
+        result.value = evaluate(ast, nullptr, error);
+        check_finite(result);
+        if (error.code == CalcErrc::OK && cache.budget() != 0)
+        {
+            try
+            {
+                cache.insert(key, std::make_shared<const CompiledExpr>(ast));
+            }
+            catch (const CalcError &)
+            {
+                // не компилируется в байт-код — остаётся без кэша
+            }
+        }
+    }
+    if (error.code == CalcErrc::OK)
+        return result;
+    return fail_at(input, result);
+}
+
+double eval_func(const std::string &input)
+{
+    EvalResult result = try_eval_func(input);
+    if (!result)
+        throw CalcError(error_message(result, input));
+    return result.value;
 }
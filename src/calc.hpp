@@ -1,25 +1,90 @@
 // src/calc.hpp
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <stdexcept>
-#include <unordered_set>
+
+#include "engine/domain.hpp"
+#include "names.hpp"
 
 struct CalcError : std::runtime_error
 {
     using std::runtime_error::runtime_error;
 };
 
-static bool isLowerAlpha(char c) { return c >= 'a' && c <= 'z'; }
-static bool isFuncName(const std::string &id)
+inline bool isLowerAlpha(char c) { return c >= 'a' && c <= 'z'; }
+inline bool isFuncName(std::string_view id) { return lookup_name(id).kind == NameKind::FUNC; }
+inline bool isConstName(std::string_view id) { return lookup_name(id).kind == NameKind::CONST; }
+
+// Причина неудачи вычисления строки. Ошибки области определения
+// уточняются через ErrorCode, остальные полностью описываются кодом.
+enum class CalcErrc : uint8_t
 {
-    static const std::unordered_set<std::string> f = {
-        "sin", "cos", "tan", "asin", "acos", "atan", "sqrt", "pow", "root", "ln", "lg", "log", "abs"};
-    return f.count(id);
-}
-static bool isConstName(const std::string &id)
+    OK = 0,
+    TOO_LONG,          // длиннее 128 символов без пробелов
+    BAD_NUMBER,
+    DOUBLE_DOT,
+    UPPERCASE,         // заглавная буква в имени
+    BAD_CHAR,
+    TRAILING,          // лишние токены в конце
+    EXPECTED_EXPR,
+    UNKNOWN_NAME,
+    EXPECTED_LPAREN,
+    EXPECTED_SEPARATOR,
+    ARITY_ONE,         // функции нужен ровно 1 аргумент
+    ARITY_TWO,         // функции нужно ровно 2 аргумента
+    UNBALANCED,
+    UNCLOSED_BAR,
+    EXPECTED_OPERAND,
+    TOO_MANY_VARIABLES,
+    DOMAIN,            // см. EvalError::domain
+    NOT_A_NUMBER,      // результат NaN
+    TOO_LARGE,         // результат бесконечен
+    COUNT
+};
+
+// Ошибка без исключения: код и место в выражении. Текст не хранится,
+// его строит error_message() только по запросу.
+struct EvalError
+{
+    CalcErrc code = CalcErrc::OK;
+    ErrorCode domain = ErrorCode::OK;
+    uint32_t position = 0; // смещение фрагмента в байтах
+    uint32_t length = 0;   // длина фрагмента (имя функции, символ)
+};
+
+// Результат try_eval_func: значение либо ошибка
+struct EvalResult
 {
-    return id == "pi" || id == "e" || id == "phi";
-}
+    double value = 0.0;
+    EvalError error;
+
+    bool ok() const { return error.code == CalcErrc::OK; }
+    explicit operator bool() const { return ok(); }
+};
+
+// Текст ошибки; fragment — участок выражения, на который указывает ошибка
+std::string error_message(const EvalError &error, std::string_view fragment);
+// Текст ошибки try_eval_func; input — то же выражение, что вычислялось
+std::string error_message(const EvalResult &result, std::string_view input);
+
+// Вычисление без исключений для ошибок разбора и области определения;
+// позиция ошибки отсчитывается в исходной строке input
+EvalResult try_eval_func(std::string_view input);
+// Бросает CalcError с текстом ошибки. Возвращает значение без округления:
+// запись для показа строит format_number
+double eval_func(const std::string &input);
+
+static constexpr size_t kMaxNumberLen = 15;
+
+// Запись числа не длиннее kMaxNumberLen символов: %g с наибольшей
+// точностью (до 15 знаков), при которой запись помещается. Пишет в buf
+// (не меньше kMaxNumberLen байт, без завершающего нуля) и возвращает длину;
+// x должен быть конечным. Память не выделяет.
+size_t format_number(double x, char *buf);
+// То же строкой; бросает CalcError для NaN и бесконечности
+std::string format_number(double x);
 
-double eval_func(const std::string &input);
\ No newline at end of file
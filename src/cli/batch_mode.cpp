@@ -0,0 +1,327 @@
+// src/cli/batch_mode.cpp
+#include "batch_mode.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../AST.hpp"
+
+namespace
+{
+    // Пачка — единица работы потока и переупорядочивания
+    constexpr size_t kChunkLines = 1024;
+    constexpr size_t kChunkBytes = 64 * 1024;
+    // Пачек в работе на один поток вычисления
+    constexpr size_t kChunksPerWorker = 4;
+    // Более длинная строка не может быть корректным выражением: её остаток
+    // пропускается без буферизации, а в выход пишется ошибка
+    constexpr size_t kMaxLineBytes = 4096;
+    constexpr size_t kReadBuffer = 1 << 20;
+
+    struct Line
+    {
+        size_t offset;
+        size_t size;
+        bool too_long;
+    };
+
+    struct Chunk
+    {
+        uint64_t seq = 0;
+        std::string text;
+        std::vector<Line> lines;
+        std::string out;
+        size_t failed = 0;
+    };
+
+    // Чтение строк блоками фиксированного размера
+    class LineReader
+    {
+    public:
+        explicit LineReader(std::FILE *in) : in_(in), buf_(kReadBuffer) {}
+
+        // Дописывает следующую строку (без '\n') в text; false в конце входа
+        bool next(std::string &text, Line &line)
+        {
+            line = Line{text.size(), 0, false};
+            bool any = false;
+            while (true)
+            {
+                if (pos_ == end_ && !refill())
+                    return any;
+                any = true;
+                const char *begin = buf_.data() + pos_;
+                const char *nl = static_cast<const char *>(std::memchr(begin, '\n', end_ - pos_));
+                size_t take = nl ? size_t(nl - begin) : end_ - pos_;
+                if (!line.too_long)
+                {
+                    if (line.size + take > kMaxLineBytes)
+                    {
+                        line.too_long = true;
+                        text.resize(line.offset);
+                        line.size = 0;
+                    }
+                    else
+                    {
+                        text.append(begin, take);
+                        line.size += take;
+                    }
+                }
+                pos_ += take;
+                if (nl)
+                {
+                    ++pos_;
+                    return true;
+                }
+            }
+        }
+
+    private:
+        // Короткое чтение — конец входа, только если это не ошибка: иначе
+        // выход молча обрезался бы
+        bool refill()
+        {
+            pos_ = 0;
+            end_ = std::fread(buf_.data(), 1, buf_.size(), in_);
+            if (end_ == 0 && std::ferror(in_))
+                throw std::runtime_error("Ошибка чтения входа");
+            return end_ > 0;
+        }
+
+        std::FILE *in_;
+        std::vector<char> buf_;
+        size_t pos_ = 0;
+        size_t end_ = 0;
+    };
+
+    // Разбор и вычисление одной строки без исключений: в грязных данных
+    // ошибочных строк много, и раскрутка стека стоила бы дороже вычисления
+    bool evaluate_line(std::string_view line, std::string &out)
+    {
+        EvalResult result = try_eval_func(line);
+        if (!result)
+        {
+            out += "error: ";
+            out += error_message(result, line);
+            return false;
+        }
+        char buf[kMaxNumberLen];
+        out.append(buf, format_number(result.value, buf));
+        return true;
+    }
+
+    class Pipeline
+    {
+    public:
+        Pipeline(std::FILE *in, std::FILE *out, ThreadPool &pool)
+            : reader_(in), out_(out), pool_(pool), slots_(pool.size() * kChunksPerWorker)
+        {
+            for (size_t k = 0; k < slots_.size(); ++k)
+            {
+                chunks_.push_back(std::make_unique<Chunk>());
+                free_.push_back(chunks_.back().get());
+            }
+        }
+
+        StreamStats run()
+        {
+            std::thread reader([this]
+                               { read_all(); });
+            std::thread writer([this]
+                               { write_all(); });
+            // Исключения остаются в error_: потоки reader и writer должны
+            // быть присоединены при любом исходе
+            try
+            {
+                pool_.parallel_for(pool_.size(), [this](size_t, size_t)
+                                   { work(); });
+            }
+            catch (...)
+            {
+                fail(std::current_exception());
+            }
+            reader.join();
+            writer.join();
+            if (error_)
+                std::rethrow_exception(error_);
+            return stats_;
+        }
+
+    private:
+        // Первая ошибка останавливает все стадии: ожидания проверяют error_
+        void fail(std::exception_ptr error)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_)
+                error_ = error;
+            free_cv_.notify_all();
+            work_cv_.notify_all();
+            done_cv_.notify_all();
+        }
+
+        void read_all()
+        {
+            uint64_t seq = 0;
+            try
+            {
+                while (true)
+                {
+                    Chunk *c;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        free_cv_.wait(lock, [this]
+                                      { return !free_.empty() || error_; });
+                        if (error_)
+                            break;
+                        c = free_.back();
+                        free_.pop_back();
+                    }
+                    c->text.clear();
+                    c->lines.clear();
+                    Line line;
+                    while (c->lines.size() < kChunkLines && c->text.size() < kChunkBytes &&
+                           reader_.next(c->text, line))
+                        c->lines.push_back(line);
+
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (c->lines.empty())
+                    {
+                        free_.push_back(c);
+                        break;
+                    }
+                    c->seq = seq++;
+                    work_.push_back(c);
+                    work_cv_.notify_one();
+                }
+            }
+            catch (...)
+            {
+                fail(std::current_exception());
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            total_ = seq;
+            input_done_ = true;
+            work_cv_.notify_all();
+            done_cv_.notify_all();
+        }
+
+        void work()
+        {
+            try
+            {
+                work_chunks();
+            }
+            catch (...)
+            {
+                fail(std::current_exception());
+            }
+        }
+
+        void work_chunks()
+        {
+            while (true)
+            {
+                Chunk *c;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    work_cv_.wait(lock, [this]
+                                  { return !work_.empty() || input_done_ || error_; });
+                    if (work_.empty() || error_)
+                        return;
+                    c = work_.front();
+                    work_.pop_front();
+                }
+                c->out.clear();
+                c->failed = 0;
+                for (const Line &line : c->lines)
+                {
+                    std::string_view text(c->text.data() + line.offset, line.size);
+                    if (!text.empty() && text.back() == '\r')
+                        text.remove_suffix(1);
+                    if (line.too_long)
+                    {
+                        c->out += "error: Строка слишком длинная";
+                        ++c->failed;
+                    }
+                    else if (text.find_first_not_of(" \t") != std::string_view::npos)
+                        c->failed += !evaluate_line(text, c->out);
+                    c->out += '\n';
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                slots_[c->seq % slots_.size()] = c;
+                done_cv_.notify_all();
+            }
+        }
+
+        void write_all()
+        {
+            try
+            {
+                write_chunks();
+            }
+            catch (...)
+            {
+                fail(std::current_exception());
+            }
+        }
+
+        void write_chunks()
+        {
+            for (uint64_t next = 0;; ++next)
+            {
+                Chunk *c;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    Chunk *&slot = slots_[next % slots_.size()];
+                    done_cv_.wait(lock, [&]
+                                  { return (slot && slot->seq == next) || (input_done_ && next >= total_) || error_; });
+                    if (error_ || !slot || slot->seq != next)
+                        return;
+                    c = slot;
+                    slot = nullptr;
+                }
+                // Полный диск или закрытый канал не должны молча обрезать выход
+                if (std::fwrite(c->out.data(), 1, c->out.size(), out_) != c->out.size())
+                    throw std::runtime_error("Ошибка записи результата");
+                stats_.lines += c->lines.size();
+                stats_.failed += c->failed;
+                std::lock_guard<std::mutex> lock(mutex_);
+                free_.push_back(c);
+                free_cv_.notify_one();
+            }
+        }
+
+        LineReader reader_;
+        std::FILE *out_;
+        ThreadPool &pool_;
+        std::vector<std::unique_ptr<Chunk>> chunks_;
+
+        std::mutex mutex_;
+        std::condition_variable free_cv_, work_cv_, done_cv_;
+        std::vector<Chunk *> free_;   // пустые пачки для чтения
+        std::deque<Chunk *> work_;    // прочитанные, ждут вычисления
+        std::vector<Chunk *> slots_;  // буфер переупорядочивания: пачка seq лежит в seq % size
+        uint64_t total_ = 0;
+        bool input_done_ = false;
+        std::exception_ptr error_;
+        StreamStats stats_;
+    };
+} // namespace
+
+StreamStats run_batch_stream(std::FILE *in, std::FILE *out, ThreadPool &pool)
+{
+    Pipeline pipeline(in, out, pool);
+    StreamStats stats = pipeline.run();
+    if (std::fflush(out) != 0)
+        throw std::runtime_error("Ошибка записи результата");
+    return stats;
+}
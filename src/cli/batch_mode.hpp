@@ -0,0 +1,21 @@
+// src/cli/batch_mode.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+
+#include "../engine/thread_pool.hpp"
+
+struct StreamStats
+{
+    size_t lines = 0;
+    size_t failed = 0;
+};
+
+// Режим --batch: читает из in по выражению на строку и пишет в out по строке
+// результата в том же порядке. Строки разбираются и вычисляются потоками pool;
+// готовые пачки строк проходят через буфер переупорядочивания ограниченного
+// размера, поэтому память не зависит от длины входа. Ошибка выражения
+// записывается в его строку как "error: <текст>" и не прерывает работу;
+// ошибка чтения или записи бросает std::runtime_error после остановки всех потоков.
+StreamStats run_batch_stream(std::FILE *in, std::FILE *out, ThreadPool &pool);
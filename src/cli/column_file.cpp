@@ -0,0 +1,116 @@
+// src/cli/column_file.cpp
+#include "column_file.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    constexpr char kMagic[8] = {'F', 'C', 'C', 'O', 'L', 'S', '\0', '\0'};
+    constexpr uint32_t kVersion = 1;
+    constexpr size_t kAlign = 64;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    constexpr bool kLittleEndian = false;
+#else
+    constexpr bool kLittleEndian = true;
+#endif
+
+    size_t align_up(size_t n) { return (n + kAlign - 1) / kAlign * kAlign; }
+
+    size_t validity_words(size_t rows) { return (rows + 63) / 64; }
+
+    void require_little_endian()
+    {
+        // массивы используются без преобразования порядка байт
+        if (!kLittleEndian)
+            throw std::runtime_error("Файлы столбцов поддерживаются только на little-endian платформах");
+    }
+
+    // true, если [offset, offset + bytes) лежит в файле и выровнен под uint64
+    bool in_file(uint64_t offset, uint64_t bytes, size_t size)
+    {
+        return offset % 8 == 0 && offset <= size && bytes <= size - offset;
+    }
+} // namespace
+
+ColumnFileReader::ColumnFileReader(const std::string &path) : file_(path)
+{
+    require_little_endian();
+    const size_t size = file_.size();
+    const char *base = file_.data();
+    auto corrupt = [&](const char *what)
+    { return std::runtime_error("Повреждённый файл столбцов " + path + ": " + what); };
+
+    ColumnFileHeader header;
+    if (size < sizeof(header))
+        throw corrupt("нет заголовка");
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+        throw corrupt("неверная сигнатура");
+    if (header.version != kVersion)
+        throw std::runtime_error("Неподдерживаемая версия файла столбцов: " + std::to_string(header.version));
+    if (header.columns > (size - sizeof(header)) / sizeof(ColumnFileEntry))
+        throw corrupt("каталог выходит за конец файла");
+    if (header.rows > size / sizeof(double))
+        throw corrupt("число строк больше размера файла");
+    rows_ = size_t(header.rows);
+
+    for (uint32_t c = 0; c < header.columns; ++c)
+    {
+        ColumnFileEntry entry;
+        std::memcpy(&entry, base + sizeof(header) + c * sizeof(entry), sizeof(entry));
+        if (std::memchr(entry.name, '\0', sizeof(entry.name)) == nullptr)
+            throw corrupt("имя столбца без завершающего нуля");
+        if (!in_file(entry.data_offset, uint64_t(rows_) * sizeof(double), size))
+            throw corrupt("данные столбца выходят за конец файла");
+        if (entry.validity_offset && !in_file(entry.validity_offset, validity_words(rows_) * 8, size))
+            throw corrupt("маска столбца выходит за конец файла");
+        names_.emplace_back(entry.name);
+        data_.push_back(reinterpret_cast<const double *>(base + entry.data_offset));
+        validity_.push_back(entry.validity_offset
+                                ? reinterpret_cast<const uint64_t *>(base + entry.validity_offset)
+                                : nullptr);
+    }
+}
+
+namespace
+{
+    // Размер нового файла; имена проверяются до того, как файл будет создан
+    size_t writer_size(size_t rows, const std::vector<std::string> &names)
+    {
+        require_little_endian();
+        for (const std::string &name : names)
+            if (name.size() >= sizeof(ColumnFileEntry::name))
+                throw std::runtime_error("Слишком длинное имя столбца: " + name);
+        const size_t columns = names.size();
+        size_t size = align_up(sizeof(ColumnFileHeader) + columns * sizeof(ColumnFileEntry));
+        return size + columns * (align_up(rows * sizeof(double)) + align_up(validity_words(rows) * 8));
+    }
+} // namespace
+
+ColumnFileWriter::ColumnFileWriter(const std::string &path, size_t rows, const std::vector<std::string> &names)
+    : file_(path, writer_size(rows, names)), rows_(rows)
+{
+    char *base = file_.data();
+    ColumnFileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.columns = uint32_t(names.size());
+    header.rows = rows;
+    std::memcpy(base, &header, sizeof(header));
+
+    size_t offset = align_up(sizeof(ColumnFileHeader) + names.size() * sizeof(ColumnFileEntry));
+    for (size_t c = 0; c < names.size(); ++c)
+    {
+        ColumnFileEntry entry{};
+        std::memcpy(entry.name, names[c].data(), names[c].size());
+        entry.data_offset = offset;
+        offset += align_up(rows * sizeof(double));
+        entry.validity_offset = offset;
+        offset += align_up(validity_words(rows) * 8);
+        std::memcpy(base + sizeof(header) + c * sizeof(entry), &entry, sizeof(entry));
+        data_.push_back(reinterpret_cast<double *>(base + entry.data_offset));
+        validity_.push_back(reinterpret_cast<uint64_t *>(base + entry.validity_offset));
+    }
+}
@@ -0,0 +1,81 @@
+// src/cli/column_file.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+
+// Двоичный формат столбцов float64 (см. document/cli.md). Все числа — little-endian:
+//   заголовок, 32 байта: magic "FCCOLS\0\0", version, columns, rows, reserved
+//   каталог: columns записей по 64 байта: name[40], data_offset, validity_offset, reserved
+//   данные: rows значений double на столбец; validity — (rows + 63) / 64 слов uint64,
+//   бит строки r — (word[r / 64] >> r % 64) & 1, 1 — значение есть
+// Смещения отсчитываются от начала файла и кратны 64; validity_offset = 0 —
+// все значения столбца есть.
+struct ColumnFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t columns;
+    uint64_t rows;
+    uint64_t reserved;
+};
+
+struct ColumnFileEntry
+{
+    char name[40];
+    uint64_t data_offset;
+    uint64_t validity_offset;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(ColumnFileHeader) == 32, "заголовок файла столбцов занимает 32 байта");
+static_assert(sizeof(ColumnFileEntry) == 64, "запись каталога занимает 64 байта");
+
+// Файл столбцов, отображённый в память для чтения. Массивы столбцов
+// используются прямо из отображения, без копирования. Бросает
+// std::runtime_error, если файл не открывается или повреждён.
+class ColumnFileReader
+{
+public:
+    explicit ColumnFileReader(const std::string &path);
+
+    size_t rows() const { return rows_; }
+    size_t columns() const { return names_.size(); }
+    const std::string &name(size_t column) const { return names_[column]; }
+    const double *data(size_t column) const { return data_[column]; }
+    // nullptr — все значения столбца есть
+    const uint64_t *validity(size_t column) const { return validity_[column]; }
+
+private:
+    MappedFile file_;
+    size_t rows_ = 0;
+    std::vector<std::string> names_;
+    std::vector<const double *> data_;
+    std::vector<const uint64_t *> validity_;
+};
+
+// Новый файл столбцов, отображённый в память для записи: размер и каталог
+// задаются сразу, значения пишутся на место через data() и validity().
+class ColumnFileWriter
+{
+public:
+    // Каждый столбец получает свою маску validity, изначально нулевую
+    ColumnFileWriter(const std::string &path, size_t rows, const std::vector<std::string> &names);
+
+    size_t rows() const { return rows_; }
+    double *data(size_t column) { return data_[column]; }
+    uint64_t *validity(size_t column) { return validity_[column]; }
+
+    // Записывает изменения на диск
+    void finish() { file_.flush(); }
+
+private:
+    MappedFile file_;
+    size_t rows_;
+    std::vector<double *> data_;
+    std::vector<uint64_t *> validity_;
+};
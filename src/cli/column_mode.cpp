@@ -0,0 +1,72 @@
+// src/cli/column_mode.cpp
+#include "column_mode.hpp"
+
+#include <bitset>
+#include <stdexcept>
+#include <vector>
+
+#include "../engine/compiled_expr.hpp"
+#include "../engine/parallel_batch.hpp"
+#include "column_file.hpp"
+#include "mapped_file.hpp"
+
+ColumnStats run_column_file(const std::string &in_path, const std::string &expr,
+                            const std::string &out_path, ThreadPool &pool)
+{
+    ColumnFileReader in(in_path);
+
+    // переменными становятся только столбцы, названные в выражении;
+    // из повторяющихся имён берётся первое
+    std::vector<std::string> wanted = referenced_names(expr);
+    std::vector<std::string> variables;
+    std::vector<size_t> var_column;
+    for (size_t c = 0; c < in.columns() && !wanted.empty(); ++c)
+        for (size_t k = 0; k < wanted.size(); ++k)
+            if (wanted[k] == in.name(c))
+            {
+                variables.push_back(std::move(wanted[k]));
+                var_column.push_back(c);
+                wanted.erase(wanted.begin() + std::ptrdiff_t(k));
+                break;
+            }
+    CompiledExpr compiled(expr, variables);
+    const Program &program = compiled.program();
+
+    std::vector<bool> used(variables.size(), false);
+    for (const Instr &instr : program.code)
+        if (instr.op == OpCode::LOAD)
+            used[instr.operand] = true;
+    std::vector<const double *> columns(variables.size());
+    std::vector<const uint64_t *> validity;
+    for (size_t v = 0; v < variables.size(); ++v)
+    {
+        columns[v] = in.data(var_column[v]);
+        if (used[v] && in.validity(var_column[v]))
+            validity.push_back(in.validity(var_column[v]));
+    }
+
+    // выход открывается с усечением, а вход ещё отображён в память
+    if (same_file(in_path, out_path))
+        throw std::runtime_error("Файл результата совпадает со входным: " + out_path);
+
+    const size_t rows = in.rows();
+    ColumnFileWriter out(out_path, rows, {"result"});
+    uint64_t *mask = out.validity(0);
+    ParallelBatchEvaluator(program, pool).evaluate(columns.data(), rows, out.data(0), mask);
+
+    // маска ошибок вычислителя превращается на месте в маску validity
+    size_t valid_rows = 0;
+    const size_t words = error_mask_words(rows);
+    for (size_t w = 0; w < words; ++w)
+    {
+        uint64_t valid = ~mask[w];
+        for (const uint64_t *input : validity)
+            valid &= input[w];
+        if (w + 1 == words && rows % 64)
+            valid &= (uint64_t(1) << (rows % 64)) - 1;
+        mask[w] = valid;
+        valid_rows += std::bitset<64>(valid).count();
+    }
+    out.finish();
+    return ColumnStats{rows, rows - valid_rows};
+}
@@ -0,0 +1,24 @@
+// src/cli/column_mode.hpp
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "../engine/thread_pool.hpp"
+
+struct ColumnStats
+{
+    size_t rows = 0;
+    size_t failed = 0;
+};
+
+// Режим --columns: вычисляет expr над файлом столбцов float64 (column_file.hpp).
+// Переменные связываются со столбцами по именам; массивы входа передаются
+// вычислителю прямо из отображения файла. Результат пишется в новый файл того
+// же формата со столбцом "result": значения — прямо в отображение выхода,
+// маска validity отмечает строки без ошибок, у которых есть все значения
+// используемых столбцов. out_path не может быть тем же файлом, что in_path.
+// Ошибка разбора выражения — CalcError, ошибка ввода-вывода или формата —
+// std::runtime_error.
+ColumnStats run_column_file(const std::string &in_path, const std::string &expr,
+                            const std::string &out_path, ThreadPool &pool);
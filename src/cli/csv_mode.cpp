@@ -0,0 +1,331 @@
+// src/cli/csv_mode.cpp
+#include "csv_mode.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "../AST.hpp"
+#include "../engine/batch.hpp"
+#include "../engine/compiled_expr.hpp"
+#include "mapped_file.hpp"
+
+namespace
+{
+    // Участок входа — единица работы потока; граница сдвигается к концу строки
+    constexpr size_t kRangeBytes = 1 << 20;
+    // Участков в одной волне на поток: волна вычисляется параллельно и
+    // записывается по порядку, поэтому память не зависит от размера входа
+    constexpr size_t kRangesPerWorker = 4;
+
+    // Ошибка входа строки: 0 — нет, иначе номер слота столбца + 1
+    constexpr uint32_t kMissingField = std::numeric_limits<uint32_t>::max();
+
+    const char *find(const char *p, const char *end, char c)
+    {
+        const void *hit = std::memchr(p, c, size_t(end - p));
+        return hit ? static_cast<const char *>(hit) : end;
+    }
+
+    // Поле без пробелов по краям и без обрамляющих кавычек. Кавычки
+    // допускаются только вокруг значения: запятая внутри них не поддерживается.
+    std::string_view field_text(const char *begin, const char *end)
+    {
+        while (begin < end && (*begin == ' ' || *begin == '\t'))
+            ++begin;
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t'))
+            --end;
+        if (end - begin >= 2 && *begin == '"' && end[-1] == '"')
+        {
+            ++begin;
+            --end;
+        }
+        return std::string_view(begin, size_t(end - begin));
+    }
+
+    bool parse_number(const char *begin, const char *end, double &value)
+    {
+        std::string_view text = field_text(begin, end);
+        if (!text.empty() && text.front() == '+')
+            text.remove_prefix(1);
+        if (text.empty())
+            return false;
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return ec == std::errc() && ptr == text.data() + text.size();
+    }
+
+    // Строка входа без '\n' и завершающего '\r'
+    const char *line_end(const char *p, const char *end, const char *&next)
+    {
+        const char *nl = find(p, end, '\n');
+        next = nl < end ? nl + 1 : end;
+        return (nl > p && nl[-1] == '\r') ? nl - 1 : nl;
+    }
+
+    // Связь столбцов таблицы с переменными выражения
+    struct Layout
+    {
+        std::vector<std::string> variables; // столбцы, названные в выражении
+        std::vector<size_t> var_field;      // номер поля каждой переменной
+        std::vector<int> field_slot;        // поле -> слот прочитанного столбца или -1
+        std::vector<std::string> slot_name;
+        std::vector<int> var_slot;          // переменная -> слот или -1, если не используется
+    };
+
+    struct Range
+    {
+        const char *begin;
+        const char *end;
+        // результат участка, готовый к записи
+        std::string out;
+        size_t rows = 0;
+        size_t failed = 0;
+    };
+
+    // Состояние одного потока пула; ёмкость буферов сохраняется между участками
+    struct Worker
+    {
+        explicit Worker(const Program &program) : batch(program) {}
+        BatchEvaluator batch;
+        std::vector<std::vector<double>> columns;
+        std::vector<uint32_t> bad;
+        std::vector<double> result;
+        std::vector<uint64_t> mask;
+        std::vector<ErrorCode> codes;
+        std::vector<const double *> pointers;
+    };
+
+    class CsvJob
+    {
+    public:
+        CsvJob(std::string_view data, const std::string &expr, ThreadPool &pool)
+            : pool_(pool)
+        {
+            const char *p = data.data();
+            end_ = p + data.size();
+            if (data.size() >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+                p += 3;
+            if (p == end_)
+                throw std::runtime_error("CSV без строки заголовка");
+            const char *header_end = line_end(p, end_, body_);
+            read_header(p, header_end, referenced_names(expr));
+
+            expr_ = std::make_unique<CompiledExpr>(expr, layout_.variables);
+            bind_columns(expr_->program());
+            for (size_t k = 0; k < pool.size(); ++k)
+                workers_.push_back(std::make_unique<Worker>(expr_->program()));
+        }
+
+        CsvStats run(std::FILE *out)
+        {
+            CsvStats stats;
+            write(out, "result,error\n", 13);
+            const size_t wave = pool_.size() * kRangesPerWorker;
+            std::vector<Range> ranges(wave);
+            const char *p = body_;
+            while (p < end_)
+            {
+                size_t count = 0;
+                while (p < end_ && count < wave)
+                {
+                    const char *stop = size_t(end_ - p) > kRangeBytes ? p + kRangeBytes : end_;
+                    if (stop < end_)
+                    {
+                        const char *nl = find(stop, end_, '\n');
+                        stop = nl < end_ ? nl + 1 : end_;
+                    }
+                    ranges[count].begin = p;
+                    ranges[count].end = stop;
+                    ++count;
+                    p = stop;
+                }
+                pool_.parallel_for(count, [&](size_t index, size_t worker)
+                                   { process(ranges[index], *workers_[worker]); });
+                for (size_t k = 0; k < count; ++k)
+                {
+                    write(out, ranges[k].out.data(), ranges[k].out.size());
+                    stats.rows += ranges[k].rows;
+                    stats.failed += ranges[k].failed;
+                }
+            }
+            return stats;
+        }
+
+    private:
+        // Переменными становятся только столбцы, названные в выражении, —
+        // в широкой таблице их может быть больше kMaxVariables; из
+        // повторяющихся имён берётся первое
+        void read_header(const char *p, const char *end, std::vector<std::string> wanted)
+        {
+            for (size_t field = 0; !wanted.empty(); ++field)
+            {
+                const char *comma = find(p, end, ',');
+                std::string_view name = field_text(p, comma);
+                for (size_t k = 0; k < wanted.size(); ++k)
+                    if (wanted[k] == name)
+                    {
+                        layout_.variables.push_back(std::move(wanted[k]));
+                        layout_.var_field.push_back(field);
+                        wanted.erase(wanted.begin() + std::ptrdiff_t(k));
+                        break;
+                    }
+                if (comma == end)
+                    break;
+                p = comma + 1;
+            }
+        }
+
+        // Читаются только столбцы переменных, загружаемых программой
+        void bind_columns(const Program &program)
+        {
+            std::vector<bool> used(layout_.variables.size(), false);
+            for (const Instr &in : program.code)
+                if (in.op == OpCode::LOAD)
+                    used[in.operand] = true;
+            layout_.var_slot.assign(layout_.variables.size(), -1);
+            for (size_t v = 0; v < used.size(); ++v)
+            {
+                if (!used[v])
+                    continue;
+                size_t field = layout_.var_field[v];
+                if (layout_.field_slot.size() <= field)
+                    layout_.field_slot.resize(field + 1, -1);
+                layout_.var_slot[v] = int(layout_.slot_name.size());
+                layout_.field_slot[field] = int(layout_.slot_name.size());
+                layout_.slot_name.push_back(layout_.variables[v]);
+            }
+        }
+
+        void process(Range &range, Worker &w)
+        {
+            const size_t slots = layout_.slot_name.size();
+            w.columns.resize(slots);
+            for (auto &c : w.columns)
+                c.clear();
+            w.bad.clear();
+
+            const int fields = int(layout_.field_slot.size());
+            const char *next = range.begin;
+            while (next < range.end)
+            {
+                const char *p = next;
+                const char *e = line_end(p, range.end, next);
+                if (p == e)
+                    continue; // пустые строки пропускаются
+                uint32_t bad = 0;
+                for (int field = 0; field < fields; ++field)
+                {
+                    const char *comma = find(p, e, ',');
+                    int slot = layout_.field_slot[size_t(field)];
+                    if (slot >= 0)
+                    {
+                        double value = 0.0;
+                        if (!parse_number(p, comma, value) && !bad)
+                            bad = uint32_t(slot) + 1;
+                        w.columns[size_t(slot)].push_back(value);
+                    }
+                    if (comma == e)
+                        break;
+                    p = comma + 1;
+                }
+                // короткая строка: недостающие столбцы заполняются, строка отмечается
+                const size_t row = w.bad.size();
+                for (auto &c : w.columns)
+                    if (c.size() == row)
+                    {
+                        c.push_back(0.0);
+                        bad = kMissingField;
+                    }
+                w.bad.push_back(bad);
+            }
+
+            const size_t rows = w.bad.size();
+            w.result.resize(rows);
+            w.mask.resize(error_mask_words(rows));
+            w.codes.resize(rows);
+            w.pointers.assign(layout_.var_slot.size(), nullptr);
+            for (size_t v = 0; v < layout_.var_slot.size(); ++v)
+                if (layout_.var_slot[v] >= 0)
+                    w.pointers[v] = w.columns[size_t(layout_.var_slot[v])].data();
+            if (rows)
+                w.batch.evaluate(w.pointers.data(), rows, w.result.data(), w.mask.data(), w.codes.data());
+
+            std::string &out = range.out;
+            size_t &failed = range.failed;
+            out.clear();
+            failed = 0;
+            range.rows = rows;
+            char buf[64];
+            for (size_t r = 0; r < rows; ++r)
+            {
+                if (w.bad[r] || row_failed(w.mask.data(), r))
+                {
+                    ++failed;
+                    out += ",\"";
+                    if (w.bad[r] == kMissingField)
+                        out += "Недостаточно полей в строке";
+                    else if (w.bad[r])
+                    {
+                        out += "Не число в столбце ";
+                        out += layout_.slot_name[w.bad[r] - 1];
+                    }
+                    else
+                        out += error_message(w.codes[r]);
+                    out += "\"\n";
+                    continue;
+                }
+                auto res = std::to_chars(buf, buf + sizeof(buf), w.result[r]);
+                out.append(buf, size_t(res.ptr - buf));
+                out += ",\n";
+            }
+        }
+
+        static void write(std::FILE *out, const char *data, size_t size)
+        {
+            if (size && std::fwrite(data, 1, size, out) != size)
+                throw std::runtime_error("Ошибка записи результата");
+        }
+
+        ThreadPool &pool_;
+        const char *end_ = nullptr;
+        const char *body_ = nullptr;
+        Layout layout_;
+        std::unique_ptr<CompiledExpr> expr_;
+        std::vector<std::unique_ptr<Worker>> workers_;
+    };
+} // namespace
+
+CsvStats run_csv(std::string_view data, const std::string &expr, std::FILE *out, ThreadPool &pool)
+{
+    CsvJob job(data, expr, pool);
+    return job.run(out);
+}
+
+CsvStats run_csv_file(const std::string &in_path, const std::string &expr,
+                      const std::string &out_path, ThreadPool &pool)
+{
+    MappedFile input(in_path);
+    // выход открывается с усечением, а вход ещё отображён в память
+    if (!out_path.empty() && same_file(in_path, out_path))
+        throw std::runtime_error("Файл результата совпадает со входным: " + out_path);
+    std::FILE *out = out_path.empty() ? stdout : std::fopen(out_path.c_str(), "wb");
+    if (!out)
+        throw std::runtime_error("Не удалось открыть файл для записи: " + out_path);
+    CsvStats stats;
+    try
+    {
+        stats = run_csv(std::string_view(input.data(), input.size()), expr, out, pool);
+    }
+    catch (...)
+    {
+        if (out != stdout)
+            std::fclose(out);
+        throw;
+    }
+    if (out == stdout ? std::fflush(out) != 0 : std::fclose(out) != 0)
+        throw std::runtime_error("Ошибка записи результата: " + out_path);
+    return stats;
+}
@@ -0,0 +1,28 @@
+// src/cli/csv_mode.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "../engine/thread_pool.hpp"
+
+struct CsvStats
+{
+    size_t rows = 0;
+    size_t failed = 0;
+};
+
+// Режим --csv: вычисляет expr для каждой строки таблицы data. Переменные
+// выражения связываются со столбцами по именам из строки заголовка; читаются
+// только столбцы, которые встречаются в выражении. Поля разбираются на месте
+// без копирования, участки входа разбираются и вычисляются потоками pool.
+// В out пишется таблица "result,error": значение в кратчайшей точной записи
+// или текст ошибки строки. Ошибка разбора выражения — CalcError.
+CsvStats run_csv(std::string_view data, const std::string &expr, std::FILE *out, ThreadPool &pool);
+
+// То же для файлов: вход отображается в память, out_path пустой — stdout.
+// Бросает std::runtime_error при ошибке ввода-вывода.
+CsvStats run_csv_file(const std::string &in_path, const std::string &expr,
+                      const std::string &out_path, ThreadPool &pool);
@@ -0,0 +1,121 @@
+// src/cli/mapped_file.cpp
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FAST_CALC_MMAP 1
+#else
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#endif
+
+#ifdef FAST_CALC_MMAP
+namespace
+{
+    char *map(int fd, size_t size, bool writable, const std::string &path)
+    {
+        int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        void *p = ::mmap(nullptr, size, prot, writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("Не удалось отобразить файл в память: " + path);
+        }
+        ::madvise(p, size, MADV_SEQUENTIAL);
+        return static_cast<char *>(p);
+    }
+} // namespace
+#endif
+
+MappedFile::MappedFile(const std::string &path) : path_(path)
+{
+#ifdef FAST_CALC_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Не удалось открыть файл: " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Не удалось прочитать файл: " + path);
+    }
+    size_ = size_t(st.st_size);
+    // пустой файл отобразить нельзя — остаётся пустой диапазон
+    if (size_ > 0)
+    {
+        data_ = map(fd, size_, false, path);
+        mapped_ = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("Не удалось открыть файл: " + path);
+    buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+}
+
+MappedFile::MappedFile(const std::string &path, size_t size) : path_(path), size_(size), writable_(true)
+{
+#ifdef FAST_CALC_MMAP
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw std::runtime_error("Не удалось открыть файл для записи: " + path);
+    if (::ftruncate(fd, off_t(size)) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Не удалось задать размер файла: " + path);
+    }
+    if (size_ > 0)
+    {
+        data_ = map(fd, size_, true, path);
+        mapped_ = true;
+    }
+    ::close(fd);
+#else
+    buffer_.assign(size, 0);
+    data_ = buffer_.data();
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef FAST_CALC_MMAP
+    if (mapped_)
+        ::munmap(data_, size_);
+#endif
+}
+
+void MappedFile::flush()
+{
+    if (!writable_)
+        return;
+#ifdef FAST_CALC_MMAP
+    if (mapped_ && ::msync(data_, size_, MS_SYNC) != 0)
+        throw std::runtime_error("Ошибка записи файла: " + path_);
+#else
+    std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+    if (!out.write(buffer_.data(), std::streamsize(buffer_.size())))
+        throw std::runtime_error("Ошибка записи файла: " + path_);
+#endif
+}
+
+bool same_file(const std::string &a, const std::string &b)
+{
+#ifdef FAST_CALC_MMAP
+    struct stat sa, sb;
+    return ::stat(a.c_str(), &sa) == 0 && ::stat(b.c_str(), &sb) == 0 &&
+           sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+#else
+    std::error_code ec;
+    return std::filesystem::equivalent(a, b, ec);
+#endif
+}
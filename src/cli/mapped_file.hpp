@@ -0,0 +1,42 @@
+// src/cli/mapped_file.hpp
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Файл, отображённый в память. На POSIX — mmap без копирования; на остальных
+// платформах файл читается в буфер целиком, а записываемый файл сохраняется
+// из буфера в flush(). Бросает std::runtime_error при ошибке ввода-вывода.
+class MappedFile
+{
+public:
+    // Существующий файл только для чтения
+    explicit MappedFile(const std::string &path);
+    // Новый файл размером size для записи; прежнее содержимое удаляется
+    MappedFile(const std::string &path, size_t size);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return data_; }
+    // Только для файла, открытого на запись
+    char *data() { return data_; }
+    size_t size() const { return size_; }
+
+    // Записывает изменения на диск
+    void flush();
+
+private:
+    std::string path_;
+    char *data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    bool writable_ = false;
+    std::vector<char> buffer_;
+};
+
+// Оба пути ведут к одному существующему файлу (ссылки и разные записи пути
+// тоже совпадают). Выход, открытый с усечением поверх отображённого входа,
+// обрезал бы отображение, и чтение из него закончилось бы SIGBUS.
+bool same_file(const std::string &a, const std::string &b);
@@ -0,0 +1,97 @@
+// src/cli/options.cpp
+#include "options.hpp"
+
+#include <charconv>
+#include <string_view>
+
+#include "../engine/compiled_expr.hpp"
+
+namespace
+{
+    size_t parse_count(std::string_view option, std::string_view value)
+    {
+        size_t n = 0;
+        auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), n);
+        if (ec != std::errc() || end != value.data() + value.size() || n == 0)
+            throw CliError("Ожидалось положительное число: " + std::string(option) + std::string(value));
+        return n;
+    }
+} // namespace
+
+CliOptions parse_cli(int argc, const char *const *argv)
+{
+    CliOptions options;
+    // значение параметра — следующий аргумент
+    auto value = [&](int &i)
+    {
+        if (i + 1 == argc)
+            throw CliError("Параметру " + std::string(argv[i]) + " нужно значение");
+        return std::string(argv[++i]);
+    };
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if (arg == "--simd-info")
+            options.simd_info = true;
+        else if (arg.substr(0, 7) == "--simd=")
+        {
+            if (!parse_simd_level(arg.substr(7), options.simd))
+                throw CliError("Неизвестный уровень SIMD: " + std::string(arg.substr(7)) +
+                               " (допустимо: scalar, sse2, avx2, avx512)");
+            options.limit_simd = true;
+        }
+        else if (arg == "--jit")
+        {
+            if (!jit_available())
+                throw CliError("JIT не собран: нужна опция CMake -DFAST_CALC_JIT=ON (Linux x86-64)");
+            options.jit = true;
+        }
+        else if (arg == "--batch")
+            options.batch = true;
+        else if (arg.substr(0, 10) == "--threads=")
+            options.threads = parse_count("--threads=", arg.substr(10));
+        else if (arg == "--csv")
+            options.csv = value(i);
+        else if (arg == "--columns")
+            options.columns = value(i);
+        else if (arg == "--expr")
+            options.expr = value(i);
+        else if (arg == "--out")
+            options.out = value(i);
+        else if (arg == "--serve")
+            options.serve = value(i);
+        else if (arg == "--shm")
+            options.shm = value(i);
+        else
+            throw CliError("Неизвестный параметр: " + std::string(arg));
+    }
+    if (!options.csv.empty() && !options.columns.empty())
+        throw CliError("Параметры --csv и --columns несовместимы");
+    // режим работы выбирается один
+    int modes = int(options.batch) + int(!options.serve.empty()) + int(!options.shm.empty()) +
+                int(!options.csv.empty() || !options.columns.empty());
+    if (modes > 1)
+        throw CliError("Параметры --batch, --serve, --shm и --csv/--columns несовместимы");
+    bool table = !options.csv.empty() || !options.columns.empty();
+    if (table != !options.expr.empty())
+        throw CliError("Параметр --expr указывается вместе с --csv или --columns");
+    if (!options.out.empty() && !table)
+        throw CliError("Параметр --out используется только с --csv или --columns");
+    if (!options.columns.empty() && options.out.empty())
+        throw CliError("Для --columns нужен параметр --out");
+    return options;
+}
+
+void apply_engine_options(const CliOptions &options)
+{
+    if (options.limit_simd)
+        limit_simd_level(options.simd);
+    if (options.jit)
+        set_default_jit(true);
+}
+
+std::string simd_report()
+{
+    return "simd: " + std::string(simd_level_name(active_simd_level())) +
+           " (cpu: " + std::string(simd_level_name(detected_simd_level())) + ")";
+}
@@ -0,0 +1,51 @@
+// src/cli/options.hpp
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include "../engine/dispatch.hpp"
+
+// Параметры командной строки fast_calc. Без параметров запускается
+// интерактивный интерфейс.
+struct CliOptions
+{
+    // --simd=<scalar|sse2|avx2|avx512>: не подниматься выше этого уровня ядер
+    bool limit_simd = false;
+    SimdLevel simd = SimdLevel::COUNT;
+    // --simd-info: напечатать обнаруженный и активный уровень и выйти
+    bool simd_info = false;
+    // --jit: компилировать выражения в машинный код (set_default_jit)
+    bool jit = false;
+    // --batch: выражения из stdin по строке, результаты в stdout
+    bool batch = false;
+    // --threads=N: потоков вычисления; 0 — из конфигурации ([engine] threads)
+    size_t threads = 0;
+    // --csv <файл> --expr <выражение> [--out <файл>]: выражение над столбцами
+    // таблицы; без --out результат пишется в stdout
+    std::string csv;
+    // --columns <файл> --expr <выражение> --out <файл>: то же над файлом
+    // столбцов float64 (column_file.hpp)
+    std::string columns;
+    std::string expr;
+    std::string out;
+    // --serve <путь>: сервер вычислений на Unix-сокете (server.hpp)
+    std::string serve;
+    // --shm <имя>: сервер вычислений на разделяемой памяти (shm_transport.hpp)
+    std::string shm;
+};
+
+class CliError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Бросает CliError с текстом для пользователя
+CliOptions parse_cli(int argc, const char *const *argv);
+
+// Применяет параметры ядра (уровень SIMD, JIT) до начала вычислений
+void apply_engine_options(const CliOptions &options);
+
+std::string simd_report();
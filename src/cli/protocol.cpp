@@ -0,0 +1,149 @@
+// src/cli/protocol.cpp
+#include "protocol.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    // Числа пишутся побайтно, поэтому формат не зависит от порядка байт платформы
+    template <class T>
+    void put(std::string &out, T value)
+    {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(T));
+        for (size_t k = 0; k < sizeof(T); ++k)
+            out.push_back(char((bits >> (8 * k)) & 0xFF));
+    }
+
+    // Последовательное чтение полей кадра с проверкой границ
+    class Reader
+    {
+    public:
+        explicit Reader(std::string_view data) : data_(data) {}
+
+        template <class T>
+        bool get(T &value)
+        {
+            if (data_.size() - pos_ < sizeof(T))
+                return false;
+            uint64_t bits = 0;
+            for (size_t k = 0; k < sizeof(T); ++k)
+                bits |= uint64_t(uint8_t(data_[pos_ + k])) << (8 * k);
+            pos_ += sizeof(T);
+            std::memcpy(&value, &bits, sizeof(T));
+            return true;
+        }
+
+        bool bytes(size_t n, std::string_view &out)
+        {
+            if (data_.size() - pos_ < n)
+                return false;
+            out = data_.substr(pos_, n);
+            pos_ += n;
+            return true;
+        }
+
+        std::string_view rest() const { return data_.substr(pos_); }
+        bool done() const { return pos_ == data_.size(); }
+
+    private:
+        std::string_view data_;
+        size_t pos_ = 0;
+    };
+
+    // Выделяет тело кадра из начала буфера
+    FrameResult frame(std::string_view buffer, std::string_view &body, size_t &consumed)
+    {
+        uint32_t size = 0;
+        Reader header(buffer);
+        if (!header.get(size))
+            return FrameResult::INCOMPLETE;
+        if (size > kMaxFrame)
+            return FrameResult::MALFORMED;
+        if (buffer.size() - sizeof(size) < size)
+            return FrameResult::INCOMPLETE;
+        body = buffer.substr(sizeof(size), size);
+        consumed = sizeof(size) + size;
+        return FrameResult::OK;
+    }
+
+    // Записывает размер кадра, начатого с позиции start
+    void finish_frame(std::string &out, size_t start)
+    {
+        uint32_t size = uint32_t(out.size() - start - sizeof(uint32_t));
+        for (size_t k = 0; k < sizeof(size); ++k)
+            out[start + k] = char((size >> (8 * k)) & 0xFF);
+    }
+} // namespace
+
+void append_request(std::string &out, uint32_t id, std::string_view expr,
+                    const std::vector<Binding> &bindings)
+{
+    if (expr.size() > UINT16_MAX || bindings.size() > UINT16_MAX)
+        throw std::length_error("Запрос не помещается в кадр");
+    for (const Binding &b : bindings)
+        if (b.name.size() > UINT8_MAX)
+            throw std::length_error("Слишком длинное имя переменной: " + std::string(b.name));
+    size_t start = out.size();
+    put(out, uint32_t(0));
+    put(out, id);
+    put(out, uint16_t(expr.size()));
+    put(out, uint16_t(bindings.size()));
+    out.append(expr);
+    for (const Binding &b : bindings)
+    {
+        put(out, uint8_t(b.name.size()));
+        out.append(b.name);
+        put(out, b.value);
+    }
+    finish_frame(out, start);
+}
+
+FrameResult parse_request(std::string_view buffer, RequestView &request, size_t &consumed)
+{
+    std::string_view body;
+    FrameResult result = frame(buffer, body, consumed);
+    if (result != FrameResult::OK)
+        return result;
+
+    Reader r(body);
+    uint16_t expr_len = 0, var_count = 0;
+    if (!r.get(request.id) || !r.get(expr_len) || !r.get(var_count) || !r.bytes(expr_len, request.expr))
+        return FrameResult::MALFORMED;
+    request.bindings.clear();
+    for (uint16_t k = 0; k < var_count; ++k)
+    {
+        uint8_t name_len = 0;
+        Binding b{};
+        if (!r.get(name_len) || !r.bytes(name_len, b.name) || !r.get(b.value))
+            return FrameResult::MALFORMED;
+        request.bindings.push_back(b);
+    }
+    return r.done() ? FrameResult::OK : FrameResult::MALFORMED;
+}
+
+void append_response(std::string &out, uint32_t id, uint8_t status, double value, std::string_view message)
+{
+    size_t start = out.size();
+    put(out, uint32_t(0));
+    put(out, id);
+    put(out, status);
+    put(out, value);
+    out.append(message);
+    finish_frame(out, start);
+}
+
+FrameResult parse_response(std::string_view buffer, Response &response, size_t &consumed)
+{
+    std::string_view body;
+    FrameResult result = frame(buffer, body, consumed);
+    if (result != FrameResult::OK)
+        return result;
+
+    Reader r(body);
+    if (!r.get(response.id) || !r.get(response.status) || !r.get(response.value))
+        return FrameResult::MALFORMED;
+    response.message.assign(r.rest());
+    return FrameResult::OK;
+}
@@ -0,0 +1,58 @@
+// src/cli/protocol.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Кадры протокола --serve (см. document/cli.md). Все числа little-endian,
+// каждый кадр начинается с u32 — размера остальной части кадра.
+//   запрос:  id u32, expr_len u16, var_count u16, expr, затем var_count раз:
+//            name_len u8, name, value f64
+//   ответ:   id u32, status u8, value f64, затем текст ошибки (только при kStatusInvalid)
+// status — ErrorCode (0 — успех), kStatusInvalid — выражение или запрос
+// некорректны; при ошибке value = NaN.
+
+static constexpr uint8_t kStatusInvalid = 255;
+// Кадр больше этого размера считается нарушением протокола
+static constexpr size_t kMaxFrame = 1 << 20;
+
+struct Binding
+{
+    std::string_view name;
+    double value;
+};
+
+// Запрос, разобранный на месте: строки указывают в буфер соединения
+struct RequestView
+{
+    uint32_t id = 0;
+    std::string_view expr;
+    std::vector<Binding> bindings;
+};
+
+struct Response
+{
+    uint32_t id = 0;
+    uint8_t status = 0;
+    double value = 0.0;
+    std::string message;
+};
+
+enum class FrameResult
+{
+    OK,         // кадр разобран, из буфера взято consumed байт
+    INCOMPLETE, // кадр ещё не пришёл целиком
+    MALFORMED   // нарушение протокола: соединение следует закрыть
+};
+
+// Бросает std::length_error, если поля не помещаются в свои размеры
+void append_request(std::string &out, uint32_t id, std::string_view expr,
+                    const std::vector<Binding> &bindings = {});
+FrameResult parse_request(std::string_view buffer, RequestView &request, size_t &consumed);
+
+void append_response(std::string &out, uint32_t id, uint8_t status, double value,
+                     std::string_view message = {});
+FrameResult parse_response(std::string_view buffer, Response &response, size_t &consumed);
@@ -0,0 +1,405 @@
+// src/cli/server.cpp
+#include "server.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "../engine/batch.hpp"
+#include "../engine/compiled_expr.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Меньшие группы быстрее вычислить по одному запросу
+    constexpr size_t kMinBatch = 8;
+    // Скомпилированных выражений в кэше; при переполнении кэш очищается целиком
+    constexpr size_t kCacheEntries = 4096;
+    // Пока столько ответов ждут отправки, новые запросы соединения не читаются;
+    // за одну итерацию читается не больше стольких же байт запросов
+    constexpr size_t kMaxUnsent = 4 << 20;
+    constexpr size_t kReadChunk = 64 * 1024;
+    constexpr int kMaxEvents = 64;
+} // namespace
+
+struct EvalServer::Connection
+{
+    int fd = -1;
+    std::string in;
+    std::string out;
+    size_t sent = 0;
+    uint32_t events = 0;
+    bool touched = false;
+    bool closing = false; // клиент закрыл соединение или нарушил протокол
+};
+
+struct EvalServer::Entry
+{
+    std::unique_ptr<CompiledExpr> expr;
+    std::string error; // текст ошибки компиляции; пусто, если expr есть
+    std::unique_ptr<BatchEvaluator> batch;
+    std::vector<std::vector<double>> columns;
+    std::vector<size_t> members; // запросы текущей итерации
+};
+
+#ifdef __linux__
+
+namespace
+{
+    std::runtime_error system_error(const std::string &what)
+    {
+        return std::runtime_error(what + ": " + std::strerror(errno));
+    }
+} // namespace
+
+EvalServer::EvalServer(const std::string &path) : path_(path)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("Слишком длинный путь сокета: " + path);
+    std::memcpy(addr.sun_path, path.data(), path.size());
+
+    // сокет прошлого запуска мешает bind; другие файлы не трогаем
+    struct stat st;
+    if (::lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        ::unlink(path.c_str());
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0)
+        throw system_error("Не удалось создать сокет");
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, SOMAXCONN) != 0)
+    {
+        auto error = system_error("Не удалось открыть сокет " + path);
+        ::close(listen_fd_);
+        throw error;
+    }
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0)
+    {
+        auto error = system_error("Не удалось создать epoll");
+        close_all();
+        throw error;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.data.fd = wake_fd_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+}
+
+EvalServer::~EvalServer() { close_all(); }
+
+void EvalServer::close_all()
+{
+    for (auto &c : connections_)
+        ::close(c.first);
+    connections_.clear();
+    for (int *fd : {&listen_fd_, &epoll_fd_, &wake_fd_})
+        if (*fd >= 0)
+        {
+            ::close(*fd);
+            *fd = -1;
+        }
+    if (!path_.empty())
+        ::unlink(path_.c_str());
+    path_.clear();
+}
+
+void EvalServer::stop()
+{
+    // write в eventfd допустим в обработчике сигнала
+    uint64_t one = 1;
+    ssize_t written = ::write(wake_fd_, &one, sizeof(one));
+    (void)written;
+}
+
+void EvalServer::run()
+{
+    epoll_event events[kMaxEvents];
+    while (!stopping_)
+    {
+        int n = ::epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw system_error("Ошибка epoll_wait");
+        }
+        // кэш очищается только между итерациями, пока на записи нет ссылок
+        if (cache_.size() >= kCacheEntries)
+            cache_.clear();
+
+        for (int k = 0; k < n; ++k)
+        {
+            int fd = events[k].data.fd;
+            if (fd == listen_fd_)
+                accept_all();
+            else if (fd == wake_fd_)
+                stopping_ = true;
+            else
+            {
+                auto it = connections_.find(fd);
+                if (it == connections_.end())
+                    continue;
+                Connection &conn = *it->second;
+                if (events[k].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                    read_from(conn);
+                if (!conn.touched)
+                {
+                    conn.touched = true;
+                    touched_.push_back(&conn);
+                }
+            }
+        }
+
+        evaluate_pending();
+        for (const Pending &p : pending_)
+            append_response(p.conn->out, p.id, p.status, p.value,
+                            p.status == kStatusInvalid ? std::string_view(p.entry->error) : std::string_view());
+        pending_.clear();
+        values_.clear();
+
+        for (Connection *conn : touched_)
+            finish(*conn);
+        touched_.clear();
+    }
+}
+
+void EvalServer::accept_all()
+{
+    while (true)
+    {
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return; // EAGAIN: новых соединений нет; прочие ошибки касаются одного клиента
+        auto conn = std::make_unique<Connection>();
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+        epoll_event ev{};
+        ev.events = conn->events;
+        ev.data.fd = fd;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0)
+        {
+            ::close(fd);
+            continue;
+        }
+        connections_[fd] = std::move(conn);
+        ++stats_.connections;
+    }
+}
+
+void EvalServer::read_from(Connection &conn)
+{
+    while (!conn.closing && conn.in.size() < kMaxUnsent && conn.out.size() - conn.sent < kMaxUnsent)
+    {
+        size_t old = conn.in.size();
+        conn.in.resize(old + kReadChunk);
+        ssize_t got = ::recv(conn.fd, &conn.in[old], kReadChunk, 0);
+        conn.in.resize(old + size_t(got > 0 ? got : 0));
+        if (got > 0)
+            continue;
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (got < 0 && errno == EINTR)
+            continue;
+        conn.closing = true; // конец потока или ошибка
+    }
+    take_requests(conn);
+}
+
+void EvalServer::take_requests(Connection &conn)
+{
+    size_t pos = 0;
+    while (true)
+    {
+        size_t consumed = 0;
+        FrameResult r = parse_request(std::string_view(conn.in).substr(pos), request_, consumed);
+        if (r == FrameResult::INCOMPLETE)
+            break;
+        if (r == FrameResult::MALFORMED)
+        {
+            // после нарушения протокола границы кадров потеряны
+            conn.closing = true;
+            break;
+        }
+        pos += consumed;
+        Entry *entry = lookup(request_);
+        pending_.push_back(Pending{&conn, request_.id, entry, values_.size(), 0, 0.0});
+        for (const Binding &b : request_.bindings)
+            values_.push_back(b.value);
+        ++stats_.requests;
+    }
+    conn.in.erase(0, pos);
+}
+
+EvalServer::Entry *EvalServer::lookup(const RequestView &request)
+{
+    // ключ — выражение и имена переменных в порядке запроса
+    key_.assign(request.expr);
+    for (const Binding &b : request.bindings)
+    {
+        key_.push_back('\0');
+        key_.append(b.name);
+    }
+    auto it = cache_.find(key_);
+    if (it != cache_.end())
+        return it->second.get();
+
+    auto entry = std::make_unique<Entry>();
+    std::vector<std::string> names;
+    for (const Binding &b : request.bindings)
+        names.emplace_back(b.name);
+    try
+    {
+        entry->expr = std::make_unique<CompiledExpr>(std::string(request.expr), std::move(names));
+        entry->columns.resize(entry->expr->variables().size());
+    }
+    catch (const std::exception &e)
+    {
+        entry->error = e.what();
+    }
+    ++stats_.compiled;
+    Entry *raw = entry.get();
+    cache_.emplace(key_, std::move(entry));
+    return raw;
+}
+
+void EvalServer::evaluate_pending()
+{
+    for (size_t i = 0; i < pending_.size(); ++i)
+    {
+        Entry &entry = *pending_[i].entry;
+        if (entry.members.empty())
+            groups_.push_back(&entry);
+        entry.members.push_back(i);
+    }
+    for (Entry *entry : groups_)
+    {
+        if (!entry->expr)
+            for (size_t i : entry->members)
+            {
+                pending_[i].status = kStatusInvalid;
+                pending_[i].value = std::numeric_limits<double>::quiet_NaN();
+            }
+        else if (entry->members.size() >= kMinBatch)
+            evaluate_group(*entry);
+        else
+            for (size_t i : entry->members)
+            {
+                Pending &p = pending_[i];
+                ErrorCode code = entry->expr->try_evaluate(values_.data() + p.values, p.value);
+                p.status = uint8_t(code);
+                if (code != ErrorCode::OK)
+                    p.value = std::numeric_limits<double>::quiet_NaN();
+            }
+        entry->members.clear();
+    }
+    groups_.clear();
+}
+
+void EvalServer::evaluate_group(Entry &entry)
+{
+    const Program &program = entry.expr->program();
+    if (!entry.batch)
+        entry.batch = std::make_unique<BatchEvaluator>(program);
+
+    // значения запросов группы раскладываются по столбцам переменных
+    const size_t n = entry.members.size();
+    columns_.resize(entry.columns.size());
+    for (size_t v = 0; v < entry.columns.size(); ++v)
+    {
+        std::vector<double> &column = entry.columns[v];
+        column.resize(n);
+        for (size_t r = 0; r < n; ++r)
+            column[r] = values_[pending_[entry.members[r]].values + v];
+        columns_[v] = column.data();
+    }
+    results_.resize(n);
+    mask_.resize(error_mask_words(n));
+    codes_.resize(n);
+    entry.batch->evaluate(columns_.data(), n, results_.data(), mask_.data(), codes_.data());
+    for (size_t r = 0; r < n; ++r)
+    {
+        Pending &p = pending_[entry.members[r]];
+        p.status = uint8_t(codes_[r]);
+        p.value = results_[r];
+    }
+    stats_.batched += n;
+}
+
+void EvalServer::flush(Connection &conn)
+{
+    while (conn.sent < conn.out.size())
+    {
+        ssize_t put = ::send(conn.fd, conn.out.data() + conn.sent, conn.out.size() - conn.sent, MSG_NOSIGNAL);
+        if (put > 0)
+            conn.sent += size_t(put);
+        else if (put < 0 && errno == EINTR)
+            continue;
+        else
+        {
+            if (!(put < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)))
+            {
+                // клиент больше не читает: неотправленные ответы выбрасываются
+                conn.closing = true;
+                conn.out.clear();
+                conn.sent = 0;
+            }
+            return;
+        }
+    }
+    conn.out.clear();
+    conn.sent = 0;
+}
+
+void EvalServer::finish(Connection &conn)
+{
+    conn.touched = false;
+    flush(conn);
+    bool unsent = conn.sent < conn.out.size();
+    if (conn.closing && !unsent)
+    {
+        ::close(conn.fd);
+        connections_.erase(conn.fd);
+        return;
+    }
+    // чтение приостанавливается, пока клиент не заберёт ответы
+    uint32_t events = (unsent ? EPOLLOUT : 0u) |
+                      (!conn.closing && conn.out.size() - conn.sent < kMaxUnsent ? EPOLLIN : 0u);
+    if (events != conn.events)
+    {
+        conn.events = events;
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = conn.fd;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+    }
+}
+
+#else
+
+EvalServer::EvalServer(const std::string &)
+{
+    throw std::runtime_error("Режим --serve поддерживается только в Linux");
+}
+
+EvalServer::~EvalServer() = default;
+void EvalServer::close_all() {}
+void EvalServer::stop() {}
+void EvalServer::run() {}
+
+#endif
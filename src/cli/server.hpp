@@ -0,0 +1,92 @@
+// src/cli/server.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../engine/domain.hpp"
+#include "protocol.hpp"
+
+struct ServerStats
+{
+    size_t connections = 0; // принятые соединения
+    size_t requests = 0;
+    size_t batched = 0;     // запросы, вычисленные пакетом вместе с другими
+    size_t compiled = 0;    // компиляции выражений (промахи кэша)
+};
+
+// Сервер --serve: принимает кадры протокола (protocol.hpp) через Unix-сокет.
+// Один поток обслуживает все соединения через epoll. Запросы, пришедшие за
+// одну итерацию, группируются по выражению и именам переменных: группа из
+// нескольких запросов вычисляется одним вызовом BatchEvaluator, результаты
+// побитово совпадают со скалярным вычислением. Скомпилированные выражения
+// хранятся между запросами. Ответы на запросы одного соединения идут в порядке
+// запросов, клиент может отправлять следующие, не дожидаясь ответа.
+// Поддерживается только в Linux; иначе конструктор бросает std::runtime_error.
+class EvalServer
+{
+public:
+    // Создаёт сокет по пути path; оставшийся от прошлого запуска сокет удаляется
+    explicit EvalServer(const std::string &path);
+    ~EvalServer();
+    EvalServer(const EvalServer &) = delete;
+    EvalServer &operator=(const EvalServer &) = delete;
+
+    // Обслуживает соединения до вызова stop()
+    void run();
+    // Можно вызывать из другого потока и из обработчика сигнала
+    void stop();
+
+    const ServerStats &stats() const { return stats_; }
+
+private:
+    struct Connection;
+    struct Entry;
+
+    // Запрос, ожидающий вычисления в текущей итерации
+    struct Pending
+    {
+        Connection *conn;
+        uint32_t id;
+        Entry *entry;
+        size_t values; // смещение значений переменных в values_
+        uint8_t status;
+        double value;
+    };
+
+    void accept_all();
+    void read_from(Connection &conn);
+    void take_requests(Connection &conn);
+    Entry *lookup(const RequestView &request);
+    void evaluate_pending();
+    void evaluate_group(Entry &entry);
+    void flush(Connection &conn);
+    void finish(Connection &conn);
+    void close_all();
+
+    std::string path_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    bool stopping_ = false;
+
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+    std::vector<Connection *> touched_;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> cache_;
+    std::string key_;
+    RequestView request_;
+    std::vector<Pending> pending_;
+    std::vector<double> values_;
+    std::vector<Entry *> groups_;
+    // буферы пакетного вычисления группы
+    std::vector<const double *> columns_;
+    std::vector<double> results_;
+    std::vector<uint64_t> mask_;
+    std::vector<ErrorCode> codes_;
+    ServerStats stats_;
+};
@@ -0,0 +1,557 @@
+// src/cli/shm_transport.cpp
+#include "shm_transport.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include "../calc.hpp"
+#include "../engine/compiled_expr.hpp"
+#include "protocol.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#endif
+
+namespace
+{
+    constexpr uint32_t kMagic = 0x464343f1;
+    constexpr uint32_t kVersion = 1;
+    // Записей в кольце; степень двойки, счётчики идут по модулю 2^32
+    constexpr uint32_t kRingSize = 64;
+    // Итераций ожидания до засыпания на futex: pause занимает до ~140 тактов,
+    // так что это единицы микросекунд
+    constexpr int kSpin = 256;
+    // Сервер ждёт дольше: пока клиенты активны, он не засыпает и отвечает без futex
+    constexpr int kServerSpin = 64 * 1024;
+    // Спящий клиент просыпается с таким периодом, чтобы заметить остановку сервера
+    constexpr long kSleepNs = 100 * 1000 * 1000;
+    // Номеров выражений у сервера
+    constexpr size_t kMaxExprs = 65536;
+
+    enum : uint32_t
+    {
+        OP_COMPILE = 1,
+        OP_EVALUATE = 2
+    };
+
+    // Запрос: для OP_COMPILE в text лежат выражение и имена переменных,
+    // каждое с завершающим нулём, count — число имён
+    struct RequestSlot
+    {
+        uint32_t op;
+        uint32_t expr_id;
+        uint32_t count;
+        uint32_t reserved;
+        union
+        {
+            double args[kShmMaxArgs];
+            char text[kShmMaxArgs * sizeof(double)];
+        };
+    };
+
+    struct ResponseSlot
+    {
+        uint32_t expr_id;
+        uint8_t status;
+        uint8_t reserved[3];
+        double value;
+        char message[112]; // текст ошибки с завершающим нулём
+    };
+
+    static_assert(sizeof(RequestSlot) == 256, "запрос занимает 256 байт");
+    static_assert(sizeof(ResponseSlot) == 128, "ответ занимает 128 байт");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "атомики в разделяемой памяти должны быть без блокировок");
+
+    // Счётчики производителя и потребителя лежат в разных строках кэша
+    struct Channel
+    {
+        alignas(64) std::atomic<uint32_t> owner;          // pid клиента, 0 — канал свободен
+        alignas(64) std::atomic<uint32_t> request_tail;   // пишет клиент
+        alignas(64) std::atomic<uint32_t> request_head;   // пишет сервер
+        alignas(64) std::atomic<uint32_t> response_tail;  // пишет сервер; слово futex клиента
+        alignas(64) std::atomic<uint32_t> response_head;  // пишет клиент
+        std::atomic<uint32_t> client_sleeping;
+        alignas(64) RequestSlot requests[kRingSize];
+        ResponseSlot responses[kRingSize];
+    };
+
+    struct Segment
+    {
+        alignas(64) std::atomic<uint32_t> magic; // пишется последним; 0 — сервер остановлен
+        uint32_t version;
+        uint32_t channels;
+        alignas(64) std::atomic<uint32_t> doorbell; // слово futex сервера
+        std::atomic<uint32_t> server_sleeping;
+    };
+
+    size_t segment_size(size_t channels) { return sizeof(Segment) + channels * sizeof(Channel); }
+
+    Channel *channel_at(Segment *segment, size_t k)
+    {
+        return reinterpret_cast<Channel *>(reinterpret_cast<char *>(segment) + sizeof(Segment)) + k;
+    }
+
+    void copy_message(ResponseSlot &slot, const std::string &text)
+    {
+        // обрезается по границе символа UTF-8
+        size_t n = std::min(text.size(), sizeof(slot.message) - 1);
+        while (n > 0 && n < text.size() && (uint8_t(text[n]) & 0xC0) == 0x80)
+            --n;
+        std::memcpy(slot.message, text.data(), n);
+        slot.message[n] = '\0';
+    }
+} // namespace
+
+#ifdef __linux__
+
+namespace
+{
+    // На одном ядре ждущая сторона только мешает другой: сразу засыпаем
+    int spin_limit(int spin)
+    {
+        static const bool multicore = std::thread::hardware_concurrency() > 1;
+        return multicore ? spin : 0;
+    }
+
+    inline void cpu_relax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
+    }
+
+    // Сегмент разделяют процессы, поэтому futex без FUTEX_PRIVATE_FLAG
+    void futex_wait(std::atomic<uint32_t> &word, uint32_t expected, long timeout_ns)
+    {
+        timespec ts{0, timeout_ns};
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+    }
+
+    void futex_wake(std::atomic<uint32_t> &word)
+    {
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+    }
+
+    std::runtime_error system_error(const std::string &what)
+    {
+        return std::runtime_error(what + ": " + std::strerror(errno));
+    }
+
+    // Отображение сегмента в память процесса
+    struct Mapping
+    {
+        Segment *segment = nullptr;
+        size_t size = 0;
+
+        ~Mapping()
+        {
+            if (segment)
+                ::munmap(segment, size);
+        }
+
+        void map(int fd, size_t bytes, const std::string &name)
+        {
+            void *p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                auto error = system_error("Не удалось отобразить сегмент " + name);
+                ::close(fd);
+                throw error;
+            }
+            ::close(fd);
+            segment = static_cast<Segment *>(p);
+            size = bytes;
+        }
+    };
+} // namespace
+
+struct ShmServer::Impl
+{
+    std::string name;
+    Mapping mapping;
+    std::vector<std::unique_ptr<CompiledExpr>> exprs;
+    std::unordered_map<std::string, uint32_t> ids; // ключ: текст запроса компиляции
+};
+
+ShmServer::ShmServer(const std::string &name, size_t channels) : impl_(std::make_unique<Impl>())
+{
+    impl_->name = name;
+    // сегмент прошлого запуска пересоздаётся: клиенты должны подключиться заново
+    ::shm_unlink(name.c_str());
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        throw system_error("Не удалось создать сегмент " + name);
+    size_t bytes = segment_size(channels);
+    if (::ftruncate(fd, off_t(bytes)) != 0)
+    {
+        auto error = system_error("Не удалось задать размер сегмента " + name);
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw error;
+    }
+    impl_->mapping.map(fd, bytes, name);
+
+    // ftruncate заполняет сегмент нулями: кольца пусты, каналы свободны
+    Segment *segment = impl_->mapping.segment;
+    segment->version = kVersion;
+    segment->channels = uint32_t(channels);
+    segment->magic.store(kMagic, std::memory_order_release);
+}
+
+ShmServer::~ShmServer()
+{
+    // клиенты видят остановку по нулевой сигнатуре
+    impl_->mapping.segment->magic.store(0, std::memory_order_release);
+    for (uint32_t k = 0; k < impl_->mapping.segment->channels; ++k)
+        futex_wake(channel_at(impl_->mapping.segment, k)->response_tail);
+    ::shm_unlink(impl_->name.c_str());
+}
+
+void ShmServer::stop()
+{
+    stop_.store(true);
+    Segment *segment = impl_->mapping.segment;
+    segment->doorbell.fetch_add(1);
+    futex_wake(segment->doorbell);
+}
+
+void ShmServer::run()
+{
+    Segment *segment = impl_->mapping.segment;
+    auto &exprs = impl_->exprs;
+
+    auto compile = [&](const RequestSlot &req, ResponseSlot &resp)
+    {
+        // текст запроса заканчивается нулём после последнего имени
+        const char *p = req.text;
+        const char *end = req.text + sizeof(req.text);
+        std::string key;
+        uint64_t strings = 0;
+        for (; strings <= req.count && p < end; ++strings)
+        {
+            size_t len = strnlen(p, size_t(end - p));
+            key.append(p, len).push_back('\0');
+            p += len + 1;
+        }
+        // выражение и все count имён, каждое со своим нулём
+        bool complete = p <= end && strings == uint64_t(req.count) + 1;
+        auto it = impl_->ids.find(key);
+        if (complete && req.count <= kShmMaxArgs && it != impl_->ids.end())
+        {
+            resp.expr_id = it->second;
+            return;
+        }
+        try
+        {
+            if (!complete)
+                throw CalcError("Запрос компиляции повреждён");
+            // номер выражения с большим числом переменных вызвать нельзя
+            if (req.count > kShmMaxArgs)
+                throw CalcError("Переменных больше " + std::to_string(kShmMaxArgs));
+            if (exprs.size() >= kMaxExprs)
+                throw CalcError("Слишком много выражений");
+            std::vector<std::string> names;
+            size_t pos = key.find('\0');
+            std::string expr = key.substr(0, pos);
+            while (++pos < key.size())
+            {
+                size_t next = key.find('\0', pos);
+                names.push_back(key.substr(pos, next - pos));
+                pos = next;
+            }
+            exprs.push_back(std::make_unique<CompiledExpr>(expr, std::move(names)));
+            resp.expr_id = uint32_t(exprs.size() - 1);
+            impl_->ids.emplace(std::move(key), resp.expr_id);
+            ++stats_.compiled;
+        }
+        catch (const std::exception &e)
+        {
+            resp.status = kStatusInvalid;
+            copy_message(resp, e.what());
+        }
+    };
+
+    auto evaluate = [&](const RequestSlot &req, ResponseSlot &resp)
+    {
+        resp.expr_id = req.expr_id;
+        if (req.expr_id >= exprs.size() || req.count != exprs[req.expr_id]->variables().size())
+        {
+            resp.status = kStatusInvalid;
+            copy_message(resp, req.expr_id >= exprs.size() ? "Неизвестный номер выражения"
+                                                           : "Неверное число аргументов");
+            return;
+        }
+        ErrorCode code = exprs[req.expr_id]->try_evaluate(req.args, resp.value);
+        resp.status = uint8_t(code);
+        if (code != ErrorCode::OK)
+            resp.value = std::numeric_limits<double>::quiet_NaN();
+        ++stats_.evaluated;
+    };
+
+    // Обрабатывает доступные запросы всех каналов; true, если что-то сделано
+    auto poll = [&]
+    {
+        bool any = false;
+        for (uint32_t k = 0; k < segment->channels; ++k)
+        {
+            Channel &ch = *channel_at(segment, k);
+            uint32_t head = ch.request_head.load(std::memory_order_relaxed);
+            uint32_t tail = ch.request_tail.load(std::memory_order_acquire);
+            uint32_t out = ch.response_tail.load(std::memory_order_relaxed);
+            // запрос берётся, только если для ответа есть место
+            while (head != tail && out - ch.response_head.load(std::memory_order_acquire) < kRingSize)
+            {
+                const RequestSlot &req = ch.requests[head % kRingSize];
+                ResponseSlot &resp = ch.responses[out % kRingSize];
+                resp.status = 0;
+                resp.value = 0.0;
+                resp.message[0] = '\0';
+                if (req.op == OP_COMPILE)
+                    compile(req, resp);
+                else
+                    evaluate(req, resp);
+                ch.request_head.store(++head, std::memory_order_release);
+                ch.response_tail.store(++out, std::memory_order_release);
+                any = true;
+            }
+            if (any)
+            {
+                // пара к барьеру клиента перед засыпанием
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (ch.client_sleeping.load(std::memory_order_relaxed))
+                    futex_wake(ch.response_tail);
+            }
+        }
+        return any;
+    };
+
+    int idle = 0;
+    while (!stop_.load(std::memory_order_relaxed))
+    {
+        if (poll())
+        {
+            idle = 0;
+            continue;
+        }
+        if (++idle < spin_limit(kServerSpin))
+        {
+            cpu_relax();
+            continue;
+        }
+        uint32_t bell = segment->doorbell.load();
+        segment->server_sleeping.store(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!poll() && !stop_.load())
+        {
+            futex_wait(segment->doorbell, bell, kSleepNs);
+            ++stats_.sleeps;
+        }
+        segment->server_sleeping.store(0, std::memory_order_relaxed);
+        idle = 0;
+    }
+}
+
+struct ShmClient::Impl
+{
+    Mapping mapping;
+    Channel *channel = nullptr;
+
+    Segment &segment() { return *mapping.segment; }
+
+    // Отправляет запрос, заполненный fill, и ждёт ответ
+    template <class F>
+    const ResponseSlot &call(F fill)
+    {
+        Channel &ch = *channel;
+        uint32_t tail = ch.request_tail.load(std::memory_order_relaxed);
+        fill(ch.requests[tail % kRingSize]);
+        ch.request_tail.store(tail + 1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (segment().server_sleeping.load(std::memory_order_relaxed))
+        {
+            segment().doorbell.fetch_add(1);
+            futex_wake(segment().doorbell);
+        }
+
+        uint32_t head = ch.response_head.load(std::memory_order_relaxed);
+        for (int spin = 0; ch.response_tail.load(std::memory_order_acquire) == head; ++spin)
+        {
+            if (spin < spin_limit(kSpin))
+            {
+                cpu_relax();
+                continue;
+            }
+            ch.client_sleeping.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ch.response_tail.load(std::memory_order_acquire) == head)
+            {
+                if (segment().magic.load(std::memory_order_acquire) != kMagic)
+                {
+                    ch.client_sleeping.store(0, std::memory_order_relaxed);
+                    throw std::runtime_error("Сервер разделяемой памяти остановлен");
+                }
+                futex_wait(ch.response_tail, head, kSleepNs);
+            }
+            ch.client_sleeping.store(0, std::memory_order_relaxed);
+        }
+        return ch.responses[head % kRingSize];
+    }
+
+    void release() { channel->response_head.fetch_add(1, std::memory_order_release); }
+
+    // Канал, владелец которого завершился, не освободив его (kill, падение).
+    // Клиент синхронный, поэтому в кольцах остаётся не больше одного запроса
+    // и одного ответа: сервер дорабатывает запрос, после чего непрочитанные
+    // ответы пропускаются. Счётчики сервера не трогаются — их пишет только он.
+    bool reclaim(Channel &ch, uint32_t self)
+    {
+        uint32_t owner = ch.owner.load(std::memory_order_acquire);
+        if (owner == 0 || ::kill(pid_t(owner), 0) == 0 || errno != ESRCH ||
+            !ch.owner.compare_exchange_strong(owner, self))
+            return false;
+        while (ch.request_head.load(std::memory_order_acquire) != ch.request_tail.load(std::memory_order_relaxed))
+        {
+            if (segment().magic.load(std::memory_order_acquire) != kMagic)
+                throw std::runtime_error("Сервер разделяемой памяти остановлен");
+            segment().doorbell.fetch_add(1);
+            futex_wake(segment().doorbell);
+            std::this_thread::yield();
+        }
+        ch.response_head.store(ch.response_tail.load(std::memory_order_acquire), std::memory_order_release);
+        ch.client_sleeping.store(0, std::memory_order_relaxed);
+        return true;
+    }
+};
+
+ShmClient::ShmClient(const std::string &name) : impl_(std::make_unique<Impl>())
+{
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+        throw system_error("Не удалось открыть сегмент " + name);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(Segment))
+    {
+        ::close(fd);
+        throw std::runtime_error("Сегмент " + name + " не создан сервером");
+    }
+    impl_->mapping.map(fd, size_t(st.st_size), name);
+    Segment &segment = impl_->segment();
+    if (segment.magic.load(std::memory_order_acquire) != kMagic || segment.version != kVersion ||
+        segment_size(segment.channels) > impl_->mapping.size)
+        throw std::runtime_error("Сегмент " + name + " не создан сервером или остановлен");
+
+    const uint32_t self = uint32_t(::getpid());
+    for (uint32_t k = 0; k < segment.channels && !impl_->channel; ++k)
+    {
+        Channel *ch = channel_at(&segment, k);
+        uint32_t free = 0;
+        if (ch->owner.compare_exchange_strong(free, self))
+            impl_->channel = ch;
+    }
+    for (uint32_t k = 0; k < segment.channels && !impl_->channel; ++k)
+        if (impl_->reclaim(*channel_at(&segment, k), self))
+            impl_->channel = channel_at(&segment, k);
+    if (!impl_->channel)
+        throw std::runtime_error("Все каналы сегмента " + name + " заняты");
+}
+
+ShmClient::~ShmClient()
+{
+    // вызовы синхронные, поэтому в кольцах канала ничего не осталось
+    if (impl_->channel)
+        impl_->channel->owner.store(0, std::memory_order_release);
+}
+
+uint32_t ShmClient::compile(const std::string &expr, const std::vector<std::string> &variables)
+{
+    size_t size = expr.size() + 1;
+    for (const std::string &v : variables)
+        size += v.size() + 1;
+    if (size > sizeof(RequestSlot::text))
+        throw std::length_error("Выражение с переменными длиннее " + std::to_string(sizeof(RequestSlot::text)) + " байт");
+
+    const ResponseSlot &resp = impl_->call([&](RequestSlot &req)
+                                           {
+        req.op = OP_COMPILE;
+        req.count = uint32_t(variables.size());
+        char *p = req.text;
+        std::memcpy(p, expr.c_str(), expr.size() + 1);
+        p += expr.size() + 1;
+        for (const std::string &v : variables)
+        {
+            std::memcpy(p, v.c_str(), v.size() + 1);
+            p += v.size() + 1;
+        } });
+    uint8_t status = resp.status;
+    uint32_t id = resp.expr_id;
+    std::string message = status == kStatusInvalid ? resp.message : "";
+    impl_->release();
+    if (status == kStatusInvalid)
+        throw CalcError(message);
+    return id;
+}
+
+ErrorCode ShmClient::evaluate(uint32_t expr_id, const double *args, size_t count, double &result)
+{
+    if (count > kShmMaxArgs)
+        throw CalcError("Неверное число аргументов");
+    const ResponseSlot &resp = impl_->call([&](RequestSlot &req)
+                                           {
+        req.op = OP_EVALUATE;
+        req.expr_id = expr_id;
+        req.count = uint32_t(count);
+        std::memcpy(req.args, args, count * sizeof(double)); });
+    uint8_t status = resp.status;
+    result = resp.value;
+    if (status == kStatusInvalid)
+    {
+        std::string message = resp.message;
+        impl_->release();
+        throw CalcError(message);
+    }
+    impl_->release();
+    return ErrorCode(status);
+}
+
+#else
+
+struct ShmServer::Impl
+{
+};
+
+struct ShmClient::Impl
+{
+};
+
+ShmServer::ShmServer(const std::string &, size_t)
+{
+    throw std::runtime_error("Транспорт разделяемой памяти поддерживается только в Linux");
+}
+ShmServer::~ShmServer() = default;
+void ShmServer::run() {}
+void ShmServer::stop() {}
+
+ShmClient::ShmClient(const std::string &)
+{
+    throw std::runtime_error("Транспорт разделяемой памяти поддерживается только в Linux");
+}
+ShmClient::~ShmClient() = default;
+uint32_t ShmClient::compile(const std::string &, const std::vector<std::string> &) { return 0; }
+ErrorCode ShmClient::evaluate(uint32_t, const double *, size_t, double &) { return ErrorCode::OK; }
+
+#endif
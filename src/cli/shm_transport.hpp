@@ -0,0 +1,80 @@
+// src/cli/shm_transport.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../engine/domain.hpp"
+
+// Транспорт через разделяемую память для клиентов на той же машине
+// (см. document/cli.md). Сегмент POSIX shm содержит каналы; каждый канал —
+// пара однонаправленных колец без блокировок: запросы клиента и ответы
+// сервера. Канал занимает один клиент, сервер опрашивает все каналы,
+// поэтому вместе они образуют очередь многих производителей к одному
+// потребителю. Ожидающая сторона сначала крутится, затем засыпает на futex.
+// Только Linux; иначе конструкторы бросают std::runtime_error.
+
+// Аргументов в одном запросе вычисления
+static constexpr size_t kShmMaxArgs = 30;
+
+struct ShmStats
+{
+    size_t compiled = 0;
+    size_t evaluated = 0;
+    size_t sleeps = 0; // засыпания сервера на futex
+};
+
+// Сервер: создаёт сегмент name (например "/fast_calc") и вычисляет запросы
+// клиентов. Выражения компилируются один раз; номер выражения действует,
+// пока сервер работает, и общий для всех клиентов.
+class ShmServer
+{
+public:
+    explicit ShmServer(const std::string &name, size_t channels = 16);
+    ~ShmServer();
+    ShmServer(const ShmServer &) = delete;
+    ShmServer &operator=(const ShmServer &) = delete;
+
+    // Обслуживает каналы до вызова stop()
+    void run();
+    // Можно вызывать из другого потока и из обработчика сигнала
+    void stop();
+
+    const ShmStats &stats() const { return stats_; }
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+    std::atomic<bool> stop_{false};
+    ShmStats stats_;
+};
+
+// Клиент: занимает свободный канал сегмента name; если свободных нет —
+// канал клиента, процесс которого завершился, не освободив его. Методы синхронные и не
+// выделяют память на пути вычисления; один объект используется одним потоком.
+class ShmClient
+{
+public:
+    explicit ShmClient(const std::string &name);
+    ~ShmClient();
+    ShmClient(const ShmClient &) = delete;
+    ShmClient &operator=(const ShmClient &) = delete;
+
+    // Номер скомпилированного выражения; бросает CalcError с текстом ошибки
+    // разбора или если переменных больше kShmMaxArgs, std::length_error —
+    // если текст не помещается в запрос
+    uint32_t compile(const std::string &expr, const std::vector<std::string> &variables = {});
+
+    // args — по значению на переменную в порядке compile(). Ошибка области
+    // определения возвращается кодом; неизвестный номер или неверное число
+    // аргументов — CalcError; остановленный сервер — std::runtime_error
+    ErrorCode evaluate(uint32_t expr_id, const double *args, size_t count, double &result);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
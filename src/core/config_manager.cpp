@@ -220,3 +220,49 @@ string ConfigManager::get_key(const string &action) const
     }
     return {};
 }
+
+void ConfigManager::set_engine_threads(size_t threads)
+{
+    if (auto *engine = EnsureTable(config_data_, "engine"))
+    {
+        engine->insert_or_assign("threads", static_cast<int64_t>(threads));
+    }
+}
+
+size_t ConfigManager::get_engine_threads() const
+{
+    if (const auto *engine = FindTable(config_data_, "engine"))
+    {
+        if (const auto *value_node = engine->get("threads"))
+        {
+            if (auto value = value_node->value<int64_t>(); value && *value > 0)
+            {
+                return static_cast<size_t>(*value);
+            }
+        }
+    }
+    return 0;
+}
+
+void ConfigManager::set_engine_cache_mb(size_t megabytes)
+{
+    if (auto *engine = EnsureTable(config_data_, "engine"))
+    {
+        engine->insert_or_assign("cache_mb", static_cast<int64_t>(megabytes));
+    }
+}
+
+size_t ConfigManager::get_engine_cache_mb() const
+{
+    if (const auto *engine = FindTable(config_data_, "engine"))
+    {
+        if (const auto *value_node = engine->get("cache_mb"))
+        {
+            if (auto value = value_node->value<int64_t>(); value && *value >= 0)
+            {
+                return static_cast<size_t>(*value);
+            }
+        }
+    }
+    return kDefaultCacheMb;
+}
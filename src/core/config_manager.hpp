@@ -18,6 +18,16 @@ public:
     void set_key(const string& action, const string& key);
     string get_key(const string& action) const;
 
+    // [engine] threads: потоков для пакетных вычислений, 0 — по числу ядер
+    void set_engine_threads(size_t threads);
+    size_t get_engine_threads() const;
+
+    // [engine] cache_mb: бюджет кэша выражений в МиБ, 0 — без кэша;
+    // без ключа или при неверном значении — kDefaultCacheMb
+    static constexpr size_t kDefaultCacheMb = 8;
+    void set_engine_cache_mb(size_t megabytes);
+    size_t get_engine_cache_mb() const;
+
 private:
     string config_file_path_;
     toml::table config_data_;
@@ -0,0 +1,127 @@
+// src/engine/arena.hpp
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Линейный (bump) аллокатор для одного разбора выражения.
+// Владеет токенами и скопированными строками входа. Память не
+// освобождается поштучно: reset() за O(1) откатывает указатель на начало,
+// сохраняя уже выделенные блоки, поэтому в установившемся режиме повторный
+// разбор не обращается к malloc.
+class Arena
+{
+public:
+    static constexpr size_t kDefaultChunkSize = 16 * 1024;
+
+    explicit Arena(size_t chunk_size = kDefaultChunkSize) : chunk_size_(chunk_size) {}
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t size, size_t align)
+    {
+        if (!chunks_.empty())
+        {
+            if (void *p = bump(chunks_[current_], size, align))
+                return p;
+            // следующий блок мог остаться от прошлых разборов
+            while (current_ + 1 < chunks_.size())
+            {
+                ++current_;
+                offset_ = 0;
+                if (void *p = bump(chunks_[current_], size, align))
+                    return p;
+            }
+        }
+        chunks_.push_back(Chunk{std::make_unique<std::byte[]>(std::max(chunk_size_, size + align)),
+                                std::max(chunk_size_, size + align)});
+        current_ = chunks_.size() - 1;
+        offset_ = 0;
+        return bump(chunks_[current_], size, align);
+    }
+
+    // Объекты арены не разрушаются, поэтому допускаются только тривиально разрушаемые типы
+    template <class T, class... Args>
+    T *make(Args &&...args)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena holds only trivially destructible types");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <class T>
+    T *allocate_array(size_t n)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena holds only trivially destructible types");
+        return static_cast<T *>(allocate(sizeof(T) * (n ? n : 1), alignof(T)));
+    }
+
+    // Копирует строку в арену; результат живёт до reset()
+    std::string_view intern(std::string_view s)
+    {
+        char *p = allocate_array<char>(s.size());
+        std::copy(s.begin(), s.end(), p);
+        return std::string_view(p, s.size());
+    }
+
+    void reset()
+    {
+        current_ = 0;
+        offset_ = 0;
+    }
+
+    // Сбрасывает арену при выходе из области видимости (в том числе по исключению)
+    class Scope
+    {
+    public:
+        explicit Scope(Arena &a) : arena_(a) { arena_.reset(); }
+        ~Scope() { arena_.reset(); }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Arena &arena_;
+    };
+
+private:
+    struct Chunk
+    {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    void *bump(Chunk &c, size_t size, size_t align)
+    {
+        uintptr_t base = reinterpret_cast<uintptr_t>(c.data.get());
+        uintptr_t p = (base + offset_ + align - 1) & ~(uintptr_t(align) - 1);
+        if (p + size > base + c.size)
+            return nullptr;
+        offset_ = p + size - base;
+        return reinterpret_cast<void *>(p);
+    }
+
+    size_t chunk_size_;
+    std::vector<Chunk> chunks_;
+    size_t current_ = 0;
+    size_t offset_ = 0;
+};
+
+// Непрерывный массив, размещённый в арене
+template <class T>
+struct ArenaSpan
+{
+    T *data = nullptr;
+    size_t size = 0;
+
+    T *begin() const { return data; }
+    T *end() const { return data + size; }
+    T &operator[](size_t i) const { return data[i]; }
+    bool empty() const { return size == 0; }
+};
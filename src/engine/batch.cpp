@@ -0,0 +1,296 @@
+// src/engine/batch.cpp
+#include "batch.hpp"
+#include "vm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    // Циклы над блоком записаны без ветвлений внутри тела, чтобы компилятор
+    // мог их векторизовать; сочетания скаляра и столбца разнесены по отдельным функциям.
+    template <class F>
+    void map1(const double *a, double *dst, size_t n, F f)
+    {
+        for (size_t r = 0; r < n; ++r)
+            dst[r] = f(a[r]);
+    }
+
+    template <class F>
+    void map2_vv(const double *a, const double *b, double *dst, size_t n, F f)
+    {
+        for (size_t r = 0; r < n; ++r)
+            dst[r] = f(a[r], b[r]);
+    }
+
+    template <class F>
+    void map2_vs(const double *a, double b, double *dst, size_t n, F f)
+    {
+        for (size_t r = 0; r < n; ++r)
+            dst[r] = f(a[r], b);
+    }
+
+    template <class F>
+    void map2_sv(double a, const double *b, double *dst, size_t n, F f)
+    {
+        for (size_t r = 0; r < n; ++r)
+            dst[r] = f(a, b[r]);
+    }
+
+    // Запоминает для строки только первую ошибку — как и скалярное
+    // вычисление, которое останавливается на первой же проверке
+    inline void note(uint8_t &slot, ErrorCode code)
+    {
+        uint8_t c = uint8_t(code);
+        slot = slot ? slot : c;
+    }
+} // namespace
+
+BatchEvaluator::BatchEvaluator(const Program &program)
+    : program_(program),
+      kernels_(kernels_for(program.accuracy)),
+      slots_(size_t(program.max_stack) * kBatchBlock),
+      errors_(kBatchBlock),
+      broadcast_(kBatchBlock),
+      temps_(program.temps),
+      temp_slots_(size_t(program.temps) * kBatchBlock)
+{
+    stack_.reserve(program.max_stack);
+}
+
+size_t BatchEvaluator::evaluate(const double *const *columns, size_t rows, double *out,
+                                uint64_t *error_mask, ErrorCode *codes)
+{
+    std::memset(error_mask, 0, error_mask_words(rows) * sizeof(uint64_t));
+    size_t failed = 0;
+    for (size_t first = 0; first < rows; first += kBatchBlock)
+    {
+        size_t n = std::min(kBatchBlock, rows - first);
+        failed += evaluate_block(columns, first, n, out, codes);
+        // kBatchBlock кратен 64, поэтому блок целиком покрывает свои слова маски
+        for (size_t r = 0; r < n; ++r)
+            error_mask[(first + r) / 64] |= uint64_t(errors_[r] != 0) << ((first + r) % 64);
+    }
+    return failed;
+}
+
+size_t BatchEvaluator::evaluate_block(const double *const *columns, size_t first, size_t n,
+                                      double *out, ErrorCode *codes)
+{
+    static_assert(kBatchBlock % 64 == 0, "блок должен покрывать целые слова маски");
+
+    uint8_t *err = errors_.data();
+    std::memset(err, 0, n);
+    stack_.clear();
+
+    auto slot_buffer = [&](size_t k)
+    { return slots_.data() + k * kBatchBlock; };
+
+    auto unary = [&](auto f)
+    {
+        Operand &t = stack_.back();
+        if (t.is_scalar)
+        {
+            t.scalar = f(t.scalar);
+            return;
+        }
+        double *dst = slot_buffer(stack_.size() - 1);
+        map1(t.data, dst, n, f);
+        t.data = dst;
+    };
+
+    auto binary = [&](auto f)
+    {
+        Operand b = stack_.back();
+        stack_.pop_back();
+        Operand &a = stack_.back();
+        if (a.is_scalar && b.is_scalar)
+        {
+            a.scalar = f(a.scalar, b.scalar);
+            return;
+        }
+        double *dst = slot_buffer(stack_.size() - 1);
+        if (a.is_scalar)
+            map2_sv(a.scalar, b.data, dst, n, f);
+        else if (b.is_scalar)
+            map2_vs(a.data, b.scalar, dst, n, f);
+        else
+            map2_vv(a.data, b.data, dst, n, f);
+        a.data = dst;
+        a.is_scalar = false;
+    };
+
+    // a*b + c: скалярные операнды читаются без размножения по блоку
+    auto fma3 = [&]()
+    {
+        Operand c = stack_.back();
+        stack_.pop_back();
+        Operand b = stack_.back();
+        stack_.pop_back();
+        Operand &a = stack_.back();
+        if (a.is_scalar && b.is_scalar && c.is_scalar)
+        {
+            a.scalar = std::fma(a.scalar, b.scalar, c.scalar);
+            return;
+        }
+        double *dst = slot_buffer(stack_.size() - 1);
+        for (size_t r = 0; r < n; ++r)
+            dst[r] = std::fma(a.is_scalar ? a.scalar : a.data[r], b.is_scalar ? b.scalar : b.data[r],
+                              c.is_scalar ? c.scalar : c.data[r]);
+        a.data = dst;
+        a.is_scalar = false;
+    };
+
+    // Столбец из буфера стека перезапишется следующими инструкциями, поэтому
+    // он копируется; столбец переменной и скаляр сохраняются как есть
+    auto store = [&](uint32_t t)
+    {
+        Operand o = stack_.back();
+        const double *slots = slots_.data();
+        if (!o.is_scalar && o.data >= slots && o.data < slots + slots_.size())
+        {
+            double *copy = temp_slots_.data() + size_t(t) * kBatchBlock;
+            std::memcpy(copy, o.data, n * sizeof(double));
+            o.data = copy;
+        }
+        temps_[t] = o;
+    };
+
+    // Функции считаются ядрами над всем столбцом; скалярный аргумент —
+    // той же функцией libm, что и в VM
+    auto call1 = [&](FuncId f)
+    {
+        Operand &t = stack_.back();
+        if (t.is_scalar)
+        {
+            t.scalar = call_func1(f, t.scalar);
+            return;
+        }
+        double *dst = slot_buffer(stack_.size() - 1);
+        kernels_.fn1[size_t(f)](t.data, dst, n);
+        t.data = dst;
+    };
+
+    auto call2 = [&](FuncId f)
+    {
+        Operand b = stack_.back();
+        stack_.pop_back();
+        Operand &a = stack_.back();
+        if (a.is_scalar && b.is_scalar)
+        {
+            a.scalar = call_func2(f, a.scalar, b.scalar);
+            return;
+        }
+        auto column = [&](const Operand &o)
+        {
+            if (!o.is_scalar)
+                return o.data;
+            std::fill_n(broadcast_.data(), n, o.scalar);
+            return static_cast<const double *>(broadcast_.data());
+        };
+        double *dst = slot_buffer(stack_.size() - 1);
+        kernels_.fn2[size_t(f)](column(a), column(b), dst, n);
+        a.data = dst;
+        a.is_scalar = false;
+    };
+
+    auto check = [&](CheckKind kind)
+    {
+        bool two = check_arity(kind) == 2;
+        const Operand &b = stack_.back();
+        const Operand &a = two ? stack_[stack_.size() - 2] : b;
+        if (a.is_scalar && (!two || b.is_scalar))
+        {
+            ErrorCode code = check_domain(kind, a.scalar, two ? b.scalar : 0.0);
+            if (code != ErrorCode::OK)
+                for (size_t r = 0; r < n; ++r)
+                    note(err[r], code);
+            return;
+        }
+        for (size_t r = 0; r < n; ++r)
+        {
+            double av = a.is_scalar ? a.scalar : a.data[r];
+            double bv = !two ? 0.0 : (b.is_scalar ? b.scalar : b.data[r]);
+            note(err[r], check_domain(kind, av, bv));
+        }
+    };
+
+    for (const Instr &in : program_.code)
+    {
+        switch (in.op)
+        {
+        case OpCode::PUSH:
+            stack_.push_back(Operand{nullptr, program_.consts[in.operand], true});
+            break;
+        case OpCode::LOAD:
+            // столбец переменной используется на месте, без копирования
+            stack_.push_back(Operand{columns[in.operand] + first, 0.0, false});
+            break;
+        case OpCode::NEG:
+            unary([](double x)
+                  { return -x; });
+            break;
+        case OpCode::FACT:
+            unary([](double x)
+                  { return std::tgamma(std::round(x) + 1.0); });
+            break;
+        case OpCode::ADD:
+            binary([](double a, double b)
+                   { return a + b; });
+            break;
+        case OpCode::SUB:
+            binary([](double a, double b)
+                   { return a - b; });
+            break;
+        case OpCode::MUL:
+            binary([](double a, double b)
+                   { return a * b; });
+            break;
+        case OpCode::DIV:
+            binary([](double a, double b)
+                   { return a / b; });
+            break;
+        case OpCode::POW:
+            call2(FuncId::POW);
+            break;
+        case OpCode::FMA:
+            fma3();
+            break;
+        case OpCode::CALL1:
+            call1(FuncId(in.arg));
+            break;
+        case OpCode::CALL2:
+            call2(FuncId(in.arg));
+            break;
+        case OpCode::CHECK:
+            check(CheckKind(in.arg));
+            break;
+        case OpCode::STORE:
+            store(in.operand);
+            break;
+        case OpCode::FETCH:
+            stack_.push_back(temps_[in.operand]);
+            break;
+        case OpCode::RET:
+        default:
+        {
+            const Operand &r = stack_.back();
+            const double nan = std::numeric_limits<double>::quiet_NaN();
+            size_t failed = 0;
+            for (size_t k = 0; k < n; ++k)
+            {
+                double v = r.is_scalar ? r.scalar : r.data[k];
+                out[first + k] = err[k] ? nan : v;
+                failed += err[k] != 0;
+            }
+            if (codes)
+                for (size_t k = 0; k < n; ++k)
+                    codes[first + k] = ErrorCode(err[k]);
+            return failed;
+        }
+        }
+    }
+    return 0;
+}
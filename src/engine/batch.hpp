@@ -0,0 +1,59 @@
+// src/engine/batch.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bytecode.hpp"
+#include "simd.hpp"
+
+// Строк в одном блоке пакетного вычисления: блок из нескольких столбцов
+// стека помещается в L1/L2, а циклы по блоку векторизуются компилятором.
+static constexpr size_t kBatchBlock = 2048;
+
+// Число 64-битных слов маски ошибок для rows строк
+inline size_t error_mask_words(size_t rows) { return (rows + 63) / 64; }
+
+inline bool row_failed(const uint64_t *mask, size_t row)
+{
+    return (mask[row / 64] >> (row % 64)) & 1u;
+}
+
+// Вычисляет Program сразу над массивами значений переменных. Каждая
+// инструкция выполняется над блоком строк, ошибки области определения
+// не прерывают пакет, а отмечаются для отдельных строк. Функции считаются
+// ядрами из kernels_for(program.accuracy).
+class BatchEvaluator
+{
+public:
+    explicit BatchEvaluator(const Program &program);
+
+    // columns[v] — rows значений переменной v (program.var_count столбцов).
+    // out — rows результатов; для строк с ошибкой записывается NaN.
+    // error_mask — error_mask_words(rows) слов, бит строки выставляется при ошибке.
+    // codes (необязательно) — код первой ошибки каждой строки или ErrorCode::OK.
+    // Возвращает число строк с ошибкой.
+    size_t evaluate(const double *const *columns, size_t rows, double *out,
+                    uint64_t *error_mask, ErrorCode *codes = nullptr);
+
+private:
+    // Операнд стека: либо указатель на столбец блока, либо скаляр
+    struct Operand
+    {
+        const double *data;
+        double scalar;
+        bool is_scalar;
+    };
+
+    size_t evaluate_block(const double *const *columns, size_t first, size_t n, double *out, ErrorCode *codes);
+
+    const Program &program_;
+    const KernelSet &kernels_;
+    std::vector<double> slots_;    // max_stack буферов по kBatchBlock значений
+    std::vector<Operand> stack_;
+    std::vector<uint8_t> errors_;  // код первой ошибки для строк блока
+    std::vector<double> broadcast_; // скалярный операнд функции двух аргументов, размноженный на блок
+    std::vector<Operand> temps_;    // временные ячейки STORE/FETCH
+    std::vector<double> temp_slots_; // копии столбцов временных ячеек, по kBatchBlock на ячейку
+};
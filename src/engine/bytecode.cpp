@@ -0,0 +1,223 @@
+// src/engine/bytecode.cpp
+#include "bytecode.hpp"
+
+CheckKind check_for(FuncId f)
+{
+    switch (f)
+    {
+    case FuncId::TAN:
+        return CheckKind::TAN;
+    case FuncId::ASIN:
+        return CheckKind::ASIN;
+    case FuncId::ACOS:
+        return CheckKind::ACOS;
+    case FuncId::SQRT:
+        return CheckKind::SQRT;
+    case FuncId::LN:
+        return CheckKind::LN;
+    case FuncId::LG:
+        return CheckKind::LG;
+    case FuncId::ROOT:
+        return CheckKind::ROOT;
+    case FuncId::LOG:
+        return CheckKind::LOG;
+    default:
+        return CheckKind::COUNT;
+    }
+}
+
+namespace
+{
+    class Compiler
+    {
+    public:
+        Compiler(const Ast &ast, Program &out, bool fuse_fma)
+            : ast_(ast), p_(out), fuse_fma_(fuse_fma), uses_(ast.nodes.size(), 0), temp_(ast.nodes.size(), kNoTemp)
+        {
+            for (const AstNode &n : ast.nodes)
+                for (uint32_t k = 0; k < kid_count(n); ++k)
+                    ++uses_[n.kids[k]];
+        }
+
+        // Узел с несколькими родителями (DAG после share_subexpressions)
+        // вычисляется при первом обращении и сохраняется во временную ячейку,
+        // остальные обращения читают её. Листья дешевле положить заново.
+        void compile_node(uint32_t i)
+        {
+            if (temp_[i] != kNoTemp)
+            {
+                emit(OpCode::FETCH, 0, temp_[i]);
+                grow();
+                return;
+            }
+            compile_value(i);
+            if (uses_[i] > 1 && kid_count(ast_[i]) > 0 && p_.temps < kMaxTemps)
+            {
+                temp_[i] = p_.temps++;
+                emit(OpCode::STORE, 0, temp_[i]);
+            }
+        }
+
+        void compile_value(uint32_t i)
+        {
+            const AstNode &n = ast_[i];
+            switch (n.op)
+            {
+            case NodeOp::NUMBER:
+                push_const(n.number);
+                break;
+            case NodeOp::CONST:
+                // значения констант вычисляются один раз, при компиляции
+                push_const(get_const(ConstId(n.id)));
+                break;
+            case NodeOp::VAR:
+                emit(OpCode::LOAD, 0, n.id);
+                grow();
+                break;
+            case NodeOp::POS:
+                compile_node(n.kids[0]);
+                break;
+            case NodeOp::NEG:
+                compile_node(n.kids[0]);
+                emit(OpCode::NEG);
+                break;
+            case NodeOp::FACT:
+                compile_node(n.kids[0]);
+                emit(OpCode::CHECK, uint8_t(CheckKind::FACT));
+                emit(OpCode::FACT);
+                break;
+            case NodeOp::ADD:
+            case NodeOp::SUB:
+                if (fuse_fma_ && compile_fma(n))
+                    break;
+                [[fallthrough]];
+            case NodeOp::MUL:
+            case NodeOp::DIV:
+            case NodeOp::POW:
+                compile_node(n.kids[0]);
+                compile_node(n.kids[1]);
+                if (n.op == NodeOp::DIV)
+                    emit(OpCode::CHECK, uint8_t(CheckKind::DIV));
+                if (n.op == NodeOp::POW)
+                    emit(OpCode::CHECK, uint8_t(CheckKind::POW));
+                emit(binary_opcode(n.op));
+                --depth_;
+                break;
+            case NodeOp::CALL:
+            {
+                FuncId f = FuncId(n.id);
+                bool two = func_info(f).arity == 2;
+                compile_node(n.kids[0]);
+                if (two)
+                    compile_node(n.kids[1]);
+                CheckKind check = check_for(f);
+                if (check != CheckKind::COUNT)
+                    emit(OpCode::CHECK, uint8_t(check));
+                emit(two ? OpCode::CALL2 : OpCode::CALL1, n.id);
+                if (two)
+                    --depth_;
+                break;
+            }
+            }
+        }
+
+        void finish()
+        {
+            emit(OpCode::RET);
+            p_.max_stack = max_depth_;
+        }
+
+    private:
+        // a*b + c, a*b - c = fma(a, b, -c), c - a*b = fma(-a, b, c);
+        // слагаемое вычисляется после множителей
+        bool compile_fma(const AstNode &n)
+        {
+            const AstNode &l = ast_[n.kids[0]];
+            const AstNode &r = ast_[n.kids[1]];
+            // общее произведение нужно и само по себе — его не сливаем
+            bool left = l.op == NodeOp::MUL && uses_[n.kids[0]] == 1;
+            if (!left && (r.op != NodeOp::MUL || uses_[n.kids[1]] != 1))
+                return false;
+            const AstNode &m = left ? l : r;
+            uint32_t addend = left ? n.kids[1] : n.kids[0];
+            compile_node(m.kids[0]);
+            if (!left && n.op == NodeOp::SUB)
+                emit(OpCode::NEG);
+            compile_node(m.kids[1]);
+            compile_node(addend);
+            if (left && n.op == NodeOp::SUB)
+                emit(OpCode::NEG);
+            emit(OpCode::FMA);
+            depth_ -= 2;
+            return true;
+        }
+
+        static OpCode binary_opcode(NodeOp op)
+        {
+            switch (op)
+            {
+            case NodeOp::ADD:
+                return OpCode::ADD;
+            case NodeOp::SUB:
+                return OpCode::SUB;
+            case NodeOp::MUL:
+                return OpCode::MUL;
+            case NodeOp::DIV:
+                return OpCode::DIV;
+            default:
+                return OpCode::POW;
+            }
+        }
+
+        void emit(OpCode op, uint8_t arg = 0, uint32_t operand = 0)
+        {
+            p_.code.push_back(Instr{op, arg, 0, operand});
+        }
+
+        void push_const(double v)
+        {
+            uint32_t idx = 0;
+            while (idx < p_.consts.size() && !same_bits(p_.consts[idx], v))
+                ++idx;
+            if (idx == p_.consts.size())
+                p_.consts.push_back(v);
+            emit(OpCode::PUSH, 0, idx);
+            grow();
+        }
+
+        void grow()
+        {
+            if (++depth_ > max_depth_)
+                max_depth_ = depth_;
+            if (max_depth_ > kVmStackSize)
+                throw CalcError("Выражение слишком сложное для вычисления");
+        }
+
+        static bool same_bits(double a, double b)
+        {
+            // -0.0 и 0.0 должны остаться разными константами
+            return a == b && std::signbit(a) == std::signbit(b);
+        }
+
+        const Ast &ast_;
+        Program &p_;
+        static constexpr uint32_t kNoTemp = UINT32_MAX;
+
+        bool fuse_fma_;
+        std::vector<uint32_t> uses_; // число родителей узла
+        std::vector<uint32_t> temp_; // временная ячейка вычисленного узла
+        uint32_t depth_ = 0;
+        uint32_t max_depth_ = 0;
+    };
+} // namespace
+
+Program compile(const Ast &ast, uint32_t var_count, bool fuse_fma)
+{
+    Program p;
+    p.var_count = var_count;
+    p.code.reserve(ast.nodes.size() * 2 + 1);
+    Compiler c(ast, p, fuse_fma);
+    c.compile_node(ast.root());
+    c.finish();
+    return p;
+}
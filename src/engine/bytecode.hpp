@@ -0,0 +1,83 @@
+// src/engine/bytecode.hpp
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../AST.hpp"
+#include "domain.hpp"
+
+// Линейный байткод для стековой машины. Проверки области определения
+// вынесены в отдельные инструкции CHECK, а CALL1/CALL2 выполняют
+// уже «чистую» математику, поэтому их можно переставлять и векторизовать.
+enum class OpCode : uint8_t
+{
+    PUSH,  // operand — индекс в Program::consts
+    LOAD,  // operand — индекс переменной
+    NEG,
+    FACT,  // tgamma(round(x) + 1), аргумент уже проверен
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    POW,
+    FMA,   // a*b + c с одним округлением; только при fuse_fma
+    CALL1, // arg — FuncId функции одного аргумента
+    CALL2, // arg — FuncId функции двух аргументов
+    CHECK, // arg — CheckKind; при нарушении выполнение прерывается
+    STORE, // копирует вершину стека во временную ячейку operand
+    FETCH, // кладёт на стек временную ячейку operand
+    RET,
+    COUNT
+};
+
+struct Instr
+{
+    OpCode op;
+    uint8_t arg;
+    uint16_t reserved;
+    uint32_t operand;
+};
+static_assert(sizeof(Instr) == 8, "Instr должен занимать 8 байт");
+
+// Уровень точности векторных ядер пакетного вычисления (см. simd.hpp).
+// STRICT даёт побитово те же значения, что скалярное вычисление через libm;
+// FAST использует полиномиальные ядра с ограниченной погрешностью.
+enum class Accuracy : uint8_t
+{
+    STRICT,
+    FAST
+};
+
+// Скомпилированная программа неизменяема: её можно выполнять сколько
+// угодно раз и из нескольких потоков одновременно.
+struct Program
+{
+    std::vector<Instr> code;
+    std::vector<double> consts;
+    uint32_t max_stack = 0;
+    uint32_t var_count = 0; // сколько значений переменных ожидает программа
+    uint32_t temps = 0;     // временных ячеек для общих подвыражений
+    Accuracy accuracy = Accuracy::STRICT;
+};
+
+// Предел глубины стека VM; выражения глубже отклоняются при компиляции
+static constexpr uint32_t kVmStackSize = 256;
+
+// Предел временных ячеек; остальные общие подвыражения вычисляются повторно
+static constexpr uint32_t kMaxTemps = 64;
+
+// Вид проверки, которую нужно выполнить перед вызовом функции (COUNT — без проверки)
+CheckKind check_for(FuncId f);
+
+#ifdef FP_FAST_FMA
+inline constexpr bool kHardwareFma = true;
+#else
+// Без аппаратного FMA в цели сборки std::fma — программная и медленнее
+// умножения со сложением, поэтому CompiledExpr не сливает их
+inline constexpr bool kHardwareFma = false;
+#endif
+
+// fuse_fma сливает a*b+c, a*b-c и c-a*b в FMA. Результат отличается от
+// раздельных операций (одно округление вместо двух), поэтому это режим fast-math
+Program compile(const Ast &ast, uint32_t var_count = 0, bool fuse_fma = false);
@@ -0,0 +1,91 @@
+// src/engine/compiled_expr.cpp
+#include "compiled_expr.hpp"
+#include "optimize.hpp"
+
+#include <atomic>
+
+namespace
+{
+    std::atomic<bool> g_default_jit{false};
+} // namespace
+
+void set_default_jit(bool enabled) { g_default_jit.store(enabled, std::memory_order_release); }
+
+bool default_jit() { return g_default_jit.load(std::memory_order_acquire); }
+
+CompiledExpr::CompiledExpr(const std::string &expr, std::vector<std::string> variables,
+                           const CompileOptions &options)
+    : variables_(std::move(variables)), values_(variables_.size(), 0.0)
+{
+    for (size_t k = 0; k < variables_.size(); ++k)
+    {
+        if (!is_valid_variable_name(variables_[k]))
+            throw CalcError("Недопустимое имя переменной: " + variables_[k]);
+        for (size_t j = 0; j < k; ++j)
+            if (variables_[j] == variables_[k])
+                throw CalcError("Переменная указана дважды: " + variables_[k]);
+    }
+
+    Arena arena;
+    Ast ast;
+    parsing_to_ast(lexing(expr, arena), ast, variables_);
+    build(std::move(ast), options);
+}
+
+CompiledExpr::CompiledExpr(const Ast &ast, std::vector<std::string> variables, const CompileOptions &options)
+    : variables_(std::move(variables)), values_(variables_.size(), 0.0)
+{
+    build(ast, options);
+}
+
+void CompiledExpr::build(Ast ast, const CompileOptions &options)
+{
+    if (options.optimize)
+    {
+        fold_constants(ast);
+        if (options.fast_math)
+            rewrite_polynomials(ast);
+        simplify(ast, options.fast_math);
+        share_subexpressions(ast);
+    }
+    program_ = compile(ast, uint32_t(variables_.size()), options.fast_math && kHardwareFma);
+    program_.accuracy = options.accuracy;
+    if (options.use_jit)
+        jit_ = JitCode::compile(program_);
+}
+
+size_t CompiledExpr::memory_usage() const
+{
+    size_t bytes = sizeof(*this) + program_.code.capacity() * sizeof(Instr) +
+                   program_.consts.capacity() * sizeof(double) + values_.capacity() * sizeof(double);
+    for (const std::string &name : variables_)
+        bytes += sizeof(name) + name.capacity();
+    if (jit_)
+        bytes += sizeof(JitCode) + jit_->code_size();
+    return bytes;
+}
+
+int CompiledExpr::variable_index(std::string_view name) const
+{
+    for (size_t k = 0; k < variables_.size(); ++k)
+        if (variables_[k] == name)
+            return int(k);
+    return -1;
+}
+
+void CompiledExpr::bind(std::string_view name, double value)
+{
+    int k = variable_index(name);
+    if (k < 0)
+        throw CalcError("Неизвестная переменная: " + std::string(name));
+    values_[size_t(k)] = value;
+}
+
+double CompiledExpr::evaluate(const double *values) const
+{
+    double result = 0.0;
+    ErrorCode err = try_evaluate(values, result);
+    if (err != ErrorCode::OK)
+        throw CalcError(error_message(err));
+    return result;
+}
@@ -0,0 +1,75 @@
+// src/engine/compiled_expr.hpp
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "jit.hpp"
+#include "vm.hpp"
+
+// Значение CompileOptions::use_jit по умолчанию для всего процесса
+// (параметр --jit). Задаётся при старте, до компиляции выражений: им
+// пользуются try_eval_func, серверы и другие места, где выражение
+// компилируется с параметрами по умолчанию.
+void set_default_jit(bool enabled);
+bool default_jit();
+
+struct CompileOptions
+{
+    // Использовать JIT, если он собран; иначе молча остаётся VM
+    bool use_jit = default_jit();
+    // Точность функций при пакетном вычислении; скалярное вычисление
+    // всегда использует libm
+    Accuracy accuracy = Accuracy::STRICT;
+    // Проходы optimize.hpp перед компиляцией; результат от них не меняется
+    bool optimize = true;
+    // Разрешает упрощения, меняющие последний знак результата: x+0 -> x,
+    // целые степени умножениями, root(x,2) -> sqrt(x), FMA при аппаратной поддержке
+    bool fast_math = false;
+};
+
+// Выражение, разобранное и скомпилированное один раз. Значения переменных
+// задаются через bind() или передаются массивом в evaluate(); само
+// вычисление не лексит, не разбирает и не выделяет память.
+class CompiledExpr
+{
+public:
+    explicit CompiledExpr(const std::string &expr, std::vector<std::string> variables = {},
+                          const CompileOptions &options = {});
+    // Из уже разобранного дерева; имена переменных не проверяются, их
+    // индексы в ast должны соответствовать variables
+    explicit CompiledExpr(const Ast &ast, std::vector<std::string> variables = {},
+                          const CompileOptions &options = {});
+
+    const std::vector<std::string> &variables() const { return variables_; }
+    // -1, если переменной с таким именем нет
+    int variable_index(std::string_view name) const;
+
+    void bind(size_t index, double value) { values_[index] = value; }
+    void bind(std::string_view name, double value);
+
+    // Вычисление с привязанными значениями; бросает CalcError
+    double evaluate() const { return evaluate(values_.data()); }
+    // values — по одному значению на переменную, в порядке variables()
+    double evaluate(const double *values) const;
+    // То же без исключений: ошибка области определения возвращается кодом
+    ErrorCode try_evaluate(const double *values, double &result) const
+    {
+        return jit_ ? jit_->run(values, result) : ::run(program_, values, result);
+    }
+
+    const Program &program() const { return program_; }
+    bool jitted() const { return jit_ != nullptr; }
+    // Примерный объём памяти объекта в байтах (для бюджета кэша)
+    size_t memory_usage() const;
+
+private:
+    void build(Ast ast, const CompileOptions &options);
+
+    std::vector<std::string> variables_;
+    std::vector<double> values_;
+    Program program_;
+    std::unique_ptr<JitCode> jit_;
+};
@@ -0,0 +1,116 @@
+// src/engine/dispatch.cpp
+#include "dispatch.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define FAST_CALC_CPUID 1
+#endif
+
+namespace
+{
+    constexpr std::string_view kNames[] = {"scalar", "sse2", "avx2", "avx512"};
+    static_assert(sizeof(kNames) / sizeof(kNames[0]) == size_t(SimdLevel::COUNT), "kNames не соответствует SimdLevel");
+
+#ifdef FAST_CALC_CPUID
+    // Регистры, сохранение которых ОС включила в XCR0
+    uint64_t xgetbv0()
+    {
+        uint32_t lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return (uint64_t(hi) << 32) | lo;
+    }
+
+    SimdLevel cpu_level()
+    {
+        unsigned a, b, c, d;
+        if (!__get_cpuid(1, &a, &b, &c, &d) || !(d & bit_SSE2))
+            return SimdLevel::SCALAR;
+        bool fma = c & bit_FMA;
+        // без OSXSAVE регистры ymm/zmm не сохраняются при переключении потоков
+        if (!(c & bit_OSXSAVE) || !(c & bit_AVX))
+            return SimdLevel::SSE2;
+        uint64_t xcr0 = xgetbv0();
+        const uint64_t kYmm = 0x6;   // состояние SSE и AVX
+        const uint64_t kZmm = 0xE6;  // и ещё opmask, старшие половины zmm0-15, zmm16-31
+        if ((xcr0 & kYmm) != kYmm || !__get_cpuid_count(7, 0, &a, &b, &c, &d))
+            return SimdLevel::SSE2;
+        if (!(b & bit_AVX2) || !fma)
+            return SimdLevel::SSE2;
+        if ((b & bit_AVX512F) && (xcr0 & kZmm) == kZmm)
+            return SimdLevel::AVX512;
+        return SimdLevel::AVX2;
+    }
+#else
+    SimdLevel cpu_level() { return SimdLevel::SCALAR; }
+#endif
+
+    // Самый высокий собранный уровень, не выше want
+    SimdLevel best_built(SimdLevel want)
+    {
+        for (int l = int(want); l > 0; --l)
+            if (kernels_for_level(SimdLevel(l)))
+                return SimdLevel(l);
+        return SimdLevel::SCALAR;
+    }
+
+    // -1 — уровень ещё не выбран
+    std::atomic<int> g_active{-1};
+} // namespace
+
+std::string_view simd_level_name(SimdLevel level) { return kNames[size_t(level)]; }
+
+bool parse_simd_level(std::string_view name, SimdLevel &out)
+{
+    for (size_t k = 0; k < size_t(SimdLevel::COUNT); ++k)
+        if (kNames[k] == name)
+        {
+            out = SimdLevel(k);
+            return true;
+        }
+    return false;
+}
+
+const KernelSet *kernels_for_level(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::SSE2:
+        return sse2_kernels();
+    case SimdLevel::AVX2:
+        return avx2_kernels();
+    case SimdLevel::AVX512:
+        return avx512_kernels();
+    default:
+        return &strict_kernels();
+    }
+}
+
+SimdLevel detected_simd_level()
+{
+    static const SimdLevel detected = best_built(cpu_level());
+    return detected;
+}
+
+SimdLevel active_simd_level()
+{
+    int level = g_active.load(std::memory_order_acquire);
+    if (level < 0)
+    {
+        int expected = -1;
+        g_active.compare_exchange_strong(expected, int(detected_simd_level()), std::memory_order_acq_rel);
+        level = g_active.load(std::memory_order_acquire);
+    }
+    return SimdLevel(level);
+}
+
+SimdLevel limit_simd_level(SimdLevel max)
+{
+    SimdLevel level = best_built(std::min(max, detected_simd_level()));
+    g_active.store(int(level), std::memory_order_release);
+    return level;
+}
+
+const KernelSet &fast_kernels() { return *kernels_for_level(active_simd_level()); }
@@ -0,0 +1,38 @@
+// src/engine/dispatch.hpp
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "simd.hpp"
+
+// Уровни векторных ядер по возрастанию. Один и тот же бинарник содержит
+// ядра всех уровней, а используемый выбирается при первом обращении
+// по cpuid и поддержке регистров операционной системой (xgetbv).
+enum class SimdLevel : uint8_t
+{
+    SCALAR, // без векторных ядер: быстрый уровень точности считает через libm
+    SSE2,
+    AVX2,   // AVX2 + FMA
+    AVX512, // AVX-512F
+    COUNT
+};
+
+std::string_view simd_level_name(SimdLevel level);
+// Имя из simd_level_name; false для неизвестного имени
+bool parse_simd_level(std::string_view name, SimdLevel &out);
+
+// Ядра уровня; nullptr, если уровень не собран в этом бинарнике
+const KernelSet *kernels_for_level(SimdLevel level);
+
+// Лучший уровень, который поддерживают процессор, ОС и эта сборка
+SimdLevel detected_simd_level();
+
+// Уровень, ядра которого сейчас возвращает fast_kernels()
+SimdLevel active_simd_level();
+
+// Ограничивает активный уровень сверху, например для A/B-замеров.
+// Уровень выше обнаруженного не включается никогда. Возвращает новый
+// активный уровень. Вызывается при старте, до создания BatchEvaluator:
+// уже созданные вычислители продолжают пользоваться прежними ядрами.
+SimdLevel limit_simd_level(SimdLevel max);
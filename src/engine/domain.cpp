@@ -0,0 +1,30 @@
+// src/engine/domain.cpp
+#include "domain.hpp"
+
+static const char *const kMessages[] = {
+    "",
+    "Деление на ноль",
+    "0^0 не определено",
+    "Аргумент факториала некорректен",
+    "Факториал определён только для неотрицательных значений",
+    "Факториал допустим только для целых значений",
+    "Слишком большое значение для факториала",
+    "Значение tan имеет полюс при данном аргументе",
+    "Аргумент asin вне диапазона [-1,1]",
+    "Аргумент acos вне диапазона [-1,1]",
+    "Корень из отрицательного числа не определён",
+    "Натуральный логарифм определён только для положительных значений",
+    "Десятичный логарифм определён только для положительных значений",
+    "Степень корня не может быть нулём",
+    "Чётный корень из отрицательного числа не определён",
+    "Логарифм определён только для положительных значений",
+    "Основание логарифма должно быть положительным и не равно 1",
+};
+static_assert(sizeof(kMessages) / sizeof(kMessages[0]) == size_t(ErrorCode::COUNT), "таблица сообщений не соответствует ErrorCode");
+
+const char *error_message(ErrorCode code)
+{
+    if (code >= ErrorCode::COUNT)
+        return "Неизвестная ошибка";
+    return kMessages[size_t(code)];
+}
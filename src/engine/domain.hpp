@@ -0,0 +1,107 @@
+// src/engine/domain.hpp
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Коды ошибок области определения. Все исполнители (обход дерева,
+// байткод, пакетный режим) сообщают об ошибках через эти коды, а текст
+// сообщения строится по коду только при необходимости.
+enum class ErrorCode : uint8_t
+{
+    OK = 0,
+    DIV_ZERO,
+    ZERO_POW_ZERO,
+    FACT_INVALID,
+    FACT_NEGATIVE,
+    FACT_NON_INTEGER,
+    FACT_TOO_LARGE,
+    TAN_POLE,
+    ASIN_RANGE,
+    ACOS_RANGE,
+    SQRT_NEGATIVE,
+    LN_DOMAIN,
+    LG_DOMAIN,
+    ROOT_ZERO_DEGREE,
+    ROOT_EVEN_NEGATIVE,
+    LOG_DOMAIN,
+    LOG_BASE,
+    COUNT
+};
+
+const char *error_message(ErrorCode code);
+
+// Вид проверки области определения перед операцией
+enum class CheckKind : uint8_t
+{
+    DIV,  // a / b
+    POW,  // a ^ b
+    FACT, // x!
+    TAN,
+    ASIN,
+    ACOS,
+    SQRT,
+    LN,
+    LG,
+    ROOT, // root(x, n)
+    LOG,  // log(x, base)
+    COUNT
+};
+
+// Проверка принимает операнды в порядке вычисления; для одноместных
+// проверок используется только a.
+inline ErrorCode check_domain(CheckKind kind, double a, double b = 0.0)
+{
+    switch (kind)
+    {
+    case CheckKind::DIV:
+        return b == 0.0 ? ErrorCode::DIV_ZERO : ErrorCode::OK;
+    case CheckKind::POW:
+        return (a == 0.0 && b == 0.0) ? ErrorCode::ZERO_POW_ZERO : ErrorCode::OK;
+    case CheckKind::FACT:
+    {
+        if (std::isnan(a) || std::isinf(a))
+            return ErrorCode::FACT_INVALID;
+        if (a < 0)
+            return ErrorCode::FACT_NEGATIVE;
+        double ix = std::round(a);
+        if (std::fabs(ix - a) > 1e-12)
+            return ErrorCode::FACT_NON_INTEGER;
+        if (ix > 170.0)
+            return ErrorCode::FACT_TOO_LARGE;
+        return ErrorCode::OK;
+    }
+    case CheckKind::TAN:
+        return std::fabs(std::cos(a)) < 1e-16 ? ErrorCode::TAN_POLE : ErrorCode::OK;
+    case CheckKind::ASIN:
+        return (a < -1.0 || a > 1.0) ? ErrorCode::ASIN_RANGE : ErrorCode::OK;
+    case CheckKind::ACOS:
+        return (a < -1.0 || a > 1.0) ? ErrorCode::ACOS_RANGE : ErrorCode::OK;
+    case CheckKind::SQRT:
+        return a < 0 ? ErrorCode::SQRT_NEGATIVE : ErrorCode::OK;
+    case CheckKind::LN:
+        return a <= 0 ? ErrorCode::LN_DOMAIN : ErrorCode::OK;
+    case CheckKind::LG:
+        return a <= 0 ? ErrorCode::LG_DOMAIN : ErrorCode::OK;
+    case CheckKind::ROOT:
+        if (b == 0.0)
+            return ErrorCode::ROOT_ZERO_DEGREE;
+        if (a < 0 && std::fmod(b, 2.0) == 0.0)
+            return ErrorCode::ROOT_EVEN_NEGATIVE;
+        return ErrorCode::OK;
+    case CheckKind::LOG:
+        if (a <= 0)
+            return ErrorCode::LOG_DOMAIN;
+        if (b <= 0 || b == 1.0)
+            return ErrorCode::LOG_BASE;
+        return ErrorCode::OK;
+    default:
+        return ErrorCode::OK;
+    }
+}
+
+// Число операндов, которые проверка читает с вершины стека
+inline int check_arity(CheckKind kind)
+{
+    return (kind == CheckKind::DIV || kind == CheckKind::POW || kind == CheckKind::ROOT || kind == CheckKind::LOG) ? 2 : 1;
+}
@@ -0,0 +1,145 @@
+// src/engine/expr_cache.cpp
+#include "expr_cache.hpp"
+
+#include <cctype>
+#include <functional>
+
+namespace
+{
+    // Служебная память записи кроме самого выражения: узлы списка и таблицы
+    constexpr size_t kEntryOverhead = 96;
+
+    // По биту на каждое поле CompileOptions
+    char options_tag(const CompileOptions &options)
+    {
+        return char((options.use_jit ? 1 : 0) | (options.accuracy == Accuracy::FAST ? 2 : 0) |
+                    (options.optimize ? 4 : 0) | (options.fast_math ? 8 : 0));
+    }
+
+    std::string normalize(std::string_view expr, const std::vector<std::string> &variables,
+                          const CompileOptions &options)
+    {
+        std::string key;
+        key.reserve(expr.size() + 1);
+        key += options_tag(options);
+        for (char c : expr)
+            if (!isspace((unsigned char)c))
+                key += c;
+        for (const std::string &name : variables)
+        {
+            key += '\0';
+            key += name;
+        }
+        return key;
+    }
+} // namespace
+
+ExprCache::ExprCache(size_t budget_bytes, size_t shards)
+    : shards_(shards ? shards : 1), budget_(budget_bytes)
+{
+}
+
+ExprCache::Shard &ExprCache::shard_for(std::string_view key)
+{
+    return shards_[std::hash<std::string_view>()(key) % shards_.size()];
+}
+
+std::shared_ptr<const CompiledExpr> ExprCache::find(std::string_view key)
+{
+    Shard &shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end())
+    {
+        ++shard.misses;
+        return nullptr;
+    }
+    ++shard.hits;
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    return it->second->expr;
+}
+
+void ExprCache::insert(std::string_view key, std::shared_ptr<const CompiledExpr> expr)
+{
+    size_t bytes = key.size() + kEntryOverhead + expr->memory_usage();
+    Shard &shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end())
+    {
+        auto node = it->second;
+        shard.bytes -= node->bytes;
+        shard.index.erase(it);
+        shard.lru.erase(node);
+    }
+    shard.lru.push_front(Entry{std::string(key), std::move(expr), bytes});
+    shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+    shard.bytes += bytes;
+    evict(shard, shard_budget());
+}
+
+std::shared_ptr<const CompiledExpr> ExprCache::get(std::string_view expr, const std::vector<std::string> &variables,
+                                                   const CompileOptions &options)
+{
+    std::string key = normalize(expr, variables, options);
+    if (auto hit = find(key))
+        return hit;
+    auto compiled = std::make_shared<const CompiledExpr>(std::string(expr), variables, options);
+    insert(key, compiled);
+    return compiled;
+}
+
+void ExprCache::evict(Shard &shard, size_t limit)
+{
+    // Запись больше доли бюджета всё равно не хранится: она вытесняется сразу
+    while (shard.bytes > limit && !shard.lru.empty())
+    {
+        Entry &victim = shard.lru.back();
+        shard.bytes -= victim.bytes;
+        shard.index.erase(victim.key);
+        shard.lru.pop_back();
+        ++shard.evictions;
+    }
+}
+
+void ExprCache::set_budget(size_t budget_bytes)
+{
+    budget_.store(budget_bytes, std::memory_order_relaxed);
+    for (Shard &shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        evict(shard, shard_budget());
+    }
+}
+
+void ExprCache::clear()
+{
+    for (Shard &shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.index.clear();
+        shard.lru.clear();
+        shard.bytes = 0;
+    }
+}
+
+ExprCacheStats ExprCache::stats() const
+{
+    ExprCacheStats total;
+    for (const Shard &shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total.hits += shard.hits;
+        total.misses += shard.misses;
+        total.evictions += shard.evictions;
+        total.entries += shard.lru.size();
+        total.bytes += shard.bytes;
+    }
+    return total;
+}
+
+ExprCache &expr_cache()
+{
+    static ExprCache cache;
+    return cache;
+}
@@ -0,0 +1,90 @@
+// src/engine/expr_cache.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "compiled_expr.hpp"
+
+struct ExprCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0; // оценка памяти записей вместе с ключами
+};
+
+// Кэш скомпилированных выражений с вытеснением давно не использованных (LRU).
+// Ключ — байт-метка и нормализованный текст выражения (без пробелов, как у
+// removing_spaces); выражения с переменными добавляют к нему имена через '\0'.
+// Метка у get() кодирует CompileOptions, поэтому JIT, FAST и fast-math
+// программы не достаются тем, кто просил строгое вычисление; записи
+// try_eval_func помечены отдельной меткой kEvalTag.
+// Записи разбиты на сегменты по хэшу ключа, у каждого свой мьютекс, список
+// LRU и доля бюджета памяти, поэтому потоки с разными выражениями почти не
+// конкурируют. Выражение отдаётся как shared_ptr: вытеснение не делает
+// недействительным то, что уже вычисляется в другом потоке.
+class ExprCache
+{
+public:
+    explicit ExprCache(size_t budget_bytes = kDefaultBudget, size_t shards = 16);
+    ExprCache(const ExprCache &) = delete;
+    ExprCache &operator=(const ExprCache &) = delete;
+
+    static constexpr size_t kDefaultBudget = size_t(8) << 20;
+    // Метка ключей try_eval_func; метки get() не больше 0x0f
+    static constexpr char kEvalTag = char(0x80);
+
+    // nullptr при промахе; попадание переносит запись в начало LRU
+    std::shared_ptr<const CompiledExpr> find(std::string_view key);
+    // Запись для уже существующего ключа заменяется
+    void insert(std::string_view key, std::shared_ptr<const CompiledExpr> expr);
+
+    // Нормализует expr, при промахе компилирует (бросает CalcError) и кэширует
+    std::shared_ptr<const CompiledExpr> get(std::string_view expr, const std::vector<std::string> &variables = {},
+                                            const CompileOptions &options = {});
+
+    // Новый бюджет; лишние записи вытесняются сразу
+    void set_budget(size_t budget_bytes);
+    size_t budget() const { return budget_.load(std::memory_order_relaxed); }
+    void clear();
+    ExprCacheStats stats() const;
+
+private:
+    struct Entry
+    {
+        std::string key;
+        std::shared_ptr<const CompiledExpr> expr;
+        size_t bytes;
+    };
+
+    struct alignas(64) Shard
+    {
+        mutable std::mutex mutex;
+        std::list<Entry> lru; // начало — последнее использование
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> index; // ключи указывают в lru
+        size_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    Shard &shard_for(std::string_view key);
+    void evict(Shard &shard, size_t limit);
+    size_t shard_budget() const { return budget() / shards_.size(); }
+
+    std::vector<Shard> shards_;
+    std::atomic<size_t> budget_;
+};
+
+// Кэш, через который try_eval_func и eval_func переиспользуют разобранные выражения
+ExprCache &expr_cache();
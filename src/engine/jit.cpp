@@ -0,0 +1,490 @@
+// src/engine/jit.cpp
+#include "jit.hpp"
+
+#if defined(FAST_CALC_JIT) && defined(__x86_64__) && defined(__linux__)
+#define FAST_CALC_JIT_ENABLED 1
+#endif
+
+#ifdef FAST_CALC_JIT_ENABLED
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include <sys/mman.h>
+
+#include "vm.hpp"
+
+namespace
+{
+    // Слот i стека VM хранится в xmm(kFirstSlotReg + i); xmm0/xmm1 — рабочие
+    // регистры и регистры аргументов при вызовах.
+    constexpr int kFirstSlotReg = 2;
+    constexpr uint32_t kMaxSlots = 16 - kFirstSlotReg;
+    // Кадр: область сброса регистров перед вызовами, за ней временные
+    // ячейки STORE/FETCH; вместе с двумя push rsp остаётся выровненным на 16
+    uint32_t frame_size(uint32_t temps)
+    {
+        return (kMaxSlots + (temps + 1) / 2 * 2) * 8 + 8;
+    }
+
+    // Условия для Jcc
+    enum Cond : uint8_t
+    {
+        CC_B = 0x2,
+        CC_NE = 0x5,
+        CC_BE = 0x6,
+        CC_P = 0xA,
+    };
+
+    uint32_t jit_check(double a, double b, uint32_t kind)
+    {
+        return uint32_t(check_domain(CheckKind(kind), a, b));
+    }
+
+    double jit_fact(double x)
+    {
+        return std::tgamma(std::round(x) + 1.0);
+    }
+
+    double jit_fma(double a, double b, double c)
+    {
+        return std::fma(a, b, c);
+    }
+
+    uint64_t bits_of(double v)
+    {
+        uint64_t u;
+        std::memcpy(&u, &v, sizeof(u));
+        return u;
+    }
+
+    class Emitter
+    {
+    public:
+        std::vector<uint8_t> code;
+
+        void byte(uint8_t b) { code.push_back(b); }
+        void u32(uint32_t v)
+        {
+            for (int k = 0; k < 4; ++k)
+                byte(uint8_t(v >> (8 * k)));
+        }
+        void u64(uint64_t v)
+        {
+            for (int k = 0; k < 8; ++k)
+                byte(uint8_t(v >> (8 * k)));
+        }
+
+        // prefix [REX] 0F op modrm(11, dst, src)
+        void sse_rr(uint8_t prefix, uint8_t op, int dst, int src)
+        {
+            byte(prefix);
+            uint8_t rex = uint8_t(0x40 | ((dst & 8) ? 4 : 0) | ((src & 8) ? 1 : 0));
+            if (rex != 0x40)
+                byte(rex);
+            byte(0x0F);
+            byte(op);
+            byte(uint8_t(0xC0 | ((dst & 7) << 3) | (src & 7)));
+        }
+
+        // prefix [REX] 0F op modrm(10, reg, base) sib disp32; base — rsp или r12
+        void sse_mem(uint8_t prefix, uint8_t op, int reg, bool base_r12, uint32_t disp)
+        {
+            byte(prefix);
+            uint8_t rex = uint8_t(0x40 | ((reg & 8) ? 4 : 0) | (base_r12 ? 1 : 0));
+            if (rex != 0x40)
+                byte(rex);
+            byte(0x0F);
+            byte(op);
+            byte(uint8_t(0x84 | ((reg & 7) << 3)));
+            byte(0x24);
+            u32(disp);
+        }
+
+        void movsd_load(int reg, uint32_t disp) { sse_mem(0xF2, 0x10, reg, false, disp); }
+        void movsd_store(int reg, uint32_t disp) { sse_mem(0xF2, 0x11, reg, false, disp); }
+        void movsd_load_var(int reg, uint32_t index) { sse_mem(0xF2, 0x10, reg, true, index * 8); }
+        void movapd(int dst, int src) { sse_rr(0x66, 0x28, dst, src); }
+        void xorpd(int dst, int src) { sse_rr(0x66, 0x57, dst, src); }
+        void andpd(int dst, int src) { sse_rr(0x66, 0x54, dst, src); }
+        void ucomisd(int a, int b) { sse_rr(0x66, 0x2E, a, b); }
+
+        void mov_rax_imm64(uint64_t v)
+        {
+            byte(0x48);
+            byte(0xB8);
+            u64(v);
+        }
+
+        // movq xmm, rax
+        void movq_xmm_rax(int reg)
+        {
+            byte(0x66);
+            byte(uint8_t(0x48 | ((reg & 8) ? 4 : 0)));
+            byte(0x0F);
+            byte(0x6E);
+            byte(uint8_t(0xC0 | ((reg & 7) << 3)));
+        }
+
+        void load_double(int reg, double v)
+        {
+            mov_rax_imm64(bits_of(v));
+            movq_xmm_rax(reg);
+        }
+
+        void call_abs(const void *fn)
+        {
+            mov_rax_imm64(reinterpret_cast<uint64_t>(fn));
+            byte(0xFF); // call rax
+            byte(0xD0);
+        }
+
+        void mov_edi_imm32(uint32_t v)
+        {
+            byte(0xBF);
+            u32(v);
+        }
+        void mov_eax_imm32(uint32_t v)
+        {
+            byte(0xB8);
+            u32(v);
+        }
+
+        // Переход с 32-битным смещением; возвращает позицию смещения для исправления
+        size_t jcc32(Cond cc)
+        {
+            byte(0x0F);
+            byte(uint8_t(0x80 | cc));
+            u32(0);
+            return code.size() - 4;
+        }
+        size_t jmp32()
+        {
+            byte(0xE9);
+            u32(0);
+            return code.size() - 4;
+        }
+        // Короткий переход вперёд; цель задаётся позже через bind8
+        size_t jcc8(Cond cc)
+        {
+            byte(uint8_t(0x70 | cc));
+            byte(0);
+            return code.size() - 1;
+        }
+        void bind8(size_t at) { code[at] = uint8_t(code.size() - (at + 1)); }
+
+        void patch(size_t at, size_t target)
+        {
+            int32_t rel = int32_t(int64_t(target) - int64_t(at + 4));
+            std::memcpy(&code[at], &rel, sizeof(rel));
+        }
+    };
+
+    class Translator
+    {
+    public:
+        explicit Translator(const Program &p) : p_(p), frame_(frame_size(p.temps)) {}
+
+        bool translate()
+        {
+            // push rbx; push r12; mov rbx, rsi (err); mov r12, rdi (vars); sub rsp, frame_
+            e_.byte(0x53);
+            e_.byte(0x41);
+            e_.byte(0x54);
+            e_.byte(0x48);
+            e_.byte(0x89);
+            e_.byte(0xF3);
+            e_.byte(0x49);
+            e_.byte(0x89);
+            e_.byte(0xFC);
+            e_.byte(0x48);
+            e_.byte(0x81);
+            e_.byte(0xEC);
+            e_.u32(frame_);
+
+            for (const Instr &in : p_.code)
+            {
+                if (!instr(in))
+                    return false;
+            }
+
+            // ошибка: код уже в eax -> *err = eax, результат 0.0
+            size_t err_exit = e_.code.size();
+            e_.byte(0x89); // mov [rbx], eax
+            e_.byte(0x03);
+            e_.xorpd(0, 0);
+            epilogue();
+            for (size_t at : err_fixups_)
+                e_.patch(at, err_exit);
+            return true;
+        }
+
+        const std::vector<uint8_t> &code() const { return e_.code; }
+
+    private:
+        static int slot(uint32_t i) { return kFirstSlotReg + int(i); }
+        static uint32_t temp_disp(uint32_t t) { return (kMaxSlots + t) * 8; }
+
+        void epilogue()
+        {
+            e_.byte(0x48); // add rsp, frame_
+            e_.byte(0x81);
+            e_.byte(0xC4);
+            e_.u32(frame_);
+            e_.byte(0x41); // pop r12
+            e_.byte(0x5C);
+            e_.byte(0x5B); // pop rbx
+            e_.byte(0xC3); // ret
+        }
+
+        // Сохраняет/восстанавливает слоты [0, live) вокруг вызова функции
+        void spill(uint32_t live)
+        {
+            for (uint32_t i = 0; i < live; ++i)
+                e_.movsd_store(slot(i), i * 8);
+        }
+        void reload(uint32_t live)
+        {
+            for (uint32_t i = 0; i < live; ++i)
+                e_.movsd_load(slot(i), i * 8);
+        }
+
+        // Вызов double fn(double[, double[, double]]): аргументы — верхние argc
+        // слотов, результат заменяет их. Третий аргумент идёт в xmm2 = slot(0),
+        // но к этому моменту slot(base) уже скопирован в xmm0, а нижние слоты сброшены
+        void call_math(const void *fn, int argc)
+        {
+            uint32_t base = depth_ - uint32_t(argc);
+            spill(base);
+            e_.movapd(0, slot(base));
+            if (argc >= 2)
+                e_.movapd(1, slot(base + 1));
+            if (argc == 3)
+                e_.movapd(2, slot(base + 2));
+            e_.call_abs(fn);
+            e_.movapd(slot(base), 0);
+            reload(base);
+            depth_ = base + 1;
+        }
+
+        void fail(ErrorCode code)
+        {
+            e_.mov_eax_imm32(uint32_t(code));
+            err_fixups_.push_back(e_.jmp32());
+        }
+
+        void check(CheckKind kind)
+        {
+            int top = slot(depth_ - 1);
+            switch (kind)
+            {
+            case CheckKind::DIV: // b == 0.0
+            {
+                e_.xorpd(0, 0);
+                e_.ucomisd(top, 0);
+                size_t nan = e_.jcc8(CC_P);
+                size_t ne = e_.jcc8(CC_NE);
+                fail(ErrorCode::DIV_ZERO);
+                e_.bind8(nan);
+                e_.bind8(ne);
+                return;
+            }
+            case CheckKind::POW: // a == 0.0 && b == 0.0
+            {
+                e_.xorpd(0, 0);
+                e_.ucomisd(slot(depth_ - 2), 0);
+                size_t a_nan = e_.jcc8(CC_P);
+                size_t a_ne = e_.jcc8(CC_NE);
+                e_.ucomisd(top, 0);
+                size_t b_nan = e_.jcc8(CC_P);
+                size_t b_ne = e_.jcc8(CC_NE);
+                fail(ErrorCode::ZERO_POW_ZERO);
+                for (size_t at : {a_nan, a_ne, b_nan, b_ne})
+                    e_.bind8(at);
+                return;
+            }
+            case CheckKind::SQRT: // x < 0
+            {
+                e_.xorpd(0, 0);
+                e_.ucomisd(0, top);
+                size_t ok = e_.jcc8(CC_BE);
+                fail(ErrorCode::SQRT_NEGATIVE);
+                e_.bind8(ok);
+                return;
+            }
+            case CheckKind::LN: // x <= 0
+            case CheckKind::LG:
+            {
+                e_.xorpd(0, 0);
+                e_.ucomisd(0, top);
+                size_t ok = e_.jcc8(CC_B);
+                fail(kind == CheckKind::LN ? ErrorCode::LN_DOMAIN : ErrorCode::LG_DOMAIN);
+                e_.bind8(ok);
+                return;
+            }
+            case CheckKind::ASIN: // x < -1 || x > 1
+            case CheckKind::ACOS:
+            {
+                ErrorCode code = kind == CheckKind::ASIN ? ErrorCode::ASIN_RANGE : ErrorCode::ACOS_RANGE;
+                e_.load_double(0, -1.0);
+                e_.ucomisd(0, top);
+                size_t lo_ok = e_.jcc8(CC_BE);
+                fail(code);
+                e_.bind8(lo_ok);
+                e_.load_double(0, 1.0);
+                e_.ucomisd(top, 0);
+                size_t hi_ok = e_.jcc8(CC_BE);
+                fail(code);
+                e_.bind8(hi_ok);
+                return;
+            }
+            default:
+            {
+                // редкие и сложные проверки — через общий check_domain
+                int arity = check_arity(kind);
+                spill(depth_);
+                e_.movapd(0, arity == 2 ? slot(depth_ - 2) : top);
+                if (arity == 2)
+                    e_.movapd(1, top);
+                e_.mov_edi_imm32(uint32_t(kind));
+                e_.call_abs(reinterpret_cast<const void *>(&jit_check));
+                reload(depth_);
+                e_.byte(0x85); // test eax, eax
+                e_.byte(0xC0);
+                err_fixups_.push_back(e_.jcc32(CC_NE));
+                return;
+            }
+            }
+        }
+
+        bool instr(const Instr &in)
+        {
+            switch (in.op)
+            {
+            case OpCode::PUSH:
+                e_.load_double(slot(depth_), p_.consts[in.operand]);
+                ++depth_;
+                return true;
+            case OpCode::LOAD:
+                e_.movsd_load_var(slot(depth_), in.operand);
+                ++depth_;
+                return true;
+            case OpCode::NEG:
+                e_.mov_rax_imm64(0x8000000000000000ull);
+                e_.movq_xmm_rax(0);
+                e_.xorpd(slot(depth_ - 1), 0);
+                return true;
+            case OpCode::FACT:
+                call_math(reinterpret_cast<const void *>(&jit_fact), 1);
+                return true;
+            case OpCode::ADD:
+                e_.sse_rr(0xF2, 0x58, slot(depth_ - 2), slot(depth_ - 1));
+                --depth_;
+                return true;
+            case OpCode::SUB:
+                e_.sse_rr(0xF2, 0x5C, slot(depth_ - 2), slot(depth_ - 1));
+                --depth_;
+                return true;
+            case OpCode::MUL:
+                e_.sse_rr(0xF2, 0x59, slot(depth_ - 2), slot(depth_ - 1));
+                --depth_;
+                return true;
+            case OpCode::DIV:
+                e_.sse_rr(0xF2, 0x5E, slot(depth_ - 2), slot(depth_ - 1));
+                --depth_;
+                return true;
+            case OpCode::POW:
+                call_math(reinterpret_cast<const void *>(math_fn2(FuncId::POW)), 2);
+                return true;
+            case OpCode::FMA:
+                call_math(reinterpret_cast<const void *>(&jit_fma), 3);
+                return true;
+            case OpCode::CALL1:
+            {
+                FuncId f = FuncId(in.arg);
+                int top = slot(depth_ - 1);
+                if (f == FuncId::SQRT)
+                    e_.sse_rr(0xF2, 0x51, top, top);
+                else if (f == FuncId::ABS)
+                {
+                    e_.mov_rax_imm64(0x7FFFFFFFFFFFFFFFull);
+                    e_.movq_xmm_rax(0);
+                    e_.andpd(top, 0);
+                }
+                else
+                    call_math(reinterpret_cast<const void *>(math_fn1(f)), 1);
+                return true;
+            }
+            case OpCode::CALL2:
+                call_math(reinterpret_cast<const void *>(math_fn2(FuncId(in.arg))), 2);
+                return true;
+            case OpCode::CHECK:
+                check(CheckKind(in.arg));
+                return true;
+            case OpCode::STORE:
+                e_.movsd_store(slot(depth_ - 1), temp_disp(in.operand));
+                return true;
+            case OpCode::FETCH:
+                e_.movsd_load(slot(depth_), temp_disp(in.operand));
+                ++depth_;
+                return true;
+            case OpCode::RET:
+                e_.movapd(0, slot(0));
+                epilogue();
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        const Program &p_;
+        uint32_t frame_;
+        Emitter e_;
+        uint32_t depth_ = 0;
+        std::vector<size_t> err_fixups_;
+    };
+} // namespace
+
+std::unique_ptr<JitCode> JitCode::compile(const Program &program)
+{
+    if (program.max_stack > kMaxSlots)
+        return nullptr;
+
+    Translator t(program);
+    if (!t.translate())
+        return nullptr;
+
+    const std::vector<uint8_t> &code = t.code();
+    void *mem = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+        return nullptr;
+    std::memcpy(mem, code.data(), code.size());
+    // W^X: после записи страницы становятся только исполняемыми
+    if (mprotect(mem, code.size(), PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(mem, code.size());
+        return nullptr;
+    }
+    return std::unique_ptr<JitCode>(new JitCode(mem, code.size()));
+}
+
+JitCode::~JitCode()
+{
+    munmap(mem_, size_);
+}
+
+bool jit_available() { return true; }
+
+#else
+
+std::unique_ptr<JitCode> JitCode::compile(const Program &)
+{
+    return nullptr;
+}
+
+JitCode::~JitCode() {}
+
+bool jit_available() { return false; }
+
+#endif
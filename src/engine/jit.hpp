@@ -0,0 +1,46 @@
+// src/engine/jit.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "bytecode.hpp"
+
+// Машинный код x86-64, полученный из Program. Значения стека VM живут
+// в регистрах xmm2..xmm15, libm вызывается только для трансцендентных
+// функций, а проверки области определения повторяют CHECK байткода.
+// Доступен при сборке с FAST_CALC_JIT на Linux x86-64.
+class JitCode
+{
+public:
+    ~JitCode();
+    JitCode(const JitCode &) = delete;
+    JitCode &operator=(const JitCode &) = delete;
+
+    // nullptr, если JIT не собран или программа ему не подходит
+    // (например, стек глубже числа доступных регистров)
+    static std::unique_ptr<JitCode> compile(const Program &program);
+
+    // vars — значения переменных программы (program.var_count штук)
+    ErrorCode run(const double *vars, double &result) const
+    {
+        uint32_t err = 0;
+        result = fn_(vars, &err);
+        return ErrorCode(err);
+    }
+
+    size_t code_size() const { return size_; }
+
+private:
+    using Fn = double (*)(const double *vars, uint32_t *err);
+
+    JitCode(void *mem, size_t size) : mem_(mem), size_(size), fn_(reinterpret_cast<Fn>(mem)) {}
+
+    void *mem_;
+    size_t size_;
+    Fn fn_;
+};
+
+// true, если в этой сборке есть JIT-бэкенд
+bool jit_available();
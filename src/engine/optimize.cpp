@@ -0,0 +1,626 @@
+// src/engine/optimize.cpp
+#include "optimize.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t kDead = UINT32_MAX;
+
+    // Оставляет узлы, достижимые из root; root становится последним
+    void compact(Ast &ast, uint32_t root)
+    {
+        std::vector<uint32_t> index(ast.nodes.size(), kDead);
+        index[root] = 0;
+        for (uint32_t i = root + 1; i-- > 0;)
+        {
+            if (index[i] == kDead)
+                continue;
+            const AstNode &n = ast.nodes[i];
+            for (uint32_t k = 0; k < kid_count(n); ++k)
+                index[n.kids[k]] = 0;
+        }
+
+        // Живые узлы сдвигаются к началу; индексы детей всегда меньше
+        // индекса родителя, поэтому новые номера детей уже известны
+        uint32_t count = 0;
+        for (uint32_t i = 0; i <= root; ++i)
+        {
+            if (index[i] == kDead)
+                continue;
+            AstNode n = ast.nodes[i];
+            for (uint32_t k = 0; k < kid_count(n); ++k)
+                n.kids[k] = index[n.kids[k]];
+            index[i] = count;
+            ast.nodes[count++] = n;
+        }
+        ast.nodes.resize(count);
+    }
+
+    // Наибольшая степень, которая раскладывается в умножения
+    constexpr double kMaxChainPower = 8.0;
+
+    // Новый массив узлов; пост-порядок сохраняется, потому что узел
+    // строится после своих детей
+    class Builder
+    {
+    public:
+        std::vector<AstNode> &nodes() { return out_; }
+
+    protected:
+        uint32_t add(const AstNode &n)
+        {
+            out_.push_back(n);
+            return uint32_t(out_.size() - 1);
+        }
+
+        uint32_t make(NodeOp op, uint32_t a, uint32_t b, uint32_t pos, uint8_t id = 0)
+        {
+            return add(AstNode{op, id, {a, b}, pos, 0.0});
+        }
+
+        uint32_t number(double v, uint32_t pos)
+        {
+            return add(AstNode{NodeOp::NUMBER, 0, {0, 0}, pos, v});
+        }
+
+        std::vector<AstNode> out_;
+    };
+
+    // Переписывает дерево в новый массив: узел заменяется либо копией с
+    // новыми индексами детей, либо уже построенным узлом, либо несколькими новыми
+    class Simplifier : public Builder
+    {
+    public:
+        Simplifier(const Ast &in, bool fast_math) : in_(in), fast_math_(fast_math)
+        {
+            out_.reserve(in.nodes.size());
+        }
+
+        uint32_t run()
+        {
+            std::vector<uint32_t> map(in_.nodes.size());
+            for (uint32_t i = 0; i < in_.nodes.size(); ++i)
+            {
+                AstNode n = in_.nodes[i];
+                for (uint32_t k = 0; k < kid_count(n); ++k)
+                    n.kids[k] = map[n.kids[k]];
+                map[i] = rewrite(n);
+            }
+            return map[in_.root()];
+        }
+
+    private:
+        // Литерал, побитово равный v (знак нуля учитывается)
+        bool is(uint32_t i, double v) const
+        {
+            const AstNode &n = out_[i];
+            return n.op == NodeOp::NUMBER && n.number == v && std::signbit(n.number) == std::signbit(v);
+        }
+
+        bool is_zero(uint32_t i) const { return out_[i].op == NodeOp::NUMBER && out_[i].number == 0.0; }
+        bool is_neg(uint32_t i) const { return out_[i].op == NodeOp::NEG; }
+        bool is_call(uint32_t i, FuncId f) const { return out_[i].op == NodeOp::CALL && FuncId(out_[i].id) == f; }
+        uint32_t inner(uint32_t i) const { return out_[i].kids[0]; }
+
+        // Целый показатель 2…kMaxChainPower для разложения в умножения
+        bool chain_power(uint32_t exponent) const
+        {
+            const AstNode &e = out_[exponent];
+            return fast_math_ && e.op == NodeOp::NUMBER && e.number >= 2.0 && e.number <= kMaxChainPower &&
+                   e.number == std::floor(e.number);
+        }
+
+        // x^n возведением в квадрат; общие множители — один узел, и основание
+        // вычисляется один раз (см. share_subexpressions)
+        uint32_t power(uint32_t x, int n, uint32_t pos)
+        {
+            if (n == 1)
+                return x;
+            if (n % 2 == 0)
+            {
+                uint32_t half = power(x, n / 2, pos);
+                return make(NodeOp::MUL, half, half, pos);
+            }
+            return make(NodeOp::MUL, power(x, n - 1, pos), x, pos);
+        }
+
+        uint32_t rewrite(const AstNode &n)
+        {
+            uint32_t a = n.kids[0], b = n.kids[1];
+            switch (n.op)
+            {
+            case NodeOp::POS:
+                return a;
+            case NodeOp::NEG:
+                if (is_neg(a))
+                    return inner(a);
+                break;
+            case NodeOp::ADD:
+                // -0 — нейтральный элемент сложения; +0 меняет знак у -0
+                if (is(b, -0.0) || (fast_math_ && is_zero(b)))
+                    return a;
+                if (is(a, -0.0) || (fast_math_ && is_zero(a)))
+                    return b;
+                if (is_neg(b))
+                    return make(NodeOp::SUB, a, inner(b), n.pos);
+                break;
+            case NodeOp::SUB:
+                if (is(b, 0.0) || (fast_math_ && is_zero(b)))
+                    return a;
+                if (is_neg(b))
+                    return make(NodeOp::ADD, a, inner(b), n.pos);
+                break;
+            case NodeOp::MUL:
+                if (is(b, 1.0))
+                    return a;
+                if (is(a, 1.0))
+                    return b;
+                if (is_neg(a) && is_neg(b))
+                    return make(NodeOp::MUL, inner(a), inner(b), n.pos);
+                break;
+            case NodeOp::DIV:
+                // проверка деления смотрит на b == 0, а -y == 0 ровно тогда, когда y == 0
+                if (is(b, 1.0))
+                    return a;
+                if (is_neg(a) && is_neg(b))
+                    return make(NodeOp::DIV, inner(a), inner(b), n.pos);
+                break;
+            case NodeOp::POW:
+                // pow(x, 1) == x для всех x, а 0^0 при показателе 1 невозможен
+                if (is(b, 1.0))
+                    return a;
+                if (chain_power(b))
+                    return power(a, int(out_[b].number), n.pos);
+                break;
+            case NodeOp::CALL:
+                switch (FuncId(n.id))
+                {
+                case FuncId::ABS:
+                    if (is_call(a, FuncId::ABS))
+                        return a;
+                    if (is_neg(a))
+                        return make(NodeOp::CALL, inner(a), 0, n.pos, uint8_t(FuncId::ABS));
+                    break;
+                case FuncId::POW:
+                    if (is(b, 1.0))
+                        return a;
+                    if (chain_power(b))
+                        return power(a, int(out_[b].number), n.pos);
+                    break;
+                case FuncId::ROOT:
+                    // root(x, 1) = pow(x, 1.0) без ошибок области определения
+                    if (is(b, 1.0))
+                        return a;
+                    if (fast_math_ && out_[b].op == NodeOp::NUMBER && out_[b].number == 2.0)
+                        return make(NodeOp::CALL, a, 0, n.pos, uint8_t(FuncId::SQRT));
+                    break;
+                default:
+                    break;
+                }
+                break;
+            default:
+                break;
+            }
+            return add(n);
+        }
+
+        const Ast &in_;
+        bool fast_math_;
+    };
+
+    constexpr int kMaxPolyDegree = 24;
+    // С этой степени многочлен считается схемой Эстрина
+    constexpr int kEstrinDegree = 8;
+
+    // Многочлен от одной переменной с коэффициентами c[0..degree]
+    struct Poly
+    {
+        bool valid = false;
+        int var = -1; // -1 — константа
+        int degree = 0;
+        double c[kMaxPolyDegree + 1];
+
+        void trim()
+        {
+            while (degree > 0 && c[degree] == 0.0)
+                --degree;
+        }
+
+        int terms() const
+        {
+            int count = 0;
+            for (int k = 0; k <= degree; ++k)
+                count += c[k] != 0.0;
+            return count;
+        }
+    };
+
+    Poly constant_poly(double v)
+    {
+        Poly p;
+        p.valid = true;
+        p.c[0] = v;
+        return p;
+    }
+
+    // Переменные двух многочленов совместимы, если совпадают или одна из них — константа
+    bool merge_var(const Poly &a, const Poly &b, Poly &out)
+    {
+        if (!a.valid || !b.valid || (a.var >= 0 && b.var >= 0 && a.var != b.var))
+            return false;
+        out.valid = true;
+        out.var = a.var >= 0 ? a.var : b.var;
+        return true;
+    }
+
+    Poly add_poly(const Poly &a, const Poly &b, double sign)
+    {
+        Poly p;
+        if (!merge_var(a, b, p))
+            return Poly{};
+        p.degree = std::max(a.degree, b.degree);
+        for (int k = 0; k <= p.degree; ++k)
+            p.c[k] = (k <= a.degree ? a.c[k] : 0.0) + sign * (k <= b.degree ? b.c[k] : 0.0);
+        p.trim();
+        return p;
+    }
+
+    Poly mul_poly(const Poly &a, const Poly &b)
+    {
+        Poly p;
+        if (!merge_var(a, b, p) || a.degree + b.degree > kMaxPolyDegree)
+            return Poly{};
+        p.degree = a.degree + b.degree;
+        for (int k = 0; k <= p.degree; ++k)
+            p.c[k] = 0.0;
+        for (int i = 0; i <= a.degree; ++i)
+            for (int j = 0; j <= b.degree; ++j)
+                p.c[i + j] += a.c[i] * b.c[j];
+        p.trim();
+        return p;
+    }
+
+    // Заменяет наибольшие поддеревья-многочлены от одной переменной — суммы
+    // одночленов c*x^k (k = 1…24), умноженных или делённых на число, — схемой
+    // Горнера, а начиная с kEstrinDegree — схемой Эстрина
+    class PolyRewriter : public Builder
+    {
+    public:
+        explicit PolyRewriter(const Ast &in) : in_(in), polys_(in.nodes.size())
+        {
+            out_.reserve(in.nodes.size());
+        }
+
+        uint32_t run()
+        {
+            size_t n = in_.nodes.size();
+            for (uint32_t i = 0; i < n; ++i)
+                polys_[i] = poly_of(in_.nodes[i]);
+
+            // Узел внутри многочлена переписывается вместе с родителем
+            std::vector<char> inner(n, 0);
+            for (uint32_t i = 0; i < n; ++i)
+                if (polys_[i].valid)
+                    for (uint32_t k = 0; k < kid_count(in_.nodes[i]); ++k)
+                        inner[in_.nodes[i].kids[k]] = 1;
+
+            std::vector<uint32_t> map(n);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const Poly &p = polys_[i];
+                if (!inner[i] && rewritable(p))
+                {
+                    map[i] = emit(p, in_.nodes[i].pos);
+                    continue;
+                }
+                if (!p.valid && is_sum(in_.nodes[i]) && merge_sum(i, map))
+                    continue;
+                AstNode node = in_.nodes[i];
+                for (uint32_t k = 0; k < kid_count(node); ++k)
+                    node.kids[k] = map[node.kids[k]];
+                map[i] = add(node);
+            }
+            return map[in_.root()];
+        }
+
+    private:
+        static constexpr uint32_t kZero = UINT32_MAX;
+
+        static bool rewritable(const Poly &p)
+        {
+            return p.valid && p.var >= 0 && p.degree >= 2 && p.terms() >= 2;
+        }
+
+        static bool is_sum(const AstNode &n) { return n.op == NodeOp::ADD || n.op == NodeOp::SUB; }
+
+        // Слагаемые цепочки сложений и вычитаний, которая сама не многочлен
+        void collect(uint32_t i, double sign, std::vector<std::pair<uint32_t, double>> &terms) const
+        {
+            const AstNode &n = in_.nodes[i];
+            if (polys_[i].valid || !is_sum(n))
+            {
+                terms.emplace_back(i, sign);
+                return;
+            }
+            collect(n.kids[0], sign, terms);
+            collect(n.kids[1], n.op == NodeOp::SUB ? -sign : sign, terms);
+        }
+
+        // В сумме вида sin(x)+3*x^2+x^3 многочленные слагаемые собираются в один
+        // многочлен, остальные прибавляются к нему в исходном порядке, так что
+        // первая ошибка области определения остаётся той же
+        bool merge_sum(uint32_t i, std::vector<uint32_t> &map)
+        {
+            std::vector<std::pair<uint32_t, double>> terms;
+            collect(i, 1.0, terms);
+            Poly sum = constant_poly(0.0);
+            int merged = 0;
+            std::vector<std::pair<uint32_t, double>> rest;
+            for (const auto &[term, sign] : terms)
+            {
+                Poly next = add_poly(sum, polys_[term], sign);
+                if (next.valid)
+                {
+                    sum = next;
+                    ++merged;
+                }
+                else
+                    rest.emplace_back(term, sign);
+            }
+            if (merged < 2 || rest.empty() || !rewritable(sum))
+                return false;
+
+            uint32_t pos = in_.nodes[i].pos;
+            uint32_t acc = emit(sum, pos);
+            for (const auto &[term, sign] : rest)
+                acc = make(sign > 0 ? NodeOp::ADD : NodeOp::SUB, acc, map[term], pos);
+            map[i] = acc;
+            return true;
+        }
+
+        Poly poly_of(const AstNode &n) const
+        {
+            auto kid = [&](int k) -> const Poly & { return polys_[n.kids[k]]; };
+            // Степень раскрывается, только если основание — сама переменная:
+            // (x-1)^8 в коэффициентах теряет все знаки около корня и остаётся
+            // целым узлом, который входит в многочлен как обычное слагаемое
+            auto power = [&]() -> Poly
+            {
+                const AstNode &base = in_.nodes[n.kids[0]];
+                const Poly &e = kid(1);
+                // показатель 0 не берётся: 0^0 — ошибка, которую нужно сохранить
+                if (base.op != NodeOp::VAR || !e.valid || e.var >= 0 || e.degree != 0)
+                    return Poly{};
+                double k = e.c[0];
+                if (k < 1.0 || k > kMaxPolyDegree || k != std::floor(k))
+                    return Poly{};
+                Poly p = constant_poly(0.0);
+                p.var = base.id;
+                p.degree = int(k);
+                for (int j = 0; j < p.degree; ++j)
+                    p.c[j] = 0.0;
+                p.c[p.degree] = 1.0;
+                return p;
+            };
+
+            switch (n.op)
+            {
+            case NodeOp::NUMBER:
+                return constant_poly(n.number);
+            case NodeOp::VAR:
+            {
+                Poly p = constant_poly(0.0);
+                p.var = n.id;
+                p.degree = 1;
+                p.c[1] = 1.0;
+                return p;
+            }
+            case NodeOp::POS:
+                return kid(0);
+            case NodeOp::NEG:
+                return add_poly(constant_poly(0.0), kid(0), -1.0);
+            case NodeOp::ADD:
+                return add_poly(kid(0), kid(1), 1.0);
+            case NodeOp::SUB:
+                return add_poly(kid(0), kid(1), -1.0);
+            case NodeOp::MUL:
+                // произведение двух многочленов раскрывается с тем же сокращением
+                // знаков, что и степень, поэтому один множитель — одночлен
+                if (kid(0).terms() > 1 && kid(1).terms() > 1)
+                    return Poly{};
+                return mul_poly(kid(0), kid(1));
+            case NodeOp::DIV:
+            {
+                // только деление на ненулевое число: проверка деления не сработает
+                const Poly &a = kid(0), &b = kid(1);
+                if (!a.valid || !b.valid || b.var >= 0 || b.degree != 0 || b.c[0] == 0.0)
+                    return Poly{};
+                Poly p = a;
+                for (int k = 0; k <= p.degree; ++k)
+                    p.c[k] /= b.c[0];
+                return p;
+            }
+            case NodeOp::POW:
+                return power();
+            case NodeOp::CALL:
+                return FuncId(n.id) == FuncId::POW ? power() : Poly{};
+            default:
+                return Poly{};
+            }
+        }
+
+        uint32_t emit(const Poly &p, uint32_t pos)
+        {
+            uint32_t x = make(NodeOp::VAR, 0, 0, pos, uint8_t(p.var));
+            return p.degree >= kEstrinDegree ? estrin(p, x, pos) : horner(p, x, pos);
+        }
+
+        // (…(c[n]*x + c[n-1])*x + …)*x + c[0]
+        uint32_t horner(const Poly &p, uint32_t x, uint32_t pos)
+        {
+            uint32_t acc = number(p.c[p.degree], pos);
+            for (int k = p.degree - 1; k >= 0; --k)
+            {
+                acc = make(NodeOp::MUL, acc, x, pos);
+                if (p.c[k] != 0.0)
+                    acc = make(NodeOp::ADD, acc, number(p.c[k], pos), pos);
+            }
+            return acc;
+        }
+
+        // Пары (c[2i] + c[2i+1]*x) складываются с весами x^2, x^4, …: глубина
+        // зависимостей — O(log n) вместо n, и умножения идут параллельно.
+        // Степени x — общие узлы
+        uint32_t estrin(const Poly &p, uint32_t x, uint32_t pos)
+        {
+            std::vector<uint32_t> terms;
+            for (int k = 0; k <= p.degree; ++k)
+                terms.push_back(p.c[k] != 0.0 ? number(p.c[k], pos) : kZero);
+            uint32_t pw = x;
+            while (terms.size() > 1)
+            {
+                std::vector<uint32_t> next;
+                for (size_t k = 0; k < terms.size(); k += 2)
+                {
+                    uint32_t lo = terms[k];
+                    uint32_t hi = k + 1 < terms.size() ? terms[k + 1] : kZero;
+                    if (hi == kZero)
+                        next.push_back(lo);
+                    else
+                    {
+                        uint32_t scaled = make(NodeOp::MUL, hi, pw, pos);
+                        next.push_back(lo == kZero ? scaled : make(NodeOp::ADD, lo, scaled, pos));
+                    }
+                }
+                terms.swap(next);
+                if (terms.size() > 1)
+                    pw = make(NodeOp::MUL, pw, pw, pos);
+            }
+            return terms[0];
+        }
+
+        const Ast &in_;
+        std::vector<Poly> polys_;
+    };
+
+    uint64_t number_bits(double v)
+    {
+        uint64_t u;
+        std::memcpy(&u, &v, sizeof(u));
+        return u;
+    }
+
+    // Ключ узла для хэш-консинга: неиспользуемые поля обнуляются
+    struct NodeKey
+    {
+        uint64_t number;
+        uint32_t kids[2];
+        NodeOp op;
+        uint8_t id;
+
+        explicit NodeKey(const AstNode &n) : number(0), kids{0, 0}, op(n.op), id(n.id)
+        {
+            if (n.op == NodeOp::NUMBER)
+                number = number_bits(n.number);
+            for (uint32_t k = 0; k < kid_count(n); ++k)
+                kids[k] = n.kids[k];
+        }
+
+        bool operator==(const NodeKey &o) const
+        {
+            return number == o.number && kids[0] == o.kids[0] && kids[1] == o.kids[1] && op == o.op && id == o.id;
+        }
+
+        size_t hash() const
+        {
+            uint64_t h = number * 0x9E3779B97F4A7C15ull;
+            h ^= (uint64_t(kids[0]) << 32 | kids[1]) + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+            h ^= (uint64_t(op) << 8 | id) + (h << 6) + (h >> 2);
+            return size_t(h ^ (h >> 29));
+        }
+    };
+} // namespace
+
+void fold_constants(Ast &ast)
+{
+    // Дети стоят раньше родителя, поэтому за один проход вперёд у каждого
+    // узла дети уже свёрнуты, насколько это возможно
+    for (AstNode &n : ast.nodes)
+    {
+        if (n.op == NodeOp::NUMBER || n.op == NodeOp::VAR)
+            continue;
+        uint32_t kids = kid_count(n);
+        bool constant = true;
+        for (uint32_t k = 0; k < kids; ++k)
+            constant &= ast.nodes[n.kids[k]].op == NodeOp::NUMBER;
+        if (!constant)
+            continue;
+
+        double a = kids > 0 ? ast.nodes[n.kids[0]].number : 0.0;
+        double b = kids > 1 ? ast.nodes[n.kids[1]].number : 0.0;
+        ErrorCode code;
+        double value = apply_node(n, a, b, code);
+        if (code != ErrorCode::OK)
+            continue;
+        n.op = NodeOp::NUMBER;
+        n.id = 0;
+        n.number = value;
+    }
+    remove_dead_nodes(ast);
+}
+
+void simplify(Ast &ast, bool fast_math)
+{
+    if (ast.nodes.empty())
+        return;
+    Simplifier simplifier(ast, fast_math);
+    uint32_t root = simplifier.run();
+    ast.nodes.swap(simplifier.nodes());
+    compact(ast, root);
+}
+
+void rewrite_polynomials(Ast &ast)
+{
+    if (ast.nodes.empty())
+        return;
+    PolyRewriter rewriter(ast);
+    uint32_t root = rewriter.run();
+    ast.nodes.swap(rewriter.nodes());
+    compact(ast, root);
+}
+
+void share_subexpressions(Ast &ast)
+{
+    if (ast.nodes.empty())
+        return;
+    // Открытая адресация: таблица хотя бы вдвое больше числа узлов; узлы
+    // обходятся по порядку, поэтому дети уже заменены своими представителями
+    size_t size = 16;
+    while (size < ast.nodes.size() * 2)
+        size *= 2;
+    std::vector<uint32_t> table(size, kDead);
+    std::vector<uint32_t> canon(ast.nodes.size());
+    for (uint32_t i = 0; i < ast.nodes.size(); ++i)
+    {
+        AstNode &n = ast.nodes[i];
+        for (uint32_t k = 0; k < kid_count(n); ++k)
+            n.kids[k] = canon[n.kids[k]];
+        NodeKey key(n);
+        size_t slot = key.hash() & (size - 1);
+        while (table[slot] != kDead && !(NodeKey(ast.nodes[table[slot]]) == key))
+            slot = (slot + 1) & (size - 1);
+        if (table[slot] == kDead)
+            table[slot] = i;
+        canon[i] = table[slot];
+    }
+    compact(ast, canon[ast.root()]);
+}
+
+void remove_dead_nodes(Ast &ast)
+{
+    if (!ast.nodes.empty())
+        compact(ast, ast.root());
+}
@@ -0,0 +1,44 @@
+// src/engine/optimize.hpp
+#pragma once
+
+#include "../AST.hpp"
+
+// Проходы оптимизации между parsing_to_ast и вычислением. Они не меняют
+// результат: значения совпадают побитово, а ошибка области определения
+// возникает в том же узле, с тем же кодом и сообщением.
+
+// Заменяет поддеревья без переменных их значениями (узлами NUMBER), считая
+// их один раз, теми же функциями, что и обход дерева. Поддерево, вычисление
+// которого даёт ошибку, остаётся как есть: ошибка возникнет при вычислении,
+// на своём месте. Узлы, ставшие недостижимыми, удаляются.
+void fold_constants(Ast &ast);
+
+// Алгебраические упрощения. Без fast_math применяются только тождества,
+// точные в IEEE 754 и не затрагивающие проверки области определения:
+// x*1, x/1, x-0, x+(-0), x^1, pow(x,1), root(x,1), --x, +x, abs(abs(x)),
+// abs(-x), x+(-y), x-(-y), (-x)*(-y), (-x)/(-y). С fast_math добавляются
+// x+0, целые степени 2…8 цепочками умножений (x^3, pow(x,4)) и root(x,2)
+// как sqrt(x): результат отличается в последнем знаке (у x+0 — знаком
+// нуля), а root(x,2) от отрицательного x сообщает ошибку sqrt.
+void simplify(Ast &ast, bool fast_math = false);
+
+// Многочлены от одной переменной — суммы одночленов c*x^k — собираются в
+// коэффициенты и вычисляются схемой Горнера, а от 8-й степени — схемой
+// Эстрина, в которой умножения независимы. Произведения многочленов и
+// степени вроде (x-1)^8 не раскрываются: у корня коэффициенты сокращаются
+// и теряют все знаки; такие узлы входят в сумму как обычные слагаемые.
+// Погрешность — порядка n·eps·Σ|c_k·x^k|, как у исходной суммы, но не
+// побитово та же, поэтому проход включается только в режиме fast-math.
+// Ошибок области определения в таких поддеревьях нет (x^0 не считается
+// одночленом).
+void rewrite_polynomials(Ast &ast);
+
+// Хэш-консинг: структурно одинаковые поддеревья (та же операция, те же
+// дети и литералы) сливаются в один узел, и дерево становится DAG. Все
+// операции чистые, поэтому общий узел достаточно вычислить один раз:
+// обход дерева идёт по массиву, а байткод сохраняет значение во временную
+// ячейку (STORE/FETCH). Остаётся первое вхождение — с его позицией ошибки.
+void share_subexpressions(Ast &ast);
+
+// Удаляет узлы, недостижимые из корня, сохраняя пост-порядок
+void remove_dead_nodes(Ast &ast);
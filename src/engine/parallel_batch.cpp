@@ -0,0 +1,36 @@
+// src/engine/parallel_batch.cpp
+#include "parallel_batch.hpp"
+
+#include <algorithm>
+
+ParallelBatchEvaluator::ParallelBatchEvaluator(const Program &program, ThreadPool &pool)
+    : program_(program), pool_(pool)
+{
+    for (size_t k = 0; k < pool.size(); ++k)
+        workers_.push_back(std::make_unique<Worker>(program));
+}
+
+size_t ParallelBatchEvaluator::evaluate(const double *const *columns, size_t rows, double *out,
+                                        uint64_t *error_mask, ErrorCode *codes)
+{
+    static_assert(kParallelChunk % 64 == 0, "задача должна покрывать целые слова маски");
+
+    for (auto &w : workers_)
+        w->failed = 0;
+    const size_t chunks = (rows + kParallelChunk - 1) / kParallelChunk;
+    pool_.parallel_for(chunks, [&](size_t chunk, size_t worker)
+                       {
+        Worker &w = *workers_[worker];
+        size_t first = chunk * kParallelChunk;
+        size_t n = std::min(kParallelChunk, rows - first);
+        w.columns.resize(program_.var_count);
+        for (size_t v = 0; v < program_.var_count; ++v)
+            w.columns[v] = columns[v] + first;
+        w.failed += w.batch.evaluate(w.columns.data(), n, out + first, error_mask + first / 64,
+                                     codes ? codes + first : nullptr); });
+
+    size_t failed = 0;
+    for (const auto &w : workers_)
+        failed += w->failed;
+    return failed;
+}
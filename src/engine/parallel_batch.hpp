@@ -0,0 +1,39 @@
+// src/engine/parallel_batch.hpp
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "batch.hpp"
+#include "thread_pool.hpp"
+
+// Строк в одной задаче параллельного вычисления. Кратно kBatchBlock и 64,
+// поэтому каждая задача пишет только свои слова маски ошибок.
+static constexpr size_t kParallelChunk = kBatchBlock * 16;
+
+// BatchEvaluator, распределяющий строки по потокам ThreadPool. Результаты,
+// маска и коды ошибок побитово совпадают с однопоточным BatchEvaluator:
+// каждая строка вычисляется независимо теми же ядрами.
+class ParallelBatchEvaluator
+{
+public:
+    ParallelBatchEvaluator(const Program &program, ThreadPool &pool);
+
+    // Параметры и результат — как у BatchEvaluator::evaluate
+    size_t evaluate(const double *const *columns, size_t rows, double *out,
+                    uint64_t *error_mask, ErrorCode *codes = nullptr);
+
+private:
+    // Состояние одного потока пула
+    struct Worker
+    {
+        explicit Worker(const Program &program) : batch(program) {}
+        BatchEvaluator batch;
+        std::vector<const double *> columns; // столбцы, сдвинутые к началу задачи
+        size_t failed = 0;
+    };
+
+    const Program &program_;
+    ThreadPool &pool_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+};
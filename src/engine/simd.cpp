@@ -0,0 +1,58 @@
+// src/engine/simd.cpp
+#include "simd.hpp"
+
+#include <cmath>
+
+namespace
+{
+    // Те же выражения, что в таблицах VM, чтобы строгий уровень совпадал с ней побитово
+    template <class F>
+    void each1(const double *x, double *out, size_t n, F f)
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = f(x[i]);
+    }
+
+    template <class F>
+    void each2(const double *a, const double *b, double *out, size_t n, F f)
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = f(a[i], b[i]);
+    }
+
+    void s_sin(const double *x, double *out, size_t n) { each1(x, out, n, [](double v) { return std::sin(v); }); }
+    void s_cos(const double *x, double *out, size_t n) { each1(x, out, n, [](double v) { return std::cos(v); }); }
+    void s_tan(const double *x, double *out, size_t n) { each1(x, out, n, [](double v) { return std::tan(v); }); }
+    void s_asin(const double *x, double *out, size_t n) { each1(x, out, n, [](double v) { return std::asin(v); }); }
+    void s_acos(const double *x, double *out, size_t n) { each1(x, out, n, [](double v) { return std::acos(v); }); }
+    void s_atan(const double *x, double *out, size_t n) { each1(x, out, n, [](double v) { return std::atan(v); }); }
+    void s_sqrt(const double *x, double *out, size_t n) { each1(x, out, n, [](double v) { return std::sqrt(v); }); }
+    void s_ln(const double *x, double *out, size_t n) { each1(x, out, n, [](double v) { return std::log(v); }); }
+    void s_lg(const double *x, double *out, size_t n) { each1(x, out, n, [](double v) { return std::log10(v); }); }
+    void s_abs(const double *x, double *out, size_t n) { each1(x, out, n, [](double v) { return std::fabs(v); }); }
+
+    void s_pow(const double *a, const double *b, double *out, size_t n)
+    {
+        each2(a, b, out, n, [](double x, double y) { return std::pow(x, y); });
+    }
+    void s_root(const double *a, const double *b, double *out, size_t n)
+    {
+        each2(a, b, out, n, [](double x, double k) { return std::pow(x, 1.0 / k); });
+    }
+    void s_log(const double *a, const double *b, double *out, size_t n)
+    {
+        each2(a, b, out, n, [](double x, double base) { return std::log(x) / std::log(base); });
+    }
+
+    const KernelSet kStrict = {
+        "strict",
+        {s_sin, s_cos, s_tan, s_asin, s_acos, s_atan, s_sqrt, s_ln, s_lg, s_abs, nullptr, nullptr, nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, s_pow, s_root, s_log}};
+} // namespace
+
+const KernelSet &strict_kernels() { return kStrict; }
+
+const KernelSet &kernels_for(Accuracy accuracy)
+{
+    return accuracy == Accuracy::FAST ? fast_kernels() : strict_kernels();
+}
@@ -0,0 +1,35 @@
+// src/engine/simd.hpp
+#pragma once
+
+#include <cstddef>
+
+#include "bytecode.hpp"
+
+// Функции над массивами: out[i] = f(x[i]) или f(a[i], b[i]).
+// out может совпадать с любым из входов.
+using ArrayFn1 = void (*)(const double *x, double *out, size_t n);
+using ArrayFn2 = void (*)(const double *a, const double *b, double *out, size_t n);
+
+// Набор ядер математических функций для пакетного вычисления. Таблицы
+// индексируются FuncId; функции другой арности — nullptr. Оператор '^'
+// использует fn2[FuncId::POW].
+struct KernelSet
+{
+    const char *name;
+    ArrayFn1 fn1[size_t(FuncId::COUNT)];
+    ArrayFn2 fn2[size_t(FuncId::COUNT)];
+};
+
+// libm для каждого элемента: результаты побитово совпадают с VM
+const KernelSet &strict_kernels();
+
+// Векторные полиномиальные ядра активного уровня SIMD (см. dispatch.hpp);
+// без векторных ядер для платформы — strict_kernels()
+const KernelSet &fast_kernels();
+
+const KernelSet &kernels_for(Accuracy accuracy);
+
+// Ядра отдельных наборов инструкций; nullptr, если набор не собран
+const KernelSet *sse2_kernels();
+const KernelSet *avx2_kernels();
+const KernelSet *avx512_kernels();
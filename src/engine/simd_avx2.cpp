@@ -0,0 +1,67 @@
+// src/engine/simd_avx2.cpp
+// Быстрые ядра на AVX2 + FMA. Файл собирается с -mavx2 -mfma, а вызывается
+// только после проверки процессора в dispatch.cpp; без этих флагов
+// (другой компилятор или архитектура) набор не собирается.
+#include "simd.hpp"
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+#include <immintrin.h>
+
+namespace
+{
+    struct Avx2
+    {
+        using D = __m256d;
+        using I = __m256i;
+        static constexpr size_t W = 4;
+
+        static D set1(double v) { return _mm256_set1_pd(v); }
+        static D zero() { return _mm256_setzero_pd(); }
+        static D load(const double *p) { return _mm256_loadu_pd(p); }
+        static void store(double *p, D v) { _mm256_storeu_pd(p, v); }
+
+        static D add(D a, D b) { return _mm256_add_pd(a, b); }
+        static D sub(D a, D b) { return _mm256_sub_pd(a, b); }
+        static D mul(D a, D b) { return _mm256_mul_pd(a, b); }
+        static D div(D a, D b) { return _mm256_div_pd(a, b); }
+        static D sqrt(D a) { return _mm256_sqrt_pd(a); }
+        static D fmadd(D a, D b, D c) { return _mm256_fmadd_pd(a, b, c); }
+        static D fnmadd(D a, D b, D c) { return _mm256_fnmadd_pd(a, b, c); }
+
+        static D and_(D a, D b) { return _mm256_and_pd(a, b); }
+        static D or_(D a, D b) { return _mm256_or_pd(a, b); }
+        static D xor_(D a, D b) { return _mm256_xor_pd(a, b); }
+        static D andnot(D a, D b) { return _mm256_andnot_pd(a, b); }
+        static D cmpeq(D a, D b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+        static D cmpgt(D a, D b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+        static D cmpge(D a, D b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+        static D cmple(D a, D b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+        static int movemask(D a) { return _mm256_movemask_pd(a); }
+
+        static I set1_64(long long v) { return _mm256_set1_epi64x(v); }
+        static I castsi(D a) { return _mm256_castpd_si256(a); }
+        static D castpd(I a) { return _mm256_castsi256_pd(a); }
+        static I add64(I a, I b) { return _mm256_add_epi64(a, b); }
+        static I sub64(I a, I b) { return _mm256_sub_epi64(a, b); }
+        static I slli64(I a, int n) { return _mm256_slli_epi64(a, n); }
+        static I srli64(I a, int n) { return _mm256_srli_epi64(a, n); }
+        static I and_si(I a, I b) { return _mm256_and_si256(a, b); }
+        static I or_si(I a, I b) { return _mm256_or_si256(a, b); }
+    };
+} // namespace
+
+#include "simd_kernels.inl"
+
+namespace
+{
+    constexpr KernelSet kAvx2 = Kernels<Avx2>::make("avx2");
+} // namespace
+
+const KernelSet *avx2_kernels() { return &kAvx2; }
+
+#else
+
+const KernelSet *avx2_kernels() { return nullptr; }
+
+#endif
@@ -0,0 +1,70 @@
+// src/engine/simd_avx512.cpp
+// Быстрые ядра на AVX-512F. Файл собирается с -mavx512f, а вызывается только
+// после проверки процессора и ОС в dispatch.cpp. Используются лишь инструкции
+// AVX-512F: маски сравнений переводятся в обычные векторные маски, поэтому
+// код ядер общий с SSE2 и AVX2.
+#include "simd.hpp"
+
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+
+namespace
+{
+    struct Avx512
+    {
+        using D = __m512d;
+        using I = __m512i;
+        static constexpr size_t W = 8;
+
+        static D set1(double v) { return _mm512_set1_pd(v); }
+        static D zero() { return _mm512_setzero_pd(); }
+        static D load(const double *p) { return _mm512_loadu_pd(p); }
+        static void store(double *p, D v) { _mm512_storeu_pd(p, v); }
+
+        static D add(D a, D b) { return _mm512_add_pd(a, b); }
+        static D sub(D a, D b) { return _mm512_sub_pd(a, b); }
+        static D mul(D a, D b) { return _mm512_mul_pd(a, b); }
+        static D div(D a, D b) { return _mm512_div_pd(a, b); }
+        static D sqrt(D a) { return _mm512_sqrt_pd(a); }
+        static D fmadd(D a, D b, D c) { return _mm512_fmadd_pd(a, b, c); }
+        static D fnmadd(D a, D b, D c) { return _mm512_fnmadd_pd(a, b, c); }
+
+        // Побитовые операции над double есть только в AVX-512DQ, берём целочисленные
+        static D and_(D a, D b) { return castpd(_mm512_and_si512(castsi(a), castsi(b))); }
+        static D or_(D a, D b) { return castpd(_mm512_or_si512(castsi(a), castsi(b))); }
+        static D xor_(D a, D b) { return castpd(_mm512_xor_si512(castsi(a), castsi(b))); }
+        static D andnot(D a, D b) { return castpd(_mm512_andnot_si512(castsi(a), castsi(b))); }
+        static D mask(__mmask8 m) { return castpd(_mm512_maskz_set1_epi64(m, -1)); }
+        static D cmpeq(D a, D b) { return mask(_mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ)); }
+        static D cmpgt(D a, D b) { return mask(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ)); }
+        static D cmpge(D a, D b) { return mask(_mm512_cmp_pd_mask(a, b, _CMP_GE_OQ)); }
+        static D cmple(D a, D b) { return mask(_mm512_cmp_pd_mask(a, b, _CMP_LE_OQ)); }
+        static int movemask(D a) { return _mm512_cmplt_epi64_mask(castsi(a), _mm512_setzero_si512()); }
+
+        static I set1_64(long long v) { return _mm512_set1_epi64(v); }
+        static I castsi(D a) { return _mm512_castpd_si512(a); }
+        static D castpd(I a) { return _mm512_castsi512_pd(a); }
+        static I add64(I a, I b) { return _mm512_add_epi64(a, b); }
+        static I sub64(I a, I b) { return _mm512_sub_epi64(a, b); }
+        static I slli64(I a, int n) { return _mm512_slli_epi64(a, unsigned(n)); }
+        static I srli64(I a, int n) { return _mm512_srli_epi64(a, unsigned(n)); }
+        static I and_si(I a, I b) { return _mm512_and_si512(a, b); }
+        static I or_si(I a, I b) { return _mm512_or_si512(a, b); }
+    };
+} // namespace
+
+#include "simd_kernels.inl"
+
+namespace
+{
+    constexpr KernelSet kAvx512 = Kernels<Avx512>::make("avx512");
+} // namespace
+
+const KernelSet *avx512_kernels() { return &kAvx512; }
+
+#else
+
+const KernelSet *avx512_kernels() { return nullptr; }
+
+#endif
@@ -0,0 +1,400 @@
+// src/engine/simd_kernels.inl
+// Векторные ядра быстрого уровня точности, общие для всех наборов инструкций.
+// Файл подключается только из simd_<isa>.cpp после определения класса V
+// с операциями над регистром: каждая такая единица трансляции собирается
+// со своими флагами процессора. Всё здесь имеет внутреннее связывание,
+// иначе компоновщик мог бы подставить код AVX2 в вызов с другой единицы.
+//
+// Каждое ядро вычисляет «удобные» элементы полиномом, а остальные
+// (бесконечности, NaN, слишком большие аргументы, субнормальные числа)
+// отмечает в маске slow и пересчитывает через libm.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "simd.hpp"
+
+namespace
+{
+    constexpr double kLog2e = 1.4426950408889634;
+    // ln 2 = kLn2Hi + kLn2Lo; у kLn2Hi младшие биты нулевые, k * kLn2Hi точно
+    constexpr double kLn2Hi = 6.93147180369123816490e-01;
+    constexpr double kLn2Lo = 1.90821492927058770002e-10;
+    constexpr double kInvLn10 = 0.43429448190325182765;
+    constexpr double kSqrt2 = 1.41421356237309504880;
+    constexpr double kTwoOverPi = 0.63661977236758134308;
+    // pi/2 = kPio2_1 + kPio2_2 + kPio2_3 с точностью около 1e-31 (как в fdlibm)
+    constexpr double kPio2_1 = 1.57079632673412561417e+00;
+    constexpr double kPio2_2 = 6.07710050630396597660e-11;
+    constexpr double kPio2_3 = 2.02226624871116645580e-21;
+    constexpr double kPiOver2 = 1.57079632679489661923;
+    constexpr double kPiOver4 = 0.78539816339744830962;
+    constexpr double kTanPi8 = 0.41421356237309504880;
+    constexpr double kTan3Pi8 = 2.41421356237309504880;
+    // После сложения с 1.5 * 2^52 младшие биты мантиссы содержат округлённое целое
+    constexpr double kRoundMagic = 6755399441055744.0;
+    // Пределы, в которых работают полиномиальные ветви
+    constexpr double kTrigMax = 1.0e5;
+    constexpr double kExpMax = 708.0;
+    // До 2^51 округление через kRoundMagic точно
+    constexpr double kMaxExactInt = 2251799813685248.0;
+    constexpr double kMinNormal = 2.2250738585072014e-308;
+    constexpr double kMaxFinite = 1.7976931348623157e308;
+
+    // exp(r) = sum r^k / k!, |r| <= ln2 / 2
+    constexpr double kExpPoly[] = {
+        1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040, 1.0 / 40320,
+        1.0 / 362880, 1.0 / 3628800, 1.0 / 39916800, 1.0 / 479001600, 1.0 / 6227020800.0};
+    // log(1+f) = f - s*(f - z*P(z)), s = f/(2+f), z = s^2, P — ряд 2*atanh
+    constexpr double kLogPoly[] = {
+        2.0 / 3, 2.0 / 5, 2.0 / 7, 2.0 / 9, 2.0 / 11, 2.0 / 13, 2.0 / 15, 2.0 / 17, 2.0 / 19, 2.0 / 21};
+    // sin(r) = r + r^3 * S(r^2), cos(r) = 1 + r^2 * C(r^2), |r| <= pi/4
+    constexpr double kSinPoly[] = {
+        -1.0 / 6, 1.0 / 120, -1.0 / 5040, 1.0 / 362880, -1.0 / 39916800, 1.0 / 6227020800.0,
+        -1.0 / 1307674368000.0, 1.0 / 355687428096000.0};
+    constexpr double kCosPoly[] = {
+        -1.0 / 2, 1.0 / 24, -1.0 / 720, 1.0 / 40320, -1.0 / 3628800, 1.0 / 479001600,
+        -1.0 / 87178291200.0, 1.0 / 20922789888000.0, -1.0 / 6402373705728000.0};
+    // atan(t) = t + t^3 * A(t^2), |t| <= tan(pi/8)
+    constexpr double kAtanPoly[] = {
+        -1.0 / 3, 1.0 / 5, -1.0 / 7, 1.0 / 9, -1.0 / 11, 1.0 / 13, -1.0 / 15, 1.0 / 17, -1.0 / 19, 1.0 / 21,
+        -1.0 / 23, 1.0 / 25, -1.0 / 27, 1.0 / 29, -1.0 / 31, 1.0 / 33, -1.0 / 35, 1.0 / 37, -1.0 / 39, 1.0 / 41};
+
+    template <class V>
+    struct Fast
+    {
+        using D = typename V::D;
+        using I = typename V::I;
+
+        template <size_t N>
+        static D horner(D x, const double (&c)[N])
+        {
+            D r = V::set1(c[N - 1]);
+            for (size_t k = N - 1; k-- > 0;)
+                r = V::fmadd(r, x, V::set1(c[k]));
+            return r;
+        }
+
+        static D select(D mask, D a, D b) { return V::or_(V::and_(mask, a), V::andnot(mask, b)); }
+        static D abs(D x) { return V::andnot(V::set1(-0.0), x); }
+        static D negate_if(D mask, D x) { return V::xor_(x, V::and_(mask, V::set1(-0.0))); }
+
+        // Округление к ближайшему для |x| < 2^51; в bits — то же целое как int64
+        static D round(D x, I &bits)
+        {
+            D t = V::add(x, V::set1(kRoundMagic));
+            bits = V::sub64(V::castsi(t), V::castsi(V::set1(kRoundMagic)));
+            return V::sub(t, V::set1(kRoundMagic));
+        }
+        static D round(D x)
+        {
+            return V::sub(V::add(x, V::set1(kRoundMagic)), V::set1(kRoundMagic));
+        }
+        static D to_double(I k)
+        {
+            return V::sub(V::castpd(V::add64(k, V::castsi(V::set1(kRoundMagic)))), V::set1(kRoundMagic));
+        }
+
+        // Нормальные положительные конечные x
+        static D normal_positive(D x)
+        {
+            return V::and_(V::cmpge(x, V::set1(kMinNormal)), V::cmple(x, V::set1(kMaxFinite)));
+        }
+
+        // |x| <= kExpMax: x = k*ln2 + r, exp(x) = 2^k * exp(r)
+        static D exp_core(D x)
+        {
+            I k;
+            D kd = round(V::mul(x, V::set1(kLog2e)), k);
+            D r = V::fnmadd(kd, V::set1(kLn2Hi), x);
+            r = V::fnmadd(kd, V::set1(kLn2Lo), r);
+            D p = horner(r, kExpPoly);
+            return V::castpd(V::add64(V::castsi(p), V::slli64(k, 52)));
+        }
+
+        // x нормальное положительное: x = 2^e * m, m в [sqrt(2)/2, sqrt(2))
+        static D log_core(D x)
+        {
+            I bits = V::castsi(x);
+            I e = V::sub64(V::srli64(bits, 52), V::set1_64(1023));
+            D m = V::castpd(V::or_si(V::and_si(bits, V::set1_64(0x000FFFFFFFFFFFFFLL)),
+                                     V::set1_64(0x3FF0000000000000LL)));
+            D big = V::cmpgt(m, V::set1(kSqrt2));
+            m = select(big, V::mul(m, V::set1(0.5)), m);
+            D ed = V::add(to_double(e), V::and_(big, V::set1(1.0)));
+            D f = V::sub(m, V::set1(1.0));
+            D s = V::div(f, V::add(V::set1(2.0), f));
+            D z = V::mul(s, s);
+            D r = V::mul(z, horner(z, kLogPoly));
+            D lm = V::fnmadd(s, V::sub(f, r), f);
+            return V::fmadd(ed, V::set1(kLn2Hi), V::fmadd(ed, V::set1(kLn2Lo), lm));
+        }
+
+        // |x| <= kTrigMax: x = k*pi/2 + r; q = k mod 4 в виде -2..2
+        static void sincos_core(D x, D &s, D &c, D &q)
+        {
+            D k = round(V::mul(x, V::set1(kTwoOverPi)));
+            D r = V::fnmadd(k, V::set1(kPio2_1), x);
+            r = V::fnmadd(k, V::set1(kPio2_2), r);
+            r = V::fnmadd(k, V::set1(kPio2_3), r);
+            D z = V::mul(r, r);
+            s = V::fmadd(V::mul(r, z), horner(z, kSinPoly), r);
+            c = V::fmadd(z, horner(z, kCosPoly), V::set1(1.0));
+            q = V::fnmadd(V::set1(4.0), round(V::mul(k, V::set1(0.25))), k);
+        }
+
+        static D atan_core(D x)
+        {
+            D a = abs(x);
+            D big = V::cmpgt(a, V::set1(kTan3Pi8));
+            D mid = V::andnot(big, V::cmpgt(a, V::set1(kTanPi8)));
+            // big: t = -1/a, mid: t = (a-1)/(a+1), иначе t = a
+            D one = V::set1(1.0);
+            D num = select(big, V::set1(-1.0), select(mid, V::sub(a, one), a));
+            D den = select(big, a, select(mid, V::add(a, one), one));
+            D t = V::div(num, den);
+            D base = select(big, V::set1(kPiOver2), V::and_(mid, V::set1(kPiOver4)));
+            D z = V::mul(t, t);
+            D y = V::add(base, V::fmadd(V::mul(t, z), horner(z, kAtanPoly), t));
+            return V::or_(y, V::and_(x, V::set1(-0.0)));
+        }
+
+        static D not_(D m) { return V::xor_(m, V::castpd(V::set1_64(-1))); }
+        // Истинно для |x| > kTrigMax, бесконечностей и NaN
+        static D trig_slow(D x) { return not_(V::cmple(abs(x), V::set1(kTrigMax))); }
+
+        static D sin(D x, D &slow)
+        {
+            slow = trig_slow(x);
+            D s, c, q;
+            sincos_core(x, s, c, q);
+            D aq = abs(q);
+            D odd = V::cmpeq(aq, V::set1(1.0));
+            D neg = V::or_(V::cmpeq(aq, V::set1(2.0)), V::cmpeq(q, V::set1(-1.0)));
+            return negate_if(neg, select(odd, c, s));
+        }
+
+        static D cos(D x, D &slow)
+        {
+            slow = trig_slow(x);
+            D s, c, q;
+            sincos_core(x, s, c, q);
+            D aq = abs(q);
+            D odd = V::cmpeq(aq, V::set1(1.0));
+            D neg = V::or_(V::cmpeq(aq, V::set1(2.0)), V::cmpeq(q, V::set1(1.0)));
+            return negate_if(neg, select(odd, s, c));
+        }
+
+        // В нечётной четверти tan(x) = -cos(r) / sin(r)
+        static D tan(D x, D &slow)
+        {
+            slow = trig_slow(x);
+            D s, c, q;
+            sincos_core(x, s, c, q);
+            D odd = V::cmpeq(abs(q), V::set1(1.0));
+            return V::div(negate_if(odd, select(odd, c, s)), select(odd, s, c));
+        }
+
+        static D atan(D x, D &slow)
+        {
+            slow = V::zero();
+            return atan_core(x);
+        }
+
+        // asin(x) = atan(x / sqrt((1-x)(1+x))); при |x| = 1 деление даёт ±inf и ±pi/2
+        static D asin(D x, D &slow)
+        {
+            slow = V::zero();
+            D one = V::set1(1.0);
+            D d = V::sqrt(V::mul(V::sub(one, x), V::add(one, x)));
+            return atan_core(V::div(x, d));
+        }
+
+        // acos(x) = 2 * atan(sqrt((1-x)/(1+x))): точен и около 1, и около -1
+        static D acos(D x, D &slow)
+        {
+            slow = V::zero();
+            D one = V::set1(1.0);
+            D t = V::sqrt(V::div(V::sub(one, x), V::add(one, x)));
+            return V::mul(V::set1(2.0), atan_core(t));
+        }
+
+        static D ln(D x, D &slow)
+        {
+            slow = not_(normal_positive(x));
+            return log_core(x);
+        }
+
+        static D lg(D x, D &slow)
+        {
+            slow = not_(normal_positive(x));
+            return V::mul(log_core(x), V::set1(kInvLn10));
+        }
+
+        // pow(a, b) = exp(b * ln|a|); при a < 0 показатель должен быть целым,
+        // и знак берётся по его чётности. Нули, бесконечности, дробные
+        // показатели отрицательных оснований и переполнения считает libm.
+        static D pow(D a, D b, D &slow)
+        {
+            D abs_a = abs(a);
+            D y = V::mul(b, log_core(abs_a));
+            D ok = V::and_(normal_positive(abs_a), V::cmple(abs(y), V::set1(kExpMax)));
+            D negative = V::cmpgt(V::zero(), a);
+            D integral = V::and_(V::cmple(abs(b), V::set1(kMaxExactInt)), V::cmpeq(round(b), b));
+            D half = V::mul(b, V::set1(0.5));
+            D odd = V::andnot(V::cmpeq(round(half), half), integral);
+            ok = V::andnot(V::andnot(integral, negative), ok);
+            slow = not_(ok);
+            return negate_if(V::and_(negative, odd), exp_core(V::and_(ok, y)));
+        }
+
+        static D root(D x, D k, D &slow) { return pow(x, V::div(V::set1(1.0), k), slow); }
+
+        static D log(D x, D base, D &slow)
+        {
+            slow = not_(V::and_(normal_positive(x), normal_positive(base)));
+            return V::div(log_core(x), log_core(base));
+        }
+    };
+
+    // Хвост массива дополняется единицами и считается тем же векторным
+    // кодом: результат элемента не зависит от его позиции в массиве
+    template <class V, class Vec, class Scalar>
+    void apply1(const double *x, double *out, size_t n, Vec vec, Scalar scalar)
+    {
+        using D = typename V::D;
+        constexpr size_t W = V::W;
+        auto step = [&](const double *src, double *dst)
+        {
+            alignas(64) double in[W];
+            D v = V::load(src);
+            V::store(in, v);
+            D slow;
+            V::store(dst, vec(v, slow));
+            if (int m = V::movemask(slow))
+                for (size_t l = 0; l < W; ++l)
+                    if ((m >> l) & 1)
+                        dst[l] = scalar(in[l]);
+        };
+        size_t i = 0;
+        for (; i + W <= n; i += W)
+            step(x + i, out + i);
+        if (i < n)
+        {
+            alignas(64) double tail[W], res[W];
+            for (size_t l = 0; l < W; ++l)
+                tail[l] = i + l < n ? x[i + l] : 1.0;
+            step(tail, res);
+            for (size_t l = 0; i + l < n; ++l)
+                out[i + l] = res[l];
+        }
+    }
+
+    template <class V, class Vec, class Scalar>
+    void apply2(const double *a, const double *b, double *out, size_t n, Vec vec, Scalar scalar)
+    {
+        using D = typename V::D;
+        constexpr size_t W = V::W;
+        auto step = [&](const double *pa, const double *pb, double *dst)
+        {
+            alignas(64) double ina[W], inb[W];
+            D va = V::load(pa), vb = V::load(pb);
+            V::store(ina, va);
+            V::store(inb, vb);
+            D slow;
+            V::store(dst, vec(va, vb, slow));
+            if (int m = V::movemask(slow))
+                for (size_t l = 0; l < W; ++l)
+                    if ((m >> l) & 1)
+                        dst[l] = scalar(ina[l], inb[l]);
+        };
+        size_t i = 0;
+        for (; i + W <= n; i += W)
+            step(a + i, b + i, out + i);
+        if (i < n)
+        {
+            alignas(64) double ta[W], tb[W], res[W];
+            for (size_t l = 0; l < W; ++l)
+            {
+                ta[l] = i + l < n ? a[i + l] : 1.0;
+                tb[l] = i + l < n ? b[i + l] : 1.0;
+            }
+            step(ta, tb, res);
+            for (size_t l = 0; i + l < n; ++l)
+                out[i + l] = res[l];
+        }
+    }
+
+    template <class V>
+    struct Kernels
+    {
+        using F = Fast<V>;
+        using D = typename V::D;
+
+        static void sin(const double *x, double *out, size_t n)
+        {
+            apply1<V>(x, out, n, [](D v, D &slow) { return F::sin(v, slow); }, [](double v) { return std::sin(v); });
+        }
+        static void cos(const double *x, double *out, size_t n)
+        {
+            apply1<V>(x, out, n, [](D v, D &slow) { return F::cos(v, slow); }, [](double v) { return std::cos(v); });
+        }
+        static void tan(const double *x, double *out, size_t n)
+        {
+            apply1<V>(x, out, n, [](D v, D &slow) { return F::tan(v, slow); }, [](double v) { return std::tan(v); });
+        }
+        static void asin(const double *x, double *out, size_t n)
+        {
+            apply1<V>(x, out, n, [](D v, D &slow) { return F::asin(v, slow); }, [](double v) { return std::asin(v); });
+        }
+        static void acos(const double *x, double *out, size_t n)
+        {
+            apply1<V>(x, out, n, [](D v, D &slow) { return F::acos(v, slow); }, [](double v) { return std::acos(v); });
+        }
+        static void atan(const double *x, double *out, size_t n)
+        {
+            apply1<V>(x, out, n, [](D v, D &slow) { return F::atan(v, slow); }, [](double v) { return std::atan(v); });
+        }
+        static void ln(const double *x, double *out, size_t n)
+        {
+            apply1<V>(x, out, n, [](D v, D &slow) { return F::ln(v, slow); }, [](double v) { return std::log(v); });
+        }
+        static void lg(const double *x, double *out, size_t n)
+        {
+            apply1<V>(x, out, n, [](D v, D &slow) { return F::lg(v, slow); }, [](double v) { return std::log10(v); });
+        }
+        // sqrt и abs точны и на быстром уровне
+        static void sqrt(const double *x, double *out, size_t n)
+        {
+            apply1<V>(x, out, n, [](D v, D &slow) { slow = V::zero(); return V::sqrt(v); }, [](double v) { return std::sqrt(v); });
+        }
+        static void abs(const double *x, double *out, size_t n)
+        {
+            apply1<V>(x, out, n, [](D v, D &slow) { slow = V::zero(); return F::abs(v); }, [](double v) { return std::fabs(v); });
+        }
+        static void pow(const double *a, const double *b, double *out, size_t n)
+        {
+            apply2<V>(a, b, out, n, [](D x, D y, D &slow) { return F::pow(x, y, slow); },
+                      [](double x, double y) { return std::pow(x, y); });
+        }
+        static void root(const double *a, const double *b, double *out, size_t n)
+        {
+            apply2<V>(a, b, out, n, [](D x, D k, D &slow) { return F::root(x, k, slow); },
+                      [](double x, double k) { return std::pow(x, 1.0 / k); });
+        }
+        static void log(const double *a, const double *b, double *out, size_t n)
+        {
+            apply2<V>(a, b, out, n, [](D x, D base, D &slow) { return F::log(x, base, slow); },
+                      [](double x, double base) { return std::log(x) / std::log(base); });
+        }
+
+        static constexpr KernelSet make(const char *name)
+        {
+            return KernelSet{
+                name,
+                {sin, cos, tan, asin, acos, atan, sqrt, ln, lg, abs, nullptr, nullptr, nullptr},
+                {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, pow, root, log}};
+        }
+    };
+} // namespace
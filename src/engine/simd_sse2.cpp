@@ -0,0 +1,66 @@
+// src/engine/simd_sse2.cpp
+// Быстрые ядра на SSE2: базовый набор любого процессора x86-64
+#include "simd.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+
+#include <emmintrin.h>
+
+namespace
+{
+    struct Sse2
+    {
+        using D = __m128d;
+        using I = __m128i;
+        static constexpr size_t W = 2;
+
+        static D set1(double v) { return _mm_set1_pd(v); }
+        static D zero() { return _mm_setzero_pd(); }
+        static D load(const double *p) { return _mm_loadu_pd(p); }
+        static void store(double *p, D v) { _mm_storeu_pd(p, v); }
+
+        static D add(D a, D b) { return _mm_add_pd(a, b); }
+        static D sub(D a, D b) { return _mm_sub_pd(a, b); }
+        static D mul(D a, D b) { return _mm_mul_pd(a, b); }
+        static D div(D a, D b) { return _mm_div_pd(a, b); }
+        static D sqrt(D a) { return _mm_sqrt_pd(a); }
+        // Без FMA: a*b + c и c - a*b с двумя округлениями
+        static D fmadd(D a, D b, D c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+        static D fnmadd(D a, D b, D c) { return _mm_sub_pd(c, _mm_mul_pd(a, b)); }
+
+        static D and_(D a, D b) { return _mm_and_pd(a, b); }
+        static D or_(D a, D b) { return _mm_or_pd(a, b); }
+        static D xor_(D a, D b) { return _mm_xor_pd(a, b); }
+        static D andnot(D a, D b) { return _mm_andnot_pd(a, b); }
+        static D cmpeq(D a, D b) { return _mm_cmpeq_pd(a, b); }
+        static D cmpgt(D a, D b) { return _mm_cmpgt_pd(a, b); }
+        static D cmpge(D a, D b) { return _mm_cmpge_pd(a, b); }
+        static D cmple(D a, D b) { return _mm_cmple_pd(a, b); }
+        static int movemask(D a) { return _mm_movemask_pd(a); }
+
+        static I set1_64(long long v) { return _mm_set1_epi64x(v); }
+        static I castsi(D a) { return _mm_castpd_si128(a); }
+        static D castpd(I a) { return _mm_castsi128_pd(a); }
+        static I add64(I a, I b) { return _mm_add_epi64(a, b); }
+        static I sub64(I a, I b) { return _mm_sub_epi64(a, b); }
+        static I slli64(I a, int n) { return _mm_slli_epi64(a, n); }
+        static I srli64(I a, int n) { return _mm_srli_epi64(a, n); }
+        static I and_si(I a, I b) { return _mm_and_si128(a, b); }
+        static I or_si(I a, I b) { return _mm_or_si128(a, b); }
+    };
+} // namespace
+
+#include "simd_kernels.inl"
+
+namespace
+{
+    constexpr KernelSet kSse2 = Kernels<Sse2>::make("sse2");
+} // namespace
+
+const KernelSet *sse2_kernels() { return &kSse2; }
+
+#else
+
+const KernelSet *sse2_kernels() { return nullptr; }
+
+#endif
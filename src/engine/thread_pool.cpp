@@ -0,0 +1,147 @@
+// src/engine/thread_pool.cpp
+#include "thread_pool.hpp"
+
+size_t default_thread_count()
+{
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    if (threads == 0)
+        threads = default_thread_count();
+    for (size_t k = 0; k < threads; ++k)
+        ranges_.push_back(std::make_unique<Range>());
+    for (size_t k = 1; k < threads; ++k)
+        threads_.emplace_back([this, k] { worker_loop(k); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &t : threads_)
+        t.join();
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t, size_t)> &body)
+{
+    if (count == 0)
+        return;
+    std::lock_guard<std::mutex> submit(submit_);
+
+    // Начальное разбиение поровну; дальше балансирует перехват
+    const size_t n = size();
+    for (size_t k = 0; k < n; ++k)
+    {
+        std::lock_guard<std::mutex> lock(ranges_[k]->mutex);
+        ranges_[k]->begin = count * k / n;
+        ranges_[k]->end = count * (k + 1) / n;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        body_ = &body;
+        error_ = nullptr;
+        failed_ = false;
+        running_ = threads_.size();
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    run(0);
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return running_ == 0; });
+        body_ = nullptr;
+        error = error_;
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void ThreadPool::worker_loop(size_t worker)
+{
+    uint64_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_)
+                return;
+            seen = generation_;
+        }
+        run(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --running_;
+        }
+        done_.notify_one();
+    }
+}
+
+void ThreadPool::run(size_t worker)
+{
+    size_t index;
+    while (take(worker, index) || (steal(worker) && take(worker, index)))
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (failed_)
+                continue;
+        }
+        try
+        {
+            (*body_)(index, worker);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!failed_)
+                error_ = std::current_exception();
+            failed_ = true;
+        }
+    }
+}
+
+bool ThreadPool::take(size_t worker, size_t &index)
+{
+    Range &r = *ranges_[worker];
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (r.begin >= r.end)
+        return false;
+    index = r.begin++;
+    return true;
+}
+
+// Забирает вторую половину диапазона первого непустого соседа
+bool ThreadPool::steal(size_t worker)
+{
+    const size_t n = size();
+    for (size_t k = 1; k < n; ++k)
+    {
+        Range &victim = *ranges_[(worker + k) % n];
+        size_t begin, end;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.begin >= victim.end)
+                continue;
+            size_t left = victim.end - victim.begin;
+            begin = victim.end - (left + 1) / 2;
+            end = victim.end;
+            victim.end = begin;
+        }
+        Range &own = *ranges_[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.begin = begin;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
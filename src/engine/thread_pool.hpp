@@ -0,0 +1,65 @@
+// src/engine/thread_pool.hpp
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с перехватом работы для параллельных циклов. Каждый поток
+// получает свой непрерывный диапазон индексов и берёт из него по одному
+// с начала; освободившийся поток забирает у соседа вторую половину
+// оставшегося диапазона. Вызывающий поток участвует в работе как поток 0.
+class ThreadPool
+{
+public:
+    // threads — общее число потоков вместе с вызывающим; 0 — по числу ядер
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return ranges_.size(); }
+
+    // Вызывает body(index, worker) для каждого index из [0, count) ровно один
+    // раз, worker < size(). Возвращается, когда все вызовы завершены; первое
+    // исключение из body пробрасывается после остановки остальных потоков.
+    // Одновременно выполняется только один parallel_for.
+    void parallel_for(size_t count, const std::function<void(size_t index, size_t worker)> &body);
+
+private:
+    // Диапазон задач потока; выровнен, чтобы соседние не делили строку кэша
+    struct alignas(64) Range
+    {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    void worker_loop(size_t worker);
+    void run(size_t worker);
+    bool take(size_t worker, size_t &index);
+    bool steal(size_t worker);
+
+    std::vector<std::unique_ptr<Range>> ranges_;
+    std::vector<std::thread> threads_;
+
+    std::mutex submit_;               // сериализует parallel_for
+    std::mutex mutex_;                // защищает поля ниже
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t generation_ = 0;
+    size_t running_ = 0;              // фоновые потоки, ещё занятые текущим циклом
+    bool stop_ = false;
+    const std::function<void(size_t, size_t)> *body_ = nullptr;
+    std::exception_ptr error_;
+    bool failed_ = false;             // после исключения новые задачи не запускаются
+};
+
+// Число потоков по умолчанию: std::thread::hardware_concurrency(), не меньше 1
+size_t default_thread_count();
@@ -0,0 +1,147 @@
+// src/engine/vm.cpp
+#include "vm.hpp"
+
+#include <cmath>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FAST_CALC_COMPUTED_GOTO 1
+#endif
+
+namespace
+{
+    double f_sin(double x) { return std::sin(x); }
+    double f_cos(double x) { return std::cos(x); }
+    double f_tan(double x) { return std::tan(x); }
+    double f_asin(double x) { return std::asin(x); }
+    double f_acos(double x) { return std::acos(x); }
+    double f_atan(double x) { return std::atan(x); }
+    double f_sqrt(double x) { return std::sqrt(x); }
+    double f_ln(double x) { return std::log(x); }
+    double f_lg(double x) { return std::log10(x); }
+    double f_abs(double x) { return std::fabs(x); }
+    double f_pow(double a, double b) { return std::pow(a, b); }
+    double f_root(double x, double n) { return std::pow(x, 1.0 / n); }
+    double f_log(double x, double base) { return std::log(x) / std::log(base); }
+
+    // Таблицы индексируются FuncId; функции другой арности — nullptr
+    const MathFn1 kFunc1[] = {f_sin, f_cos, f_tan, f_asin, f_acos, f_atan, f_sqrt,
+                              f_ln, f_lg, f_abs, nullptr, nullptr, nullptr};
+    const MathFn2 kFunc2[] = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                              nullptr, nullptr, nullptr, f_pow, f_root, f_log};
+    static_assert(sizeof(kFunc1) / sizeof(kFunc1[0]) == size_t(FuncId::COUNT), "kFunc1 не соответствует FuncId");
+    static_assert(sizeof(kFunc2) / sizeof(kFunc2[0]) == size_t(FuncId::COUNT), "kFunc2 не соответствует FuncId");
+} // namespace
+
+MathFn1 math_fn1(FuncId f) { return kFunc1[size_t(f)]; }
+MathFn2 math_fn2(FuncId f) { return kFunc2[size_t(f)]; }
+double call_func1(FuncId f, double x) { return kFunc1[size_t(f)](x); }
+double call_func2(FuncId f, double a, double b) { return kFunc2[size_t(f)](a, b); }
+
+ErrorCode run(const Program &program, const double *vars, double &result)
+{
+    double stack[kVmStackSize];
+    double temps[kMaxTemps];
+    double *sp = stack;
+    const Instr *ip = program.code.data();
+    const double *consts = program.consts.data();
+
+#ifdef FAST_CALC_COMPUTED_GOTO
+    // Порядок меток должен совпадать с OpCode
+    static const void *const kLabels[] = {&&op_PUSH, &&op_LOAD, &&op_NEG, &&op_FACT, &&op_ADD, &&op_SUB,
+                                          &&op_MUL, &&op_DIV, &&op_POW, &&op_FMA, &&op_CALL1, &&op_CALL2,
+                                          &&op_CHECK, &&op_STORE, &&op_FETCH, &&op_RET};
+    static_assert(sizeof(kLabels) / sizeof(kLabels[0]) == size_t(OpCode::COUNT), "kLabels не соответствует OpCode");
+#define VM_CASE(name) op_##name:
+#define VM_NEXT goto *kLabels[size_t((++ip)->op)]
+    goto *kLabels[size_t(ip->op)];
+#else
+#define VM_CASE(name) case OpCode::name:
+#define VM_NEXT \
+    ++ip;       \
+    continue
+    for (;;)
+    {
+        switch (ip->op)
+        {
+#endif
+
+    VM_CASE(PUSH)
+        *sp++ = consts[ip->operand];
+        VM_NEXT;
+    VM_CASE(LOAD)
+        *sp++ = vars[ip->operand];
+        VM_NEXT;
+    VM_CASE(NEG)
+        sp[-1] = -sp[-1];
+        VM_NEXT;
+    VM_CASE(FACT)
+        sp[-1] = std::tgamma(std::round(sp[-1]) + 1.0);
+        VM_NEXT;
+    VM_CASE(ADD)
+        sp[-2] = sp[-2] + sp[-1];
+        --sp;
+        VM_NEXT;
+    VM_CASE(SUB)
+        sp[-2] = sp[-2] - sp[-1];
+        --sp;
+        VM_NEXT;
+    VM_CASE(MUL)
+        sp[-2] = sp[-2] * sp[-1];
+        --sp;
+        VM_NEXT;
+    VM_CASE(DIV)
+        sp[-2] = sp[-2] / sp[-1];
+        --sp;
+        VM_NEXT;
+    VM_CASE(POW)
+        sp[-2] = std::pow(sp[-2], sp[-1]);
+        --sp;
+        VM_NEXT;
+    VM_CASE(FMA)
+        sp[-3] = std::fma(sp[-3], sp[-2], sp[-1]);
+        sp -= 2;
+        VM_NEXT;
+    VM_CASE(CALL1)
+        sp[-1] = kFunc1[ip->arg](sp[-1]);
+        VM_NEXT;
+    VM_CASE(CALL2)
+        sp[-2] = kFunc2[ip->arg](sp[-2], sp[-1]);
+        --sp;
+        VM_NEXT;
+    VM_CASE(CHECK)
+    {
+        CheckKind kind = CheckKind(ip->arg);
+        ErrorCode err = check_arity(kind) == 2 ? check_domain(kind, sp[-2], sp[-1])
+                                               : check_domain(kind, sp[-1]);
+        if (err != ErrorCode::OK)
+            return err;
+        VM_NEXT;
+    }
+    VM_CASE(STORE)
+        temps[ip->operand] = sp[-1];
+        VM_NEXT;
+    VM_CASE(FETCH)
+        *sp++ = temps[ip->operand];
+        VM_NEXT;
+    VM_CASE(RET)
+        result = sp[-1];
+        return ErrorCode::OK;
+
+#ifndef FAST_CALC_COMPUTED_GOTO
+        default:
+            return ErrorCode::OK;
+        }
+    }
+#endif
+#undef VM_CASE
+#undef VM_NEXT
+}
+
+double run_or_throw(const Program &program, const double *vars)
+{
+    double result = 0.0;
+    ErrorCode err = run(program, vars, result);
+    if (err != ErrorCode::OK)
+        throw CalcError(error_message(err));
+    return result;
+}
@@ -0,0 +1,20 @@
+// src/engine/vm.hpp
+#pragma once
+
+#include "bytecode.hpp"
+
+using MathFn1 = double (*)(double);
+using MathFn2 = double (*)(double, double);
+
+// Чистые математические функции без проверок области определения
+MathFn1 math_fn1(FuncId f);
+MathFn2 math_fn2(FuncId f);
+double call_func1(FuncId f, double x);
+double call_func2(FuncId f, double a, double b);
+
+// Выполняет программу над значениями переменных vars (program.var_count штук);
+// при ошибке области определения возвращает её код
+ErrorCode run(const Program &program, const double *vars, double &result);
+
+// То же, но бросает CalcError с текстом ошибки
+double run_or_throw(const Program &program, const double *vars = nullptr);
@@ -1,214 +1,347 @@
 // src/execute.cpp
 // Выполняет Хирвонен Матвей и Ефимов Игорь
-#include <sstream>
+#include <charconv>
 #include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <limits>
 
 #include "AST.hpp"
+#include "engine/domain.hpp"
 
 using std::string;
 
-static constexpr int kMaxOutputLen = 15;
-
-static double get_const(const string &name)
+namespace
 {
-    if (name == "pi")
-        return acos(-1.0);
-    if (name == "e")
-        return exp(1.0);
-    if (name == "phi")
-        return (1.0 + sqrt(5.0)) / 2.0;
-    throw CalcError("Неизвестная константа: " + name);
-}
+    // Значения констант вычисляются один раз, при загрузке программы
+    const double kConstValues[] = {acos(-1.0), exp(1.0), (1.0 + sqrt(5.0)) / 2.0};
+    static_assert(sizeof(kConstValues) / sizeof(kConstValues[0]) == size_t(ConstId::COUNT), "таблица значений не соответствует ConstId");
+} // namespace
 
-static double fact_checked(double x)
+double get_const(ConstId c)
 {
-    if (std::isnan(x) || std::isinf(x))
-        throw CalcError("Аргумент факториала некорректен");
-    if (x < 0)
-        throw CalcError("Факториал определён только для неотрицательных значений");
-    double ix = round(x);
-    if (fabs(ix - x) > 1e-12)
-        throw CalcError("Факториал допустим только для целых значений");
-    if (ix > 170.0)
-        throw CalcError("Слишком большое значение для факториала");
-    return tgamma(ix + 1.0);
+    if (c < ConstId::COUNT)
+        return kConstValues[size_t(c)];
+    throw CalcError("Неизвестная константа: #" + std::to_string(size_t(c)));
 }
 
-static string trim_trailing_zeros(const string &s)
+double apply_node(const AstNode &n, double a, double b, ErrorCode &code)
 {
-    auto pos_e = s.find_first_of("eE");
-    string mant = (pos_e == string::npos) ? s : s.substr(0, pos_e);
-    string expo = (pos_e == string::npos) ? "" : s.substr(pos_e);
-    if (mant.find('.') != string::npos)
+    static constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+    code = ErrorCode::OK;
+    auto check = [&](CheckKind kind)
+    {
+        code = check_domain(kind, a, b);
+        return code == ErrorCode::OK;
+    };
+
+    switch (n.op)
     {
-        while (!mant.empty() && mant.back() == '0')
-            mant.pop_back();
-        if (!mant.empty() && mant.back() == '.')
-            mant.pop_back();
+    case NodeOp::NUMBER:
+        return n.number;
+    case NodeOp::CONST:
+        return get_const(ConstId(n.id));
+    case NodeOp::VAR:
+        break;
+    case NodeOp::POS:
+        return +a;
+    case NodeOp::NEG:
+        return -a;
+    case NodeOp::FACT:
+        return check(CheckKind::FACT) ? tgamma(round(a) + 1.0) : kNaN;
+    case NodeOp::ADD:
+        return a + b;
+    case NodeOp::SUB:
+        return a - b;
+    case NodeOp::MUL:
+        return a * b;
+    case NodeOp::DIV:
+        return check(CheckKind::DIV) ? a / b : kNaN;
+    case NodeOp::POW:
+        return check(CheckKind::POW) ? pow(a, b) : kNaN;
+    case NodeOp::CALL:
+        switch (FuncId(n.id))
+        {
+        case FuncId::SIN:
+            return sin(a);
+        case FuncId::COS:
+            return cos(a);
+        case FuncId::TAN:
+            return check(CheckKind::TAN) ? tan(a) : kNaN;
+        case FuncId::ASIN:
+            return check(CheckKind::ASIN) ? asin(a) : kNaN;
+        case FuncId::ACOS:
+            return check(CheckKind::ACOS) ? acos(a) : kNaN;
+        case FuncId::ATAN:
+            return atan(a);
+        case FuncId::SQRT:
+            return check(CheckKind::SQRT) ? sqrt(a) : kNaN;
+        case FuncId::LN:
+            return check(CheckKind::LN) ? log(a) : kNaN;
+        case FuncId::LG:
+            return check(CheckKind::LG) ? log10(a) : kNaN;
+        case FuncId::ABS:
+            return fabs(a);
+        case FuncId::POW:
+            return pow(a, b);
+        case FuncId::ROOT:
+            return check(CheckKind::ROOT) ? pow(a, 1.0 / b) : kNaN;
+        case FuncId::LOG:
+            return check(CheckKind::LOG) ? log(a) / log(b) : kNaN;
+        default:
+            break;
+        }
+        throw CalcError("Неизвестная функция: #" + std::to_string(n.id));
     }
-    return mant + expo;
+    throw CalcError("Внутренняя ошибка AST");
 }
 
-static double eval(const std::shared_ptr<Node> &n)
+namespace
 {
-    switch (n->type)
-    {
-    case NodeType::NUMBER:
-        return n->number;
-    case NodeType::CONST:
-        return get_const(n->const_name);
-    case NodeType::UNARY:
+    // Значащие цифры: значение = d[0].d[1]d[2]... × 10^exp
+    struct Digits
     {
-        double a = eval(n->kids[0]);
-        if (n->op == "u+")
-            return +a;
-        if (n->op == "u-")
-            return -a;
-        if (n->op == "!")
-            return fact_checked(a);
-        throw CalcError("Неизвестный унарный оператор: " + n->op);
-    }
-    case NodeType::BINARY:
+        char d[kMaxNumberLen];
+        int count;
+        int exp;
+    };
+
+    // Прибавляет единицу в p-м знаке; 9.99 превращается в 1.00 × 10
+    void increment(Digits &g, int p)
     {
-        double a = eval(n->kids[0]);
-        double b = eval(n->kids[1]);
-        if (n->op == "+")
-            return a + b;
-        if (n->op == "-")
-            return a - b;
-        if (n->op == "*")
-            return a * b;
-        if (n->op == "/")
+        int k = p - 1;
+        while (k >= 0 && g.d[k] == '9')
+            g.d[k--] = '0';
+        if (k >= 0)
+            ++g.d[k];
+        else
         {
-            if (b == 0.0)
-                throw CalcError("Деление на ноль");
-            return a / b;
+            g.d[0] = '1';
+            ++g.exp;
         }
-        if (n->op == "^")
+    }
+
+    // Округляет 15 цифр до p. Цифры уже округлены один раз, поэтому хвост
+    // ровно "50…0" неоднозначен: точное значение может лежать по любую
+    // сторону половины. Тогда возвращается false.
+    bool round_digits(const Digits &src, int p, Digits &out)
+    {
+        out = src;
+        out.count = p;
+        if (p < src.count)
         {
-            if (a == 0.0 && b == 0.0)
-                throw CalcError("0^0 не определено");
-            return pow(a, b);
+            bool rest = false;
+            for (int k = p + 1; k < src.count; ++k)
+                rest |= src.d[k] != '0';
+            char next = src.d[p];
+            if (next == '5' && !rest)
+                return false;
+            if (next >= '5')
+                increment(out, p);
         }
-        throw CalcError("Неизвестный бинарный оператор: " + n->op);
+        while (out.count > 1 && out.d[out.count - 1] == '0')
+            --out.count;
+        return true;
     }
-    case NodeType::CALL:
-    {
-        const string &f = n->op;
-        auto A = [&](int i)
-        { return eval(n->kids[i]); };
 
+    // Разбирает "d.ddde±XX" из to_chars(scientific) в цифры и показатель
+    int parse_scientific(const char *first, const char *last, char *digits, int &exp)
+    {
+        int count = 0;
+        const char *p = first;
+        for (; p < last && *p != 'e'; ++p)
+            if (*p != '.')
+                digits[count++] = *p;
+        exp = 0;
+        for (const char *q = p + 2; q < last; ++q)
+            exp = exp * 10 + (*q - '0');
+        if (p[1] == '-')
+            exp = -exp;
+        return count;
+    }
 
-        if (f == "sin")
-            return sin(A(0));
-        if (f == "cos")
-            return cos(A(0));
-        if (f == "tan")
-        {
-            double x = A(0);
-            double c = cos(x);
-            if (fabs(c) < 1e-16)
-                throw CalcError("Значение tan имеет полюс при данном аргументе");
-            return tan(x);
-        }
-        if (f == "asin")
+    // 15 значащих цифр |x|, правильно округлённых. Обычно хватает кратчайшей
+    // записи (Ryu в to_chars): до 15 цифр она и есть округление, 16–17 цифр
+    // округляются, если хвост не лежит у половины ближе погрешности кратчайшей
+    // записи (меньше ulp, то есть не больше 2 единиц 17-го знака). Иначе
+    // цифры строит точный to_chars с точностью 14.
+    Digits decimal_digits(double ax)
+    {
+        char sci[32];
+        char shortest[17];
+        Digits out;
+        out.count = int(kMaxNumberLen);
+        auto res = std::to_chars(sci, sci + sizeof(sci), ax, std::chars_format::scientific);
+        int n = parse_scientific(sci, res.ptr, shortest, out.exp);
+        // у субнормальных чисел точность меньше 15 знаков, и оценки выше не работают
+        if (ax != 0.0 && ax < std::numeric_limits<double>::min())
+            n = 0;
+        if (n > 0 && n <= int(kMaxNumberLen))
         {
-            double x = A(0);
-            if (x < -1.0 || x > 1.0)
-                throw CalcError("Аргумент asin вне диапазона [-1,1]");
-            return asin(x);
+            std::memcpy(out.d, shortest, size_t(n));
+            std::memset(out.d + n, '0', kMaxNumberLen - size_t(n));
+            return out;
         }
-        if (f == "acos")
+        int tail = n > 0 ? (shortest[15] - '0') * 10 + (n > 16 ? shortest[16] - '0' : 0) : 50;
+        if (std::abs(tail - 50) > 2)
         {
-            double x = A(0);
-            if (x < -1.0 || x > 1.0)
-                throw CalcError("Аргумент acos вне диапазона [-1,1]");
-            return acos(x);
+            std::memcpy(out.d, shortest, kMaxNumberLen);
+            if (tail > 50)
+                increment(out, int(kMaxNumberLen));
+            return out;
         }
-        if (f == "atan")
-            return atan(A(0));
-        if (f == "sqrt")
+        res = std::to_chars(sci, sci + sizeof(sci), ax, std::chars_format::scientific, int(kMaxNumberLen) - 1);
+        parse_scientific(sci, res.ptr, out.d, out.exp);
+        return out;
+    }
+
+    // Запись как у printf("%.*g", p) — без завершающих нулей; при длине
+    // больше kMaxNumberLen ничего не пишет и возвращает 0
+    size_t write_general(bool negative, const Digits &g, int p, char *buf)
+    {
+        const int k = g.count, x = g.exp;
+        const bool fixed = x >= -4 && x < p;
+        size_t len = negative;
+        if (fixed && x >= 0)
+            len += size_t(x + 1) + (k > x + 1 ? size_t(k - x) : 0);
+        else if (fixed)
+            len += size_t(1 - x + k); // "0." + нули + цифры
+        else
+            len += (k > 1 ? size_t(k + 1) : 1) + (std::abs(x) >= 100 ? 5 : 4);
+        if (len > kMaxNumberLen)
+            return 0;
+
+        char *o = buf;
+        if (negative)
+            *o++ = '-';
+        if (fixed && x >= 0)
         {
-            double x = A(0);
-            if (x < 0)
-                throw CalcError("Корень из отрицательного числа не определён");
-            return sqrt(x);
+            for (int i = 0; i <= x; ++i)
+                *o++ = i < k ? g.d[i] : '0';
+            if (k > x + 1)
+            {
+                *o++ = '.';
+                for (int i = x + 1; i < k; ++i)
+                    *o++ = g.d[i];
+            }
         }
-        if (f == "ln")
+        else if (fixed)
         {
-            double x = A(0);
-            if (x <= 0)
-                throw CalcError("Натуральный логарифм определён только для положительных значений");
-            return log(x);
+            *o++ = '0';
+            *o++ = '.';
+            for (int i = 0; i < -x - 1; ++i)
+                *o++ = '0';
+            for (int i = 0; i < k; ++i)
+                *o++ = g.d[i];
         }
-        if (f == "lg")
+        else
         {
-            double x = A(0);
-            if (x <= 0)
-                throw CalcError("Десятичный логарифм определён только для положительных значений");
-            return log10(x);
+            *o++ = g.d[0];
+            if (k > 1)
+            {
+                *o++ = '.';
+                for (int i = 1; i < k; ++i)
+                    *o++ = g.d[i];
+            }
+            int ax = std::abs(x);
+            *o++ = 'e';
+            *o++ = x < 0 ? '-' : '+';
+            if (ax >= 100)
+                *o++ = char('0' + ax / 100);
+            *o++ = char('0' + ax / 10 % 10);
+            *o++ = char('0' + ax % 10);
         }
-        if (f == "abs")
-            return fabs(A(0));
-        if (f == "pow")
-            return pow(A(0), A(1));
-        if (f == "root")
+        return size_t(o - buf);
+    }
+} // namespace
+
+// Десятичные цифры строятся один раз (decimal_digits), меньшие точности
+// получаются округлением этих цифр. Научная запись с
+// подбором точности не нужна: при точности 1 запись %g не длиннее
+// 7 символов ("-1e+308", "-0.0001").
+size_t format_number(double x, char *buf)
+{
+    const Digits all = decimal_digits(std::fabs(x));
+    const bool negative = std::signbit(x);
+    for (int p = int(kMaxNumberLen); p >= 1; --p)
+    {
+        Digits g;
+        if (round_digits(all, p, g))
         {
-            double x = A(0), n = A(1);
-            if (n == 0.0)
-                throw CalcError("Степень корня не может быть нулём");
-            if (x < 0 && fmod(n, 2.0) == 0.0)
-                throw CalcError("Чётный корень из отрицательного числа не определён");
-            return pow(x, 1.0 / n);
+            if (size_t len = write_general(negative, g, p, buf))
+                return len;
+            continue;
         }
-        if (f == "log")
+        // Редкий случай ничьей: точное округление делает to_chars
+        char tmp[32];
+        auto exact = std::to_chars(tmp, tmp + sizeof(tmp), x, std::chars_format::general, p);
+        size_t len = size_t(exact.ptr - tmp);
+        if (len <= kMaxNumberLen)
         {
-            double x = A(0), base = A(1);
-            if (x <= 0)
-                throw CalcError("Логарифм определён только для положительных значений");
-            if (base <= 0 || base == 1.0)
-                throw CalcError("Основание логарифма должно быть положительным и не равно 1");
-            return log(x) / log(base);
+            std::memcpy(buf, tmp, len);
+            return len;
         }
-        throw CalcError("Неизвестная функция: " + f);
-    }
     }
-    throw CalcError("Внутренняя ошибка AST");
+    throw CalcError("Невозможно вывести число в 15 символов");
 }
 
-
-static string format_number(double x)
+string format_number(double x)
 {
     if (std::isnan(x))
         throw CalcError("Результат не является числом");
     if (std::isinf(x))
         throw CalcError("Результат слишком велик по модулю");
+    char buf[kMaxNumberLen];
+    return string(buf, format_number(x, buf));
+}
 
-    for (int prec = 15; prec >= 1; --prec)
+// Обход идёт по массиву узлов: в пост-порядке дети вычисляются раньше
+// родителя и в том же порядке, что и при рекурсивном обходе, а общий узел
+// DAG (см. share_subexpressions) — ровно один раз. Первая ошибка области
+// определения запоминается в error, а вычисление продолжается над NaN: так
+// ошибка стоит не дороже обычной ветки, а результат всё равно отбрасывается
+double evaluate(const Ast &ast, const double *vars, EvalError &error)
+{
+    static constexpr size_t kLocalNodes = 256;
+    double local[kLocalNodes];
+    std::vector<double> heap;
+    double *value = local;
+    if (ast.nodes.size() > kLocalNodes)
     {
-        std::ostringstream oss;
-        oss.setf(std::ios::fmtflags(0), std::ios::floatfield);
-        oss.precision(prec);
-        oss << x;
-        string s = trim_trailing_zeros(oss.str());
-        if ((int)s.size() <= kMaxOutputLen)
-            return s;
+        heap.resize(ast.nodes.size());
+        value = heap.data();
     }
-    for (int prec = 15; prec >= 1; --prec)
+
+    for (uint32_t i = 0; i < ast.nodes.size(); ++i)
     {
-        std::ostringstream oss;
-        oss.setf(std::ios::scientific, std::ios::floatfield);
-        oss.precision(prec);
-        oss << x;
-        string s = trim_trailing_zeros(oss.str());
-        if ((int)s.size() <= kMaxOutputLen)
-            return s;
+        const AstNode &n = ast[i];
+        if (n.op == NodeOp::VAR)
+        {
+            value[i] = vars[n.id];
+            continue;
+        }
+        uint32_t kids = kid_count(n);
+        double a = kids > 0 ? value[n.kids[0]] : 0.0;
+        double b = kids > 1 ? value[n.kids[1]] : 0.0;
+        ErrorCode code;
+        value[i] = apply_node(n, a, b, code);
+        if (code != ErrorCode::OK && error.code == CalcErrc::OK)
+            error = EvalError{CalcErrc::DOMAIN, code, n.pos, 0};
     }
-    throw CalcError("Невозможно вывести число в 15 символов");
+    return value[ast.root()];
+}
+
+double evaluate(const Ast &ast, const double *vars)
+{
+    EvalError error;
+    double v = evaluate(ast, vars, error);
+    if (error.code != CalcErrc::OK)
+        throw CalcError(error_message(error.domain));
+    return v;
 }
 
-string executing(const std::shared_ptr<Node> &ast)
+string executing(const Ast &ast)
 {
-    double v = eval(ast);
+    double v = evaluate(ast);
     return format_number(v);
 }
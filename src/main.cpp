@@ -12,6 +12,13 @@
 #include "core/localization.hpp"
 
 #include "calc.hpp"
+#include "cli/batch_mode.hpp"
+#include "cli/column_mode.hpp"
+#include "cli/csv_mode.hpp"
+#include "cli/options.hpp"
+#include "cli/server.hpp"
+#include "cli/shm_transport.hpp"
+#include "engine/expr_cache.hpp"
 
 // double eval_func(const std::string &expr)
 // {
@@ -42,9 +49,115 @@
 //     return result;
 // }
 
-int main()
+namespace
 {
+    EvalServer *g_server = nullptr;
+    ShmServer *g_shm_server = nullptr;
+
+    void stop_server(int)
+    {
+        if (g_server)
+            g_server->stop();
+        if (g_shm_server)
+            g_shm_server->stop();
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    CliOptions options;
+    try
+    {
+        options = parse_cli(argc, argv);
+    }
+    catch (const CliError &e)
+    {
+        std::cerr << "fast_calc: " << e.what() << '\n';
+        return 2;
+    }
+    apply_engine_options(options);
+    if (options.simd_info)
+    {
+        std::cout << simd_report() << '\n';
+        return 0;
+    }
+
     ConfigManager config("fast_calc");
+    config.load();
+    expr_cache().set_budget(config.get_engine_cache_mb() << 20);
+    if (options.batch)
+    {
+        ThreadPool pool(options.threads ? options.threads : config.get_engine_threads());
+        try
+        {
+            run_batch_stream(stdin, stdout, pool);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "fast_calc: " << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    if (!options.serve.empty())
+    {
+        try
+        {
+            EvalServer server(options.serve);
+            g_server = &server;
+            std::signal(SIGINT, stop_server);
+            std::signal(SIGTERM, stop_server);
+            server.run();
+            g_server = nullptr;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "fast_calc: " << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    if (!options.shm.empty())
+    {
+        try
+        {
+            ShmServer server(options.shm);
+            g_shm_server = &server;
+            std::signal(SIGINT, stop_server);
+            std::signal(SIGTERM, stop_server);
+            server.run();
+            g_shm_server = nullptr;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "fast_calc: " << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    if (!options.csv.empty() || !options.columns.empty())
+    {
+        ThreadPool pool(options.threads ? options.threads : config.get_engine_threads());
+        try
+        {
+            auto report = [](const auto &stats)
+            {
+                if (stats.failed)
+                    std::cerr << "fast_calc: строк с ошибкой: " << stats.failed << " из " << stats.rows << '\n';
+            };
+            if (!options.csv.empty())
+                report(run_csv_file(options.csv, options.expr, options.out, pool));
+            else
+                report(run_column_file(options.columns, options.expr, options.out, pool));
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "fast_calc: " << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+
     LocalizationManager localization("lang");
     HistoryManager manager;
     MainScreen app(eval_func, config, localization, manager);
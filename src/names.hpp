@@ -0,0 +1,146 @@
+// src/names.hpp
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Встроенные функции и константы. Имена разрешаются в идентификаторы один
+// раз, в лексере; дальше ни одна стадия не сравнивает строки.
+
+enum class FuncId : uint8_t
+{
+    SIN,
+    COS,
+    TAN,
+    ASIN,
+    ACOS,
+    ATAN,
+    SQRT,
+    LN,
+    LG,
+    ABS,
+    POW,
+    ROOT,
+    LOG,
+    COUNT
+};
+
+enum class ConstId : uint8_t
+{
+    PI,
+    E,
+    PHI,
+    COUNT
+};
+
+struct FuncInfo
+{
+    std::string_view name;
+    uint8_t arity;
+};
+
+inline constexpr FuncInfo kFuncs[] = {
+    {"sin", 1}, {"cos", 1}, {"tan", 1}, {"asin", 1}, {"acos", 1}, {"atan", 1}, {"sqrt", 1},
+    {"ln", 1}, {"lg", 1}, {"abs", 1}, {"pow", 2}, {"root", 2}, {"log", 2}};
+static_assert(sizeof(kFuncs) / sizeof(kFuncs[0]) == size_t(FuncId::COUNT), "таблица функций не соответствует FuncId");
+
+inline constexpr std::string_view kConsts[] = {"pi", "e", "phi"};
+static_assert(sizeof(kConsts) / sizeof(kConsts[0]) == size_t(ConstId::COUNT), "таблица констант не соответствует ConstId");
+
+constexpr const FuncInfo &func_info(FuncId f) { return kFuncs[size_t(f)]; }
+constexpr std::string_view const_name(ConstId c) { return kConsts[size_t(c)]; }
+
+enum class NameKind : uint8_t
+{
+    NONE, // не встроенное имя: переменная или ошибка
+    FUNC,
+    CONST
+};
+
+struct NameRef
+{
+    NameKind kind = NameKind::NONE;
+    uint8_t id = 0; // FuncId или ConstId
+};
+
+namespace names_detail
+{
+    // Совершенный хэш: таблица и затравка строятся при компиляции, поиск —
+    // одно вычисление хэша по длине и трём символам и одно сравнение строк
+    constexpr size_t kSlotBits = 6;
+    constexpr size_t kSlots = size_t(1) << kSlotBits;
+
+    constexpr uint32_t hash(std::string_view s, uint32_t seed)
+    {
+        uint32_t h = seed;
+        const uint32_t parts[] = {uint32_t(s.size()), uint8_t(s[0]), uint8_t(s[s.size() > 1 ? 1 : 0]),
+                                  uint8_t(s[s.size() - 1])};
+        for (uint32_t c : parts)
+            h = (h ^ c) * 0x01000193u;
+        return h >> (32 - kSlotBits);
+    }
+
+    struct Slot
+    {
+        std::string_view name;
+        NameRef ref;
+    };
+
+    constexpr bool place(std::array<Slot, kSlots> &slots, std::string_view name, NameRef ref, uint32_t seed)
+    {
+        Slot &slot = slots[hash(name, seed)];
+        if (!slot.name.empty())
+            return false;
+        slot = Slot{name, ref};
+        return true;
+    }
+
+    // Таблица для затравки seed; ok = false при коллизии
+    constexpr std::array<Slot, kSlots> build(uint32_t seed, bool &ok)
+    {
+        std::array<Slot, kSlots> slots{};
+        ok = true;
+        for (size_t k = 0; k < size_t(FuncId::COUNT); ++k)
+            ok = ok && place(slots, kFuncs[k].name, NameRef{NameKind::FUNC, uint8_t(k)}, seed);
+        for (size_t k = 0; k < size_t(ConstId::COUNT); ++k)
+            ok = ok && place(slots, kConsts[k], NameRef{NameKind::CONST, uint8_t(k)}, seed);
+        return slots;
+    }
+
+    constexpr uint32_t find_seed()
+    {
+        for (uint32_t seed = 0x811c9dc5u;; ++seed)
+        {
+            bool ok = false;
+            build(seed, ok);
+            if (ok)
+                return seed;
+        }
+    }
+
+    constexpr uint32_t kSeed = find_seed();
+
+    constexpr std::array<Slot, kSlots> table()
+    {
+        bool ok = false;
+        return build(kSeed, ok);
+    }
+
+    inline constexpr std::array<Slot, kSlots> kTable = table();
+} // namespace names_detail
+
+// Встроенная функция или константа по имени
+constexpr NameRef lookup_name(std::string_view name)
+{
+    if (name.empty())
+        return NameRef{};
+    const names_detail::Slot &slot = names_detail::kTable[names_detail::hash(name, names_detail::kSeed)];
+    return slot.name == name ? slot.ref : NameRef{};
+}
+
+static_assert(lookup_name("atan").kind == NameKind::FUNC && lookup_name("atan").id == uint8_t(FuncId::ATAN),
+              "совершенный хэш имён построен неверно");
+static_assert(lookup_name("e").kind == NameKind::CONST && lookup_name("x").kind == NameKind::NONE,
+              "совершенный хэш имён построен неверно");
@@ -1,37 +1,48 @@
 // src/token.cpp
 // Выполняет Смирнов Даниил
-#include <vector>
-#include <stdexcept>
+#include <cctype>
+#include <charconv>
 #include <cmath>
 
 #include "token.hpp"
 
 using std::string;
-using std::vector;
 
 static constexpr size_t kMaxInputLen = 128;
 
-static string removing_spaces(const string &s)
+std::string_view removing_spaces(std::string_view s, Arena &arena)
 {
-    string out;
-    out.reserve(s.size());
+    char *out = arena.allocate_array<char>(s.size());
+    size_t n = 0;
     for (char c : s)
     {
         if (!isspace((unsigned char)c))
-            out.push_back(c);
+            out[n++] = c;
     }
-    if (out.size() > kMaxInputLen)
-        throw std::runtime_error("Длина выражения превышает 128 символов");
-
-    return out;
+    return std::string_view(out, n);
 }
 
-vector<Token> lexing(const string &input)
+bool lexing(std::string_view s, Arena &arena, ArenaSpan<const Token> &tokens, EvalError &error)
 {
-    string s = removing_spaces(input);
-
-    vector<Token> out;
-    out.reserve(s.size());
+    auto fail = [&](CalcErrc code, size_t pos, size_t length = 0)
+    {
+        error.code = code;
+        error.position = uint32_t(pos);
+        error.length = uint32_t(length);
+        return false;
+    };
+
+    if (s.size() > kMaxInputLen)
+        return fail(CalcErrc::TOO_LONG, 0);
+
+    // токенов не больше, чем символов
+    Token *out = arena.allocate_array<Token>(s.size());
+    size_t count = 0;
+    auto push = [&](const Token &token, size_t pos)
+    {
+        new (out + count) Token(token);
+        out[count++].pos = uint32_t(pos);
+    };
 
     for (size_t i = 0; i < s.size();)
     {
@@ -48,7 +59,7 @@ vector<Token> lexing(const string &input)
                 ++i;
                 // точка не должна быть последним символом и должна быть за ней цифра
                 if (i == s.size() || !isdigit((unsigned char)s[i]))
-                    throw CalcError("Неверный формат числа");
+                    return fail(CalcErrc::BAD_NUMBER, start);
             }
 
             while (i < s.size() && isdigit((unsigned char)s[i]))
@@ -57,17 +68,19 @@ vector<Token> lexing(const string &input)
             if (i < s.size() && s[i] == '.')
             {
                 if (dot)
-                    throw CalcError("Двойная точка в числе");
+                    return fail(CalcErrc::DOUBLE_DOT, i);
                 dot = true;
                 ++i;
                 if (i == s.size() || !isdigit((unsigned char)s[i]))
-                    throw CalcError("Неверный формат числа");
+                    return fail(CalcErrc::BAD_NUMBER, start);
                 while (i < s.size() && isdigit((unsigned char)s[i]))
                     ++i;
             }
 
-            double val;
-            val = stod(s.substr(start, i - start));
+            // from_chars не зависит от локали и не выделяет память;
+            // формат литерала уже проверен выше
+            double val = 0.0;
+            std::from_chars(s.data() + start, s.data() + i, val);
             // Апостроф после числа -> градусы в радианы
             if (i < s.size() && s[i] == '\'')
             {
@@ -75,30 +88,29 @@ vector<Token> lexing(const string &input)
                 ++i;
             }
 
-            out.push_back(Token::number(val));
+            push(Token::number(val, s.substr(start, i - start)), start);
             continue;
         }
 
         if (isalpha((unsigned char)c))
         {
             if (!isLowerAlpha(c))
-            {
-                throw CalcError("Разрешены только строчные латинские буквы в именах функций и констант");
-            }
+                return fail(CalcErrc::UPPERCASE, i);
 
-            // идентификатор (имя функции или константы)
+            // имя функции, константы или переменной; встроенные имена
+            // разрешаются в идентификатор здесь, один раз
             size_t j = i + 1;
             while (j < s.size() && (isLowerAlpha(s[j]) || isdigit((unsigned char)s[j])))
                 ++j;
-            string id = s.substr(i, j - i);
-            out.push_back(Token::ident(id));
+            std::string_view name = s.substr(i, j - i);
+            push(Token::name(name, lookup_name(name)), i);
             i = j;
             continue;
         }
 
-        auto make_single = [&](auto token)
+        auto make_single = [&](const Token &token)
         {
-            out.push_back(std::move(token));
+            push(token, i);
             ++i;
         };
 
@@ -109,7 +121,7 @@ vector<Token> lexing(const string &input)
         case '*':
         case '/':
         case '^':
-            make_single(Token::op(string(1, c)));
+            make_single(Token::op(s.substr(i, 1)));
             break;
         case '!':
             make_single(Token::fact());
@@ -127,10 +139,19 @@ vector<Token> lexing(const string &input)
             make_single(Token::bar());
             break;
         default:
-        {
-            throw CalcError(string("Недопустимый символ: ") + c);
-        }
+            return fail(CalcErrc::BAD_CHAR, i, 1);
         }
     }
-    return out;
-}
\ No newline at end of file
+    tokens = ArenaSpan<const Token>{out, count};
+    return true;
+}
+
+ArenaSpan<const Token> lexing(const string &input, Arena &arena)
+{
+    std::string_view s = removing_spaces(input, arena);
+    ArenaSpan<const Token> tokens{nullptr, 0};
+    EvalError error;
+    if (!lexing(s, arena, tokens, error))
+        throw CalcError(error_message(error, s.substr(error.position, error.length)));
+    return tokens;
+}
@@ -1,14 +1,20 @@
 // src/token.hpp
 #pragma once
 
+#include <string_view>
+
 #include "calc.hpp"
+#include "names.hpp"
+#include "engine/arena.hpp"
 
-enum class TokType
+enum class TokType : uint8_t
 {
     NUMBER, // любое число
-    IDENT, // имя функции/константы (строго нижний регистр)
-    OP,    // "+ - * / ^"
-    FACT,  // "!"
+    FUNC,   // встроенная функция, id — FuncId
+    CONST,  // встроенная константа, id — ConstId
+    IDENT,  // прочее имя (переменная; строго нижний регистр)
+    OP,     // "+ - * / ^"
+    FACT,   // "!"
     LPAREN,
     RPAREN,
     COMMA,
@@ -18,18 +24,27 @@ enum class TokType
 struct Token
 {
     TokType type;
-    std::string text;    // для OP/IDENT
-    double value{}; // для NUMBER
+    uint8_t id = 0;        // для FUNC и CONST
+    uint32_t pos = 0;      // смещение в выражении без пробелов
+    std::string_view text; // участок выражения без пробелов, включая литерал числа (память арены разбора)
+    double value{};        // для NUMBER
 
-    static Token number(double v)
+    static Token number(double v, std::string_view literal)
     {
-        Token t{TokType::NUMBER};
+        Token t{TokType::NUMBER, literal};
         t.value = v;
-        t.text = std::to_string(v);
         return t;
     }
-    static Token ident(const std::string &s) { return Token{TokType::IDENT, s}; }
-    static Token op(const std::string &s) { return Token{TokType::OP, s}; }
+    static Token ident(std::string_view s) { return Token{TokType::IDENT, s}; }
+    static Token name(std::string_view s, NameRef ref)
+    {
+        if (ref.kind == NameKind::NONE)
+            return ident(s);
+        Token t{ref.kind == NameKind::FUNC ? TokType::FUNC : TokType::CONST, s};
+        t.id = ref.id;
+        return t;
+    }
+    static Token op(std::string_view s) { return Token{TokType::OP, s}; }
     static Token fact() { return Token{TokType::FACT, "!"}; }
     static Token lparen() { return Token{TokType::LPAREN, "("}; }
     static Token rparen() { return Token{TokType::RPAREN, ")"}; }
@@ -37,7 +52,14 @@ struct Token
     static Token bar() { return Token{TokType::BAR, "|"}; }
 
 private:
-    Token(TokType tt, std::string s = "", double v = 0.0) : type(tt), text(std::move(s)), value(v) {}
+    Token(TokType tt, std::string_view s = {}, double v = 0.0) : type(tt), text(s), value(v) {}
 };
 
-std::vector<Token> lexing(const std::string &input_raw);
\ No newline at end of file
+// Выражение без пробельных символов; память принадлежит арене
+std::string_view removing_spaces(std::string_view input, Arena &arena);
+
+// Бросает CalcError
+ArenaSpan<const Token> lexing(const std::string &input_raw, Arena &arena);
+// То же без исключений для строки text без пробелов (см. removing_spaces):
+// при ошибке возвращает false и заполняет error
+bool lexing(std::string_view text, Arena &arena, ArenaSpan<const Token> &tokens, EvalError &error);
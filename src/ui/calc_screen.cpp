@@ -1,8 +1,9 @@
 #include "calc_screen.hpp"
+#include "../calc.hpp"
 
 void Calc::add_result(const string& expr, double result) {
     ostringstream ss;
-    ss << expr << " = " << result;
+    ss << expr << " = " << format_number(result);
     manager_.add_entry(ss.str());
     history.push_back(ss.str());
 }
@@ -0,0 +1,104 @@
+#include "../src/engine/batch.hpp"
+#include "../src/engine/compiled_expr.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    bool SameBits(double a, double b)
+    {
+        return std::memcmp(&a, &b, sizeof(double)) == 0 || (std::isnan(a) && std::isnan(b));
+    }
+
+    // Сравнивает пакетное вычисление с построчным CompiledExpr
+    void CheckAgainstScalar(const std::string &expr, const std::vector<std::string> &vars,
+                            const std::vector<std::vector<double>> &columns, size_t rows)
+    {
+        CompiledExpr compiled(expr, vars);
+        BatchEvaluator batch(compiled.program());
+
+        std::vector<const double *> ptrs;
+        for (const auto &c : columns)
+            ptrs.push_back(c.data());
+        std::vector<double> out(rows);
+        std::vector<uint64_t> mask(error_mask_words(rows));
+        std::vector<ErrorCode> codes(rows);
+        size_t failed = batch.evaluate(ptrs.data(), rows, out.data(), mask.data(), codes.data());
+
+        size_t expected_failed = 0;
+        std::vector<double> row(vars.size());
+        for (size_t r = 0; r < rows; ++r)
+        {
+            for (size_t v = 0; v < vars.size(); ++v)
+                row[v] = columns[v][r];
+            double value = 0.0;
+            ErrorCode err = compiled.try_evaluate(row.data(), value);
+            INFO(expr << " row " << r);
+            REQUIRE(codes[r] == err);
+            REQUIRE(row_failed(mask.data(), r) == (err != ErrorCode::OK));
+            if (err == ErrorCode::OK)
+                REQUIRE(SameBits(out[r], value));
+            else
+            {
+                REQUIRE(std::isnan(out[r]));
+                ++expected_failed;
+            }
+        }
+        REQUIRE(failed == expected_failed);
+    }
+} // namespace
+
+TEST_CASE("Batch evaluation matches scalar evaluation", "[batch]")
+{
+    const size_t rows = kBatchBlock * 2 + 123;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(-3.0, 3.0);
+    std::vector<std::vector<double>> cols(2, std::vector<double>(rows));
+    for (auto &c : cols)
+        for (double &v : c)
+            v = dist(rng);
+    // точные нули, чтобы сработали проверки деления и логарифма
+    for (size_t r = 0; r < rows; r += 17)
+        cols[1][r] = 0.0;
+
+    const char *const exprs[] = {
+        "x+y", "x*y-x/2", "2*3+x", "sqrt(x^2+y^2)", "x/y", "ln(y)+lg(x)", "asin(x)+acos(y)",
+        "sin(x)*cos(y)-tan(x)", "atan(x)+|y|", "pow(x,y)", "root(x,2)+root(y,3)", "log(x,y)",
+        "(x*3)!", "x^y", "-x+(+y)", "pi*e-phi", "5!/y"};
+    for (const char *expr : exprs)
+        CheckAgainstScalar(expr, {"x", "y"}, cols, rows);
+}
+
+TEST_CASE("Batch evaluation of a constant expression fills every row", "[batch]")
+{
+    CompiledExpr compiled("2^10");
+    BatchEvaluator batch(compiled.program());
+    std::vector<double> out(100);
+    std::vector<uint64_t> mask(error_mask_words(out.size()), ~0ull);
+    REQUIRE(batch.evaluate(nullptr, out.size(), out.data(), mask.data()) == 0);
+    for (double v : out)
+        REQUIRE(v == 1024.0);
+    REQUIRE(mask[0] == 0);
+    REQUIRE(mask[1] == 0);
+}
+
+TEST_CASE("Batch evaluation keeps going after domain errors", "[batch]")
+{
+    CompiledExpr compiled("1/x", {"x"});
+    BatchEvaluator batch(compiled.program());
+    std::vector<double> x = {1.0, 0.0, 2.0, 0.0, 4.0};
+    const double *cols[] = {x.data()};
+    std::vector<double> out(x.size());
+    uint64_t mask = 0;
+    REQUIRE(batch.evaluate(cols, x.size(), out.data(), &mask) == 2);
+    REQUIRE(mask == 0b01010);
+    REQUIRE(out[0] == 1.0);
+    REQUIRE(out[2] == 0.5);
+    REQUIRE(out[4] == 0.25);
+}
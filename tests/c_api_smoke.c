@@ -0,0 +1,21 @@
+/* tests/c_api_smoke.c — заголовок fast_calc.h собирается компилятором C */
+#include "fast_calc.h"
+
+#include <stdio.h>
+
+int main(void)
+{
+    const char *vars[] = {"x"};
+    char error[128];
+    fast_calc_expr *e = fast_calc_compile("x*2+1", vars, 1, 0, error, sizeof(error));
+    if (!e)
+    {
+        fprintf(stderr, "%s\n", error);
+        return 1;
+    }
+    double x = 20.0;
+    double result = 0.0;
+    int status = fast_calc_eval(e, &x, &result);
+    fast_calc_free(e);
+    return status == FAST_CALC_OK && result == 41.0 ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include "fast_calc.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+TEST_CASE("C API compiles and evaluates an expression", "[c_api]")
+{
+    REQUIRE(fast_calc_abi_version() == FAST_CALC_ABI_VERSION);
+
+    const char *vars[] = {"x", "y"};
+    fast_calc_expr *e = fast_calc_compile("sqrt(x^2+y^2)", vars, 2, 0, nullptr, 0);
+    REQUIRE(e != nullptr);
+    REQUIRE(fast_calc_var_count(e) == 2);
+
+    double values[] = {3.0, 4.0};
+    double result = 0.0;
+    REQUIRE(fast_calc_eval(e, values, &result) == FAST_CALC_OK);
+    REQUIRE(result == 5.0);
+    fast_calc_free(e);
+}
+
+TEST_CASE("C API reports domain errors as status codes", "[c_api]")
+{
+    const char *vars[] = {"x"};
+    fast_calc_expr *e = fast_calc_compile("1/x", vars, 1, FAST_CALC_FLAG_JIT, nullptr, 0);
+    REQUIRE(e != nullptr);
+
+    double zero = 0.0;
+    double result = 0.0;
+    REQUIRE(fast_calc_eval(e, &zero, &result) == FAST_CALC_DIV_ZERO);
+    REQUIRE(std::isnan(result));
+    REQUIRE(std::strlen(fast_calc_error_message(FAST_CALC_DIV_ZERO)) > 0);
+    fast_calc_free(e);
+}
+
+TEST_CASE("C API returns parse errors as text", "[c_api]")
+{
+    char error[256] = {};
+    REQUIRE(fast_calc_compile("2+", nullptr, 0, 0, error, sizeof(error)) == nullptr);
+    REQUIRE(std::strlen(error) > 0);
+
+    // Короткий буфер: текст обрезается, но остаётся строкой с нулём
+    char small[5];
+    std::memset(small, 'z', sizeof(small));
+    REQUIRE(fast_calc_compile("2+", nullptr, 0, 0, small, sizeof(small)) == nullptr);
+    REQUIRE(std::memchr(small, '\0', sizeof(small)) != nullptr);
+
+    REQUIRE(fast_calc_compile(nullptr, nullptr, 0, 0, nullptr, 0) == nullptr);
+}
+
+TEST_CASE("C API rejects invalid arguments", "[c_api]")
+{
+    double result = 0.0;
+    REQUIRE(fast_calc_eval(nullptr, nullptr, &result) == FAST_CALC_INVALID);
+
+    const char *vars[] = {"x"};
+    fast_calc_expr *e = fast_calc_compile("x+1", vars, 1, 0, nullptr, 0);
+    REQUIRE(fast_calc_eval(e, nullptr, &result) == FAST_CALC_INVALID);
+    fast_calc_free(e);
+    fast_calc_free(nullptr);
+}
+
+TEST_CASE("C API batch evaluation matches scalar evaluation", "[c_api]")
+{
+    const char *vars[] = {"x"};
+    fast_calc_expr *e = fast_calc_compile("ln(x)*2", vars, 1, 0, nullptr, 0);
+    REQUIRE(e != nullptr);
+
+    const size_t rows = 100000;
+    std::vector<double> x(rows);
+    for (size_t i = 0; i < rows; ++i)
+        x[i] = double(i % 7) - 1.0;
+    const double *columns[] = {x.data()};
+    std::vector<double> out(rows);
+    std::vector<uint8_t> status(rows);
+
+    size_t failed = fast_calc_eval_batch(e, columns, rows, out.data(), status.data());
+    size_t expected_failed = 0;
+    for (size_t i = 0; i < rows; ++i)
+    {
+        double scalar = 0.0;
+        int code = fast_calc_eval(e, &x[i], &scalar);
+        REQUIRE(status[i] == code);
+        if (code == FAST_CALC_OK)
+            REQUIRE(out[i] == scalar);
+        else
+        {
+            REQUIRE(code == FAST_CALC_LN_DOMAIN);
+            REQUIRE(std::isnan(out[i]));
+            ++expected_failed;
+        }
+    }
+    REQUIRE(failed == expected_failed);
+    REQUIRE(fast_calc_eval_batch(e, columns, rows, out.data(), nullptr) == expected_failed);
+    fast_calc_free(e);
+}
@@ -0,0 +1,297 @@
+#include "../src/AST.hpp"
+#include "../src/calc.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static bool Throws(const std::string &expr)
+{
+    try
+    {
+        eval_func(expr);
+    }
+    catch (const std::exception &)
+    {
+        return true;
+    }
+    return false;
+}
+
+TEST_CASE("eval_func computes basic arithmetic", "[calc]")
+{
+    REQUIRE(eval_func("2+3*4") == 14.0);
+    REQUIRE(eval_func("(2+3)*4") == 20.0);
+    REQUIRE(eval_func("2^3^2") == 512.0);
+    REQUIRE(eval_func("-2^2") == 4.0); // унарный минус связывает сильнее степени
+    REQUIRE(eval_func("5!") == 120.0);
+    REQUIRE(eval_func("|5-8|") == 3.0);
+    REQUIRE(eval_func(" 1 + 2 ") == 3.0);
+}
+
+TEST_CASE("eval_func returns the value without display rounding", "[calc]")
+{
+    REQUIRE(eval_func("0.1+0.2") == 0.1 + 0.2);
+    REQUIRE(eval_func("1/3") == 1.0 / 3.0);
+    REQUIRE(eval_func("2^0.5") == std::sqrt(2.0));
+    REQUIRE(format_number(eval_func("1/3")) == "0.3333333333333");
+}
+
+TEST_CASE("eval_func handles functions and constants", "[calc]")
+{
+    REQUIRE(eval_func("sin(90')") == 1.0);
+    REQUIRE(eval_func("cos(180')") == -1.0);
+    REQUIRE(eval_func("abs(-5)+sqrt(9)") == 8.0);
+    REQUIRE(eval_func("log(8,2)") == 3.0);
+    REQUIRE(eval_func("pow(2,10)") == 1024.0);
+    REQUIRE(std::fabs(eval_func("pi") - 3.14159265358979) < 1e-12);
+    REQUIRE(std::fabs(eval_func("phi") - 1.61803398874989) < 1e-12);
+}
+
+TEST_CASE("eval_func reports syntax and domain errors", "[calc]")
+{
+    REQUIRE(Throws("1/0"));
+    REQUIRE(Throws("0^0"));
+    REQUIRE(Throws("(-1)!"));
+    REQUIRE(Throws("2.5!"));
+    REQUIRE(Throws("171!"));
+    REQUIRE(Throws("asin(2)"));
+    REQUIRE(Throws("sqrt(-1)"));
+    REQUIRE(Throws("ln(0)"));
+    REQUIRE(Throws("log(8,1)"));
+    REQUIRE(Throws("root(-8,2)"));
+    REQUIRE(Throws("sin(1,2)"));
+    REQUIRE(Throws("foo(1)"));
+    REQUIRE(Throws("(1+2"));
+    REQUIRE(Throws("1+"));
+    REQUIRE(Throws("Sin(1)"));
+    REQUIRE(Throws("1..2"));
+    REQUIRE(Throws(std::string(129, '1')));
+}
+
+TEST_CASE("try_eval_func reports errors without exceptions", "[calc]")
+{
+    EvalResult ok = try_eval_func("2+3*4");
+    REQUIRE(ok);
+    REQUIRE(ok.value == 14.0);
+
+    EvalResult div = try_eval_func("1 + 2/(3-3)");
+    REQUIRE(!div);
+    REQUIRE(div.error.code == CalcErrc::DOMAIN);
+    REQUIRE(div.error.domain == ErrorCode::DIV_ZERO);
+    REQUIRE(div.error.position == 5); // '/' в исходной строке с пробелами
+    REQUIRE(std::isnan(div.value));
+    REQUIRE(error_message(div, "1 + 2/(3-3)") == "Деление на ноль");
+
+    // первая ошибка в порядке вычисления, как у исключений
+    EvalResult first = try_eval_func("sqrt(-1)+ln(0)");
+    REQUIRE(first.error.domain == ErrorCode::SQRT_NEGATIVE);
+    REQUIRE(first.error.position == 0);
+
+    const std::string unknown = "2 * fo o(1)";
+    EvalResult name = try_eval_func(unknown);
+    REQUIRE(name.error.code == CalcErrc::UNKNOWN_NAME);
+    REQUIRE(name.error.position == 4);
+    REQUIRE(error_message(name, unknown) == "Неизвестная функция или константа: foo");
+
+    EvalResult arity = try_eval_func("sin(1,2)");
+    REQUIRE(arity.error.code == CalcErrc::ARITY_ONE);
+    REQUIRE(error_message(arity, "sin(1,2)") == "Функция sin требует ровно 1 аргумент");
+
+    EvalResult end = try_eval_func("1+");
+    REQUIRE(end.error.code == CalcErrc::EXPECTED_EXPR);
+    REQUIRE(end.error.position == 2);
+
+    REQUIRE(try_eval_func("1..2").error.code == CalcErrc::BAD_NUMBER);
+    REQUIRE(try_eval_func(".5.3").error.code == CalcErrc::DOUBLE_DOT);
+    REQUIRE(try_eval_func("Sin(1)").error.code == CalcErrc::UPPERCASE);
+    REQUIRE(try_eval_func("(1+2").error.code == CalcErrc::UNBALANCED);
+    REQUIRE(try_eval_func("|1+2").error.code == CalcErrc::UNCLOSED_BAR);
+    REQUIRE(try_eval_func("2)").error.code == CalcErrc::TRAILING);
+    REQUIRE(try_eval_func(std::string(129, '1')).error.code == CalcErrc::TOO_LONG);
+    REQUIRE(try_eval_func("pow(-8,0.5)").error.code == CalcErrc::NOT_A_NUMBER);
+    REQUIRE(try_eval_func("10^400").error.code == CalcErrc::TOO_LARGE);
+
+    EvalResult bad = try_eval_func("2#3");
+    REQUIRE(bad.error.code == CalcErrc::BAD_CHAR);
+    REQUIRE(error_message(bad, "2#3") == "Недопустимый символ: #");
+}
+
+TEST_CASE("eval_func messages match try_eval_func", "[calc]")
+{
+    for (const char *expr : {"1/0", "0^0", "2.5!", "acos(3)", "foo(1)", "log(2)", "(1", "1+", "#", "root(-4,2)"})
+    {
+        EvalResult result = try_eval_func(expr);
+        REQUIRE(!result);
+        std::string thrown;
+        try
+        {
+            eval_func(expr);
+        }
+        catch (const CalcError &e)
+        {
+            thrown = e.what();
+        }
+        REQUIRE(thrown == error_message(result, expr));
+    }
+}
+
+// Прежний format_number: перебор точностей через ostringstream
+static std::string ReferenceFormat(double x)
+{
+    auto trim = [](const std::string &s)
+    {
+        auto pos_e = s.find_first_of("eE");
+        std::string mant = pos_e == std::string::npos ? s : s.substr(0, pos_e);
+        std::string expo = pos_e == std::string::npos ? "" : s.substr(pos_e);
+        if (mant.find('.') != std::string::npos)
+        {
+            while (!mant.empty() && mant.back() == '0')
+                mant.pop_back();
+            if (!mant.empty() && mant.back() == '.')
+                mant.pop_back();
+        }
+        return mant + expo;
+    };
+    for (auto field : {std::ios::fmtflags(0), std::ios::fmtflags(std::ios::scientific)})
+        for (int prec = 15; prec >= 1; --prec)
+        {
+            std::ostringstream oss;
+            oss.setf(field, std::ios::floatfield);
+            oss.precision(prec);
+            oss << x;
+            std::string s = trim(oss.str());
+            if (s.size() <= 15)
+                return s;
+        }
+    return "";
+}
+
+TEST_CASE("format_number matches the ostringstream reference", "[format]")
+{
+    std::vector<double> values = {0.0, -0.0, 1.0, -1.0, 0.1 + 0.2, 1.0 / 3.0, 2.0 / 3.0, 2.5, 0.125, 1e15, 1e16,
+                                  123456789012345.0, 999999999999999.0, 9999999999999999.0, 0.0001, 0.00001,
+                                  0.000123456789, 1e-300, 5e-324, 1.7976931348623157e308, 3.727892280477,
+                                  -0.00099999999999999, 99999.999999999, 0.5, 1.5, 12345.5, 0.05};
+    for (int e = -320; e <= 308; ++e)
+        values.push_back(std::pow(10.0, e));
+    std::mt19937_64 rng(7);
+    for (int k = 0; k < 200000; ++k)
+    {
+        uint64_t bits = rng();
+        double x;
+        std::memcpy(&x, &bits, sizeof(x));
+        if (std::isfinite(x))
+            values.push_back(x);
+        // короткие десятичные дроби и половинки — граница округления
+        values.push_back(double(int64_t(rng() % 2000001) - 1000000) / double(1 << (rng() % 12)));
+        values.push_back(double(rng() % 100000) * std::pow(10.0, int(rng() % 40) - 20));
+        // середина между соседними 15-значными числами и её соседи
+        double mid = (double(100000000000000 + rng() % 900000000000000) + 0.5) * std::pow(10.0, int(rng() % 30) - 25);
+        values.push_back(mid);
+        values.push_back(std::nextafter(mid, 0.0));
+        values.push_back(std::nextafter(mid, 1e300));
+    }
+
+    char buf[kMaxNumberLen];
+    for (double x : values)
+    {
+        std::string got(buf, format_number(x, buf));
+        REQUIRE(got == ReferenceFormat(x));
+    }
+    REQUIRE(format_number(1.0 / 3.0) == "0.3333333333333");
+}
+
+TEST_CASE("Arena reuses memory after reset", "[arena]")
+{
+    Arena arena(64);
+    void *first = arena.allocate(16, 8);
+    arena.allocate(200, 8);
+    arena.reset();
+    REQUIRE(arena.allocate(16, 8) == first);
+
+    auto s = arena.intern("sqrt");
+    REQUIRE(s == "sqrt");
+}
+
+TEST_CASE("Lexer parses number literals in place", "[lexer]")
+{
+    Arena arena;
+    const std::string input = "0.1 + .5*123456789012345678901234567890 - 2.5e";
+    std::string_view s = removing_spaces(input, arena);
+    ArenaSpan<const Token> tokens;
+    EvalError error;
+    REQUIRE(lexing(s, arena, tokens, error));
+    REQUIRE(tokens[0].value == 0.1);
+    REQUIRE(tokens[2].value == 0.5);
+    REQUIRE(tokens[4].value == 123456789012345678901234567890.0);
+    REQUIRE(tokens[6].value == 2.5);
+    REQUIRE(tokens[7].text == "e"); // константа, а не показатель
+
+    // текст токена — участок строки без пробелов, а не копия
+    REQUIRE(tokens[4].text.data() == s.data() + tokens[4].pos);
+    REQUIRE(tokens[4].text == "123456789012345678901234567890");
+
+    REQUIRE(lexing(removing_spaces("90'", arena), arena, tokens, error));
+    REQUIRE(tokens[0].value == 90.0 * (std::acos(-1.0) / 180.0));
+    REQUIRE(tokens[0].text == "90'");
+}
+
+TEST_CASE("Built-in names resolve through the perfect hash", "[lexer]")
+{
+    for (size_t k = 0; k < size_t(FuncId::COUNT); ++k)
+    {
+        NameRef ref = lookup_name(func_info(FuncId(k)).name);
+        REQUIRE(ref.kind == NameKind::FUNC);
+        REQUIRE(ref.id == k);
+    }
+    for (size_t k = 0; k < size_t(ConstId::COUNT); ++k)
+    {
+        NameRef ref = lookup_name(const_name(ConstId(k)));
+        REQUIRE(ref.kind == NameKind::CONST);
+        REQUIRE(ref.id == k);
+    }
+    for (const char *other : {"x", "si", "sinh", "pii", "logg", "ee", "a", "cosx", "l"})
+        REQUIRE(lookup_name(other).kind == NameKind::NONE);
+
+    Arena arena;
+    auto tokens = lexing("root(x,2)*pi", arena);
+    REQUIRE(tokens[0].type == TokType::FUNC);
+    REQUIRE(FuncId(tokens[0].id) == FuncId::ROOT);
+    REQUIRE(tokens[2].type == TokType::IDENT);
+    REQUIRE(tokens[7].type == TokType::CONST);
+    REQUIRE(ConstId(tokens[7].id) == ConstId::PI);
+}
+
+TEST_CASE("Parser emits a post-order flat AST", "[ast]")
+{
+    Arena arena;
+    auto tokens = lexing("1+2*x1", arena);
+    REQUIRE(tokens.size == 5);
+    REQUIRE(tokens[4].text == "x1");
+
+    Ast ast;
+    parsing_to_ast(lexing("1+sin(2)*3", arena), ast);
+    REQUIRE(ast.nodes.size() == 6);
+    const AstNode &root = ast[ast.root()];
+    REQUIRE(root.op == NodeOp::ADD);
+    REQUIRE(ast[root.kids[1]].op == NodeOp::MUL);
+    const AstNode &call = ast[ast[root.kids[1]].kids[0]];
+    REQUIRE(call.op == NodeOp::CALL);
+    REQUIRE(FuncId(call.id) == FuncId::SIN);
+    for (uint32_t i = 0; i < ast.nodes.size(); ++i)
+    {
+        if (ast[i].op == NodeOp::ADD || ast[i].op == NodeOp::MUL)
+        {
+            REQUIRE(ast[i].kids[0] < i);
+            REQUIRE(ast[i].kids[1] < i);
+        }
+    }
+    REQUIRE(executing(ast) == "3.727892280477");
+}
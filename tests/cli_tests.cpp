@@ -0,0 +1,425 @@
+#include "../src/calc.hpp"
+#include "../src/engine/compiled_expr.hpp"
+#include "../src/engine/parallel_batch.hpp"
+#include "../src/cli/batch_mode.hpp"
+#include "../src/cli/column_file.hpp"
+#include "../src/cli/column_mode.hpp"
+#include "../src/cli/csv_mode.hpp"
+#include "../src/cli/options.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Читает файл с начала и закрывает его
+    std::string ReadAll(std::FILE *f)
+    {
+        std::string result;
+        std::rewind(f);
+        char buf[4096];
+        size_t n;
+        while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+            result.append(buf, n);
+        std::fclose(f);
+        return result;
+    }
+
+    // Прогоняет --batch над строкой входа через временные файлы
+    std::string RunBatch(const std::string &input, size_t threads, StreamStats *stats = nullptr)
+    {
+        std::FILE *in = std::tmpfile();
+        std::FILE *out = std::tmpfile();
+        REQUIRE(in);
+        REQUIRE(out);
+        std::fwrite(input.data(), 1, input.size(), in);
+        std::rewind(in);
+
+        ThreadPool pool(threads);
+        StreamStats s = run_batch_stream(in, out, pool);
+        if (stats)
+            *stats = s;
+
+        std::fclose(in);
+        return ReadAll(out);
+    }
+
+    // Прогоняет --csv над таблицей в памяти
+    std::string RunCsv(const std::string &table, const std::string &expr, size_t threads,
+                       CsvStats *stats = nullptr)
+    {
+        std::FILE *out = std::tmpfile();
+        REQUIRE(out);
+        ThreadPool pool(threads);
+        CsvStats s = run_csv(table, expr, out, pool);
+        if (stats)
+            *stats = s;
+        return ReadAll(out);
+    }
+
+    std::vector<std::string> SplitLines(const std::string &text)
+    {
+        std::vector<std::string> lines;
+        size_t start = 0;
+        for (size_t i = 0; i < text.size(); ++i)
+            if (text[i] == '\n')
+            {
+                lines.push_back(text.substr(start, i - start));
+                start = i + 1;
+            }
+        return lines;
+    }
+} // namespace
+
+TEST_CASE("Batch mode writes one result line per input line", "[cli]")
+{
+    StreamStats stats;
+    std::string out = RunBatch("1+2\n2*pi\n\n1/0\nsqrt(16)\r\n(1+\n2^10", 2, &stats);
+    auto lines = SplitLines(out);
+    REQUIRE(lines.size() == 7);
+    CHECK(lines[0] == "3");
+    CHECK(lines[1] == "6.2831853071796");
+    CHECK(lines[2].empty());
+    CHECK(lines[3] == "error: Деление на ноль");
+    CHECK(lines[4] == "4");
+    CHECK(lines[5].rfind("error: ", 0) == 0);
+    CHECK(lines[6] == "1024");
+    CHECK(stats.lines == 7);
+    CHECK(stats.failed == 2);
+}
+
+TEST_CASE("Batch mode keeps input order across many chunks and threads", "[cli]")
+{
+    const size_t count = 50000;
+    std::string input;
+    for (size_t i = 0; i < count; ++i)
+        input += std::to_string(i) + (i % 1000 == 7 ? "/0\n" : "+1\n");
+
+    for (size_t threads : {1, 3, 8})
+    {
+        StreamStats stats;
+        auto lines = SplitLines(RunBatch(input, threads, &stats));
+        REQUIRE(lines.size() == count);
+        REQUIRE(stats.failed == count / 1000);
+        for (size_t i = 0; i < count; ++i)
+        {
+            INFO("line " << i << " threads " << threads);
+            if (i % 1000 == 7)
+                REQUIRE(lines[i].rfind("error: ", 0) == 0);
+            else
+                REQUIRE(lines[i] == std::to_string(i + 1));
+        }
+    }
+}
+
+TEST_CASE("Batch mode reports overlong lines without buffering them", "[cli]")
+{
+    std::string input = "1+1\n" + std::string(1 << 20, '1') + "\n2+2\n";
+    auto lines = SplitLines(RunBatch(input, 2));
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[0] == "2");
+    CHECK(lines[1] == "error: Строка слишком длинная");
+    CHECK(lines[2] == "4");
+}
+
+TEST_CASE("Batch mode reports a failed write after stopping all threads", "[cli]")
+{
+    // поток только для чтения: любая запись в него не проходит
+    auto path = std::filesystem::temp_directory_path() / "fast_calc_batch_readonly.txt";
+    std::ofstream(path) << "";
+    std::string input;
+    for (int i = 0; i < 20000; ++i)
+        input += "1+" + std::to_string(i) + "\n";
+    std::FILE *in = std::tmpfile();
+    std::FILE *out = std::fopen(path.string().c_str(), "r");
+    REQUIRE(in);
+    REQUIRE(out);
+    std::fwrite(input.data(), 1, input.size(), in);
+    std::rewind(in);
+
+    ThreadPool pool(3);
+    CHECK_THROWS_AS(run_batch_stream(in, out, pool), std::runtime_error);
+    std::fclose(in);
+    std::fclose(out);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Batch mode reports a failed read instead of ending the output", "[cli]")
+{
+    // поток только для записи: чтение из него — ошибка, а не конец входа
+    auto path = std::filesystem::temp_directory_path() / "fast_calc_batch_writeonly.txt";
+    std::FILE *in = std::fopen(path.string().c_str(), "w");
+    std::FILE *out = std::tmpfile();
+    REQUIRE(in);
+    REQUIRE(out);
+    ThreadPool pool(2);
+    CHECK_THROWS_AS(run_batch_stream(in, out, pool), std::runtime_error);
+    std::fclose(in);
+    std::fclose(out);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("CSV mode binds variables to header columns by name", "[cli]")
+{
+    const std::string table =
+        "\xEF\xBB\xBFid, x ,Total Price,y\r\n"
+        "1,2,abc,3\r\n"
+        "2,\"-1.5\",,+4\n"
+        "\n"
+        "3,1e3,x,0\n"
+        "4,oops,x,1\n"
+        "5,7\n"
+        "6,1,,2";
+    CsvStats stats;
+    auto lines = SplitLines(RunCsv(table, "x/y + id", 2, &stats));
+    REQUIRE(lines.size() == 7);
+    CHECK(lines[0] == "result,error");
+    CHECK(lines[1] == "1.6666666666666665,");
+    CHECK(lines[2] == "1.625,");
+    CHECK(lines[3] == ",\"Деление на ноль\"");
+    CHECK(lines[4] == ",\"Не число в столбце x\"");
+    CHECK(lines[5] == ",\"Недостаточно полей в строке\"");
+    CHECK(lines[6] == "6.5,");
+    CHECK(stats.rows == 6);
+    CHECK(stats.failed == 3);
+
+    // столбец, не используемый выражением, не разбирается
+    CHECK(SplitLines(RunCsv("a,b\n1,junk\n", "a*2", 1))[1] == "2,");
+    CHECK_THROWS_AS(RunCsv("a,b\n1,2\n", "a+c", 1), CalcError);
+    CHECK_THROWS_AS(RunCsv("", "1", 1), std::runtime_error);
+}
+
+TEST_CASE("CSV mode binds only the columns named in the expression", "[cli]")
+{
+    // столбцов-имён больше, чем допустимо переменных у выражения
+    std::string table;
+    for (int c = 0; c < 300; ++c)
+        table += (c ? ",c" : "c") + std::to_string(c);
+    table += "\n";
+    for (int c = 0; c < 300; ++c)
+        table += (c ? "," : "") + std::to_string(c);
+    table += "\n";
+    CHECK(RunCsv(table, "c0+c1*c299", 2) == "result,error\n299,\n");
+    CHECK_THROWS_AS(RunCsv(table, "c0+c300", 2), CalcError);
+}
+
+TEST_CASE("CSV mode keeps row order across ranges and threads", "[cli]")
+{
+    const size_t count = 200000;
+    std::string table = "x,y\n";
+    for (size_t i = 0; i < count; ++i)
+        table += std::to_string(i) + ",0." + std::to_string(i % 97) + "\n";
+
+    for (size_t threads : {1, 3})
+    {
+        CsvStats stats;
+        auto lines = SplitLines(RunCsv(table, "x*2+y", threads, &stats));
+        REQUIRE(lines.size() == count + 1);
+        REQUIRE(stats.rows == count);
+        REQUIRE(stats.failed == 0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            INFO("row " << i << " threads " << threads);
+            std::string y = "0." + std::to_string(i % 97);
+            double expected = double(i) * 2 + std::stod(y);
+            double value = 0.0;
+            const std::string &line = lines[i + 1];
+            auto res = std::from_chars(line.data(), line.data() + line.size(), value);
+            REQUIRE(res.ec == std::errc());
+            REQUIRE(std::string(res.ptr) == ",");
+            REQUIRE(value == expected);
+        }
+    }
+}
+
+TEST_CASE("CSV mode reads and writes files", "[cli]")
+{
+    auto dir = std::filesystem::temp_directory_path();
+    auto in = dir / "fast_calc_csv_in.csv";
+    auto out = dir / "fast_calc_csv_out.csv";
+    {
+        std::ofstream f(in, std::ios::binary);
+        f << "r\n1\n2\n";
+    }
+    ThreadPool pool(2);
+    CsvStats stats = run_csv_file(in.string(), "pi*r^2", out.string(), pool);
+    CHECK(stats.rows == 2);
+    std::ifstream f(out, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    CHECK(text == "result,error\n3.141592653589793,\n12.566370614359172,\n");
+
+    // выход поверх входа отвергается, пока вход отображён в память
+    CHECK_THROWS_AS(run_csv_file(in.string(), "r", in.string(), pool), std::runtime_error);
+    CHECK_THROWS_AS(run_csv_file(in.string(), "r", (dir / "." / in.filename()).string(), pool),
+                    std::runtime_error);
+    std::ifstream again(in, std::ios::binary);
+    CHECK(std::string((std::istreambuf_iterator<char>(again)), std::istreambuf_iterator<char>()) == "r\n1\n2\n");
+    again.close();
+    std::filesystem::remove(in);
+    std::filesystem::remove(out);
+    CHECK_THROWS_AS(run_csv_file(in.string(), "1", "", pool), std::runtime_error);
+}
+
+TEST_CASE("Column files are evaluated without copying and keep validity", "[cli]")
+{
+    auto dir = std::filesystem::temp_directory_path();
+    auto in = dir / "fast_calc_columns_in.fcol";
+    auto out = dir / "fast_calc_columns_out.fcol";
+    const size_t rows = 3 * kParallelChunk + 101;
+    {
+        ColumnFileWriter w(in.string(), rows, {"x", "Bad Name", "y", "x"});
+        for (size_t r = 0; r < rows; ++r)
+        {
+            w.data(0)[r] = 0.001 * double(r) - 5.0;
+            w.data(2)[r] = double(r % 13);
+            w.data(3)[r] = 1e300; // повтор имени — не виден выражению
+        }
+        std::memset(w.validity(0), 0xFF, error_mask_words(rows) * 8);
+        std::memset(w.validity(2), 0xFF, error_mask_words(rows) * 8);
+        w.validity(2)[0] &= ~uint64_t(2); // строка 1: нет значения y
+        w.finish();
+    }
+
+    ThreadPool pool(3);
+    ColumnStats stats = run_column_file(in.string(), "sqrt(x) / y", out.string(), pool);
+    CHECK(stats.rows == rows);
+
+    ColumnFileReader input(in.string());
+    ColumnFileReader result(out.string());
+    REQUIRE(result.rows() == rows);
+    REQUIRE(result.columns() == 1);
+    CHECK(result.name(0) == "result");
+    REQUIRE(result.validity(0));
+
+    CompiledExpr expr("sqrt(x) / y", {"x", "y"});
+    size_t failed = 0;
+    for (size_t r = 0; r < rows; ++r)
+    {
+        INFO("row " << r);
+        const double values[] = {input.data(0)[r], input.data(2)[r]};
+        double value = 0.0;
+        bool ok = expr.try_evaluate(values, value) == ErrorCode::OK && r != 1;
+        REQUIRE(bool((result.validity(0)[r / 64] >> (r % 64)) & 1) == ok);
+        if (ok)
+            REQUIRE(std::memcmp(&value, &result.data(0)[r], sizeof(double)) == 0);
+        failed += !ok;
+    }
+    CHECK(stats.failed == failed);
+    // хвост последнего слова маски не отмечает несуществующие строки
+    CHECK((result.validity(0)[rows / 64] >> (rows % 64)) == 0);
+
+    // выход поверх входа отвергается, пока вход отображён в память
+    auto size = std::filesystem::file_size(in);
+    CHECK_THROWS_AS(run_column_file(in.string(), "x", in.string(), pool), std::runtime_error);
+    CHECK_THROWS_AS(run_column_file(in.string(), "x", (dir / "." / in.filename()).string(), pool),
+                    std::runtime_error);
+    CHECK(std::filesystem::file_size(in) == size);
+
+    // усечённый файл отвергается до чтения данных
+    std::filesystem::resize_file(out, 200);
+    CHECK_THROWS_AS(ColumnFileReader(out.string()), std::runtime_error);
+    std::filesystem::remove(in);
+    std::filesystem::remove(out);
+}
+
+TEST_CASE("Column mode binds only the columns named in the expression", "[cli]")
+{
+    auto dir = std::filesystem::temp_directory_path();
+    auto in = dir / "fast_calc_wide_in.fcol";
+    auto out = dir / "fast_calc_wide_out.fcol";
+    std::vector<std::string> names;
+    for (int c = 0; c < 300; ++c)
+        names.push_back("c" + std::to_string(c));
+    {
+        ColumnFileWriter w(in.string(), 2, names);
+        for (size_t c = 0; c < names.size(); ++c)
+        {
+            for (size_t r = 0; r < 2; ++r)
+                w.data(c)[r] = double(c + r);
+            w.validity(c)[0] = 3;
+        }
+        w.finish();
+    }
+    ThreadPool pool(2);
+    ColumnStats stats = run_column_file(in.string(), "c0+c299", out.string(), pool);
+    CHECK(stats.failed == 0);
+    ColumnFileReader result(out.string());
+    CHECK(result.data(0)[0] == 299.0);
+    CHECK(result.data(0)[1] == 301.0);
+    std::filesystem::remove(in);
+    std::filesystem::remove(out);
+}
+
+TEST_CASE("Command line options are parsed", "[cli]")
+{
+    const char *argv[] = {"fast_calc", "--batch", "--threads=4", "--simd=sse2"};
+    CliOptions options = parse_cli(4, argv);
+    CHECK(options.batch);
+    CHECK(options.threads == 4);
+    CHECK(options.limit_simd);
+    CHECK(options.simd == SimdLevel::SSE2);
+
+    const char *bad_threads[] = {"fast_calc", "--threads=0"};
+    CHECK_THROWS_AS(parse_cli(2, bad_threads), CliError);
+    const char *unknown[] = {"fast_calc", "--frobnicate"};
+    CHECK_THROWS_AS(parse_cli(2, unknown), CliError);
+
+    const char *csv[] = {"fast_calc", "--csv", "data.csv", "--expr", "x + y", "--out", "r.csv"};
+    options = parse_cli(7, csv);
+    CHECK(options.csv == "data.csv");
+    CHECK(options.expr == "x + y");
+    CHECK(options.out == "r.csv");
+    const char *no_expr[] = {"fast_calc", "--csv", "data.csv"};
+    CHECK_THROWS_AS(parse_cli(3, no_expr), CliError);
+    const char *columns[] = {"fast_calc", "--columns", "data.fcol", "--expr", "x", "--out", "r.fcol"};
+    options = parse_cli(7, columns);
+    CHECK(options.columns == "data.fcol");
+    const char *columns_no_out[] = {"fast_calc", "--columns", "data.fcol", "--expr", "x"};
+    CHECK_THROWS_AS(parse_cli(5, columns_no_out), CliError);
+    const char *serve[] = {"fast_calc", "--serve", "/run/fast_calc.sock"};
+    CHECK(parse_cli(3, serve).serve == "/run/fast_calc.sock");
+    const char *shm[] = {"fast_calc", "--shm", "/fast_calc"};
+    CHECK(parse_cli(3, shm).shm == "/fast_calc");
+    const char *batch_serve[] = {"fast_calc", "--batch", "--serve", "/run/fast_calc.sock"};
+    CHECK_THROWS_AS(parse_cli(4, batch_serve), CliError);
+    const char *serve_shm[] = {"fast_calc", "--serve", "/run/fast_calc.sock", "--shm", "/fast_calc"};
+    CHECK_THROWS_AS(parse_cli(5, serve_shm), CliError);
+    const char *batch_csv[] = {"fast_calc", "--batch", "--csv", "data.csv", "--expr", "x"};
+    CHECK_THROWS_AS(parse_cli(6, batch_csv), CliError);
+    const char *shm_columns[] = {"fast_calc", "--shm", "/fast_calc", "--columns", "data.fcol",
+                                 "--expr", "x", "--out", "r.fcol"};
+    CHECK_THROWS_AS(parse_cli(9, shm_columns), CliError);
+    const char *no_value[] = {"fast_calc", "--expr"};
+    CHECK_THROWS_AS(parse_cli(2, no_value), CliError);
+}
+
+TEST_CASE("--jit makes expressions compile to machine code", "[cli]")
+{
+    const char *argv[] = {"fast_calc", "--jit"};
+    if (!jit_available())
+    {
+        CHECK_THROWS_AS(parse_cli(2, argv), CliError);
+        return;
+    }
+    CliOptions options = parse_cli(2, argv);
+    CHECK(options.jit);
+    CHECK_FALSE(CompiledExpr("x + 1", {"x"}).jitted());
+    apply_engine_options(options);
+    CompiledExpr expr("x + 1", {"x"});
+    set_default_jit(false);
+    CHECK(expr.jitted());
+    CHECK(expr.evaluate(std::vector<double>{2.0}.data()) == 3.0);
+    // явный параметр сильнее умолчания процесса
+    set_default_jit(true);
+    CompileOptions vm;
+    vm.use_jit = false;
+    CHECK_FALSE(CompiledExpr("x + 1", {"x"}, vm).jitted());
+    set_default_jit(false);
+}
@@ -0,0 +1,90 @@
+#include "../src/engine/compiled_expr.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+static bool ThrowsCalcError(const std::string &expr, std::vector<std::string> vars)
+{
+    try
+    {
+        CompiledExpr e(expr, std::move(vars));
+    }
+    catch (const CalcError &)
+    {
+        return true;
+    }
+    return false;
+}
+
+TEST_CASE("CompiledExpr binds variables by name and index", "[compiled]")
+{
+    CompiledExpr e("sqrt(x^2+y^2)", {"x", "y"});
+    REQUIRE(e.variables().size() == 2);
+    REQUIRE(e.variable_index("y") == 1);
+    REQUIRE(e.variable_index("z") == -1);
+
+    e.bind("x", 3.0);
+    e.bind(1, 4.0);
+    REQUIRE(e.evaluate() == 5.0);
+
+    const double values[] = {6.0, 8.0};
+    REQUIRE(e.evaluate(values) == 10.0);
+    REQUIRE_THROWS_AS(e.bind("z", 1.0), CalcError);
+}
+
+TEST_CASE("CompiledExpr evaluates many inputs with one compilation", "[compiled]")
+{
+    CompiledExpr e("t*t-2*t+1", {"t"});
+    for (int i = -100; i <= 100; ++i)
+    {
+        double t = i * 0.25;
+        REQUIRE(e.evaluate(&t) == t * t - 2 * t + 1);
+    }
+}
+
+TEST_CASE("CompiledExpr reports domain errors per evaluation", "[compiled]")
+{
+    CompiledExpr e("1/x+ln(y)", {"x", "y"});
+    double ok[] = {2.0, 1.0};
+    REQUIRE(e.evaluate(ok) == 0.5);
+
+    double zero[] = {0.0, 1.0};
+    double result = 0.0;
+    REQUIRE(e.try_evaluate(zero, result) == ErrorCode::DIV_ZERO);
+    REQUIRE_THROWS_AS(e.evaluate(zero), CalcError);
+
+    double negative[] = {1.0, -1.0};
+    REQUIRE(e.try_evaluate(negative, result) == ErrorCode::LN_DOMAIN);
+}
+
+TEST_CASE("CompiledExpr rejects invalid variables", "[compiled]")
+{
+    REQUIRE(ThrowsCalcError("x+1", {"sin"}));
+    REQUIRE(ThrowsCalcError("x+1", {"pi"}));
+    REQUIRE(ThrowsCalcError("x+1", {"X"}));
+    REQUIRE(ThrowsCalcError("x+1", {"x", "x"}));
+    REQUIRE(ThrowsCalcError("x+z", {"x"}));
+    REQUIRE_FALSE(ThrowsCalcError("x1+x2", {"x1", "x2"}));
+}
+
+TEST_CASE("CompiledExpr JIT and VM agree", "[compiled]")
+{
+    CompileOptions jit_options;
+    jit_options.use_jit = true;
+    CompiledExpr vm("sin(x)*cos(y)+sqrt(|x*y|)/(1+x^2)", {"x", "y"});
+    CompiledExpr jit("sin(x)*cos(y)+sqrt(|x*y|)/(1+x^2)", {"x", "y"}, jit_options);
+    REQUIRE(jit.jitted() == jit_available());
+    for (int i = 0; i < 100; ++i)
+    {
+        double values[] = {i * 0.37 - 10.0, i * 0.11};
+        REQUIRE(vm.evaluate(values) == jit.evaluate(values));
+    }
+    double bad[] = {0.0, 0.0};
+    CompiledExpr vm_err("x/y", {"x", "y"});
+    CompiledExpr jit_err("x/y", {"x", "y"}, jit_options);
+    double r1 = 0.0, r2 = 0.0;
+    REQUIRE(vm_err.try_evaluate(bad, r1) == jit_err.try_evaluate(bad, r2));
+}
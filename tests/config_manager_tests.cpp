@@ -5,6 +5,7 @@
 #include <chrono>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
 #include <optional>
 #include <random>
 
@@ -182,3 +183,63 @@ TEST_CASE("ConfigManager removes locale when empty string provided", "[ConfigMan
     const auto *general = stored.get_as<toml::table>("general");
     CHECK((general == nullptr || general->empty()));
 }
+
+TEST_CASE("ConfigManager stores engine thread count in the engine table", "[ConfigManager]")
+{
+    const auto base_dir = MakeTempDir();
+    TempDirGuard cleanup(base_dir);
+    const auto config_path = base_dir / "settings.toml";
+
+    ConfigManager manager(config_path.string());
+    manager.load();
+    CHECK(manager.get_engine_threads() == 0);
+
+    manager.set_engine_threads(6);
+    manager.save();
+
+    toml::table stored;
+    REQUIRE_NOTHROW(stored = toml::parse_file(config_path.string()));
+    CHECK(stored["engine"]["threads"].value_or(int64_t{0}) == 6);
+
+    ConfigManager reloaded(config_path.string());
+    reloaded.load();
+    CHECK(reloaded.get_engine_threads() == 6);
+
+    // отрицательное или нечисловое значение трактуется как «по числу ядер»
+    {
+        std::ofstream output(config_path);
+        output << "[engine]\nthreads = -3\n";
+    }
+    reloaded.load();
+    CHECK(reloaded.get_engine_threads() == 0);
+}
+
+TEST_CASE("ConfigManager stores expression cache budget in the engine table", "[ConfigManager]")
+{
+    const auto base_dir = MakeTempDir();
+    TempDirGuard cleanup(base_dir);
+    const auto config_path = base_dir / "settings.toml";
+
+    ConfigManager manager(config_path.string());
+    manager.load();
+    CHECK(manager.get_engine_cache_mb() == ConfigManager::kDefaultCacheMb);
+
+    // 0 — допустимое значение: кэш выключен
+    manager.set_engine_cache_mb(0);
+    manager.save();
+
+    toml::table stored;
+    REQUIRE_NOTHROW(stored = toml::parse_file(config_path.string()));
+    CHECK(stored["engine"]["cache_mb"].value_or(int64_t{-1}) == 0);
+
+    ConfigManager reloaded(config_path.string());
+    reloaded.load();
+    CHECK(reloaded.get_engine_cache_mb() == 0);
+
+    {
+        std::ofstream output(config_path);
+        output << "[engine]\ncache_mb = \"many\"\n";
+    }
+    reloaded.load();
+    CHECK(reloaded.get_engine_cache_mb() == ConfigManager::kDefaultCacheMb);
+}
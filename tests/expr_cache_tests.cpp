@@ -0,0 +1,140 @@
+#include "../src/engine/expr_cache.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("ExprCache shares one entry between spellings of an expression", "[cache]")
+{
+    ExprCache cache(1 << 20);
+    auto first = cache.get(" 1 + 2 * x", {"x"});
+    auto second = cache.get("1+2*x", {"x"});
+    REQUIRE(first == second);
+
+    ExprCacheStats stats = cache.stats();
+    CHECK(stats.misses == 1);
+    CHECK(stats.hits == 1);
+    CHECK(stats.entries == 1);
+    CHECK(stats.bytes >= first->memory_usage());
+
+    // другие имена переменных — другое выражение
+    auto renamed = cache.get("1+2*x", {"x", "y"});
+    CHECK(renamed != first);
+    CHECK(cache.stats().entries == 2);
+
+    const double values[] = {4.0};
+    CHECK(second->evaluate(values) == 9.0);
+
+    cache.clear();
+    CHECK(cache.stats().entries == 0);
+    CHECK(cache.find("1+2*x") == nullptr);
+}
+
+TEST_CASE("ExprCache evicts the least recently used entries over budget", "[cache]")
+{
+    auto probe = std::make_shared<const CompiledExpr>(std::string("1+1"));
+    // один сегмент, места примерно на три записи
+    ExprCache cache(probe->memory_usage() * 3 + 300, 1);
+    cache.insert("a", probe);
+    cache.insert("b", probe);
+    cache.insert("c", probe);
+    REQUIRE(cache.stats().entries == 3);
+
+    REQUIRE(cache.find("a") != nullptr); // теперь самая старая — "b"
+    cache.insert("d", probe);
+    CHECK(cache.find("b") == nullptr);
+    CHECK(cache.find("a") != nullptr);
+    CHECK(cache.find("c") != nullptr);
+    CHECK(cache.find("d") != nullptr);
+    CHECK(cache.stats().evictions == 1);
+
+    cache.set_budget(0);
+    ExprCacheStats stats = cache.stats();
+    CHECK(stats.entries == 0);
+    CHECK(stats.bytes == 0);
+    CHECK(stats.evictions == 4);
+
+    // при нулевом бюджете ничего не хранится
+    cache.insert("e", probe);
+    CHECK(cache.find("e") == nullptr);
+}
+
+TEST_CASE("ExprCache serves concurrent lookups", "[cache]")
+{
+    ExprCache cache(1 << 20);
+    const std::vector<std::string> exprs = {"x+1", "x*x", "sqrt(x)", "x^3-x", "sin(x)", "abs(x-5)"};
+    std::vector<std::thread> threads;
+    std::vector<int> failures(8, 0);
+    for (size_t t = 0; t < failures.size(); ++t)
+        threads.emplace_back([&, t]
+                             {
+            for (int k = 0; k < 2000; ++k)
+            {
+                const std::string &expr = exprs[(t + size_t(k)) % exprs.size()];
+                double x = double(k % 10);
+                double got = cache.get(expr, {"x"})->evaluate(&x);
+                CompiledExpr fresh(expr, {"x"});
+                if (got != fresh.evaluate(&x))
+                    ++failures[t];
+            } });
+    for (auto &thread : threads)
+        thread.join();
+
+    for (int count : failures)
+        CHECK(count == 0);
+    ExprCacheStats stats = cache.stats();
+    CHECK(stats.entries == exprs.size());
+    CHECK(stats.hits + stats.misses == 8 * 2000);
+    // гонка двух промахов по одному ключу возможна, но записей не больше выражений
+    CHECK(stats.misses >= exprs.size());
+}
+
+TEST_CASE("try_eval_func reuses cached expressions with the same results", "[cache]")
+{
+    const std::vector<std::string> exprs = {
+        "2+3*4", "sin(pi/6)", "5!", "root(27,3)", "|-2.5|*4", "90'", "log(2,8)", "(1+2)^(1/2)",
+        "sqrt(-1)", "1/0", "ln(0)", "10^400",
+    };
+    for (const std::string &expr : exprs)
+    {
+        EvalResult cold = try_eval_func(expr);
+        EvalResult warm = try_eval_func(" " + expr);
+        INFO(expr);
+        CHECK(cold.error.code == warm.error.code);
+        CHECK(cold.error.domain == warm.error.domain);
+        if (cold)
+            CHECK(cold.value == warm.value);
+        else
+            CHECK(warm.error.position == cold.error.position + 1);
+    }
+    const std::string tag(1, ExprCache::kEvalTag);
+    CHECK(expr_cache().find(tag + "2+3*4") != nullptr);
+    // ошибки не кэшируются: позицию даёт только обход дерева
+    CHECK(expr_cache().find(tag + "sqrt(-1)") == nullptr);
+}
+
+TEST_CASE("ExprCache keeps programs with different options apart", "[cache]")
+{
+    ExprCache cache(1 << 20);
+    CompileOptions fast;
+    fast.fast_math = true;
+    fast.accuracy = Accuracy::FAST;
+    auto strict = cache.get("x^3+x*x", {"x"});
+    auto relaxed = cache.get("x^3+x*x", {"x"}, fast);
+    CHECK(strict != relaxed);
+    CHECK(cache.get("x^3 + x*x", {"x"}) == strict);
+    CHECK(cache.get("x^3+x*x", {"x"}, fast) == relaxed);
+    CHECK(cache.stats().entries == 2);
+
+    CompileOptions jit;
+    jit.use_jit = true;
+    CHECK(cache.get("x^3+x*x", {"x"}, jit) != strict);
+
+    // без переменных записи get() не совпадают с записями try_eval_func
+    auto constant = cache.get("2^10", {}, fast);
+    CHECK(cache.find(std::string(1, ExprCache::kEvalTag) + "2^10") == nullptr);
+    CHECK(cache.get("2^10") != constant);
+}
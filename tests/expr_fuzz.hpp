@@ -0,0 +1,102 @@
+// tests/expr_fuzz.hpp
+// Общие помощники дифференциальных тестов: исполнитель сравнивается с
+// обходом дерева на случайных выражениях
+#pragma once
+
+#include "../src/AST.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+
+// Результат вычисления: значение либо текст ошибки
+struct Outcome
+{
+    bool ok = false;
+    double value = 0.0;
+    std::string error;
+};
+
+inline bool SameOutcome(const Outcome &a, const Outcome &b)
+{
+    if (a.ok != b.ok)
+        return false;
+    if (!a.ok)
+        return a.error == b.error;
+    if (std::isnan(a.value) && std::isnan(b.value))
+        return true;
+    return std::memcmp(&a.value, &b.value, sizeof(double)) == 0;
+}
+
+inline void Parse(const std::string &expr, Ast &ast)
+{
+    Arena arena;
+    parsing_to_ast(lexing(expr, arena), ast);
+}
+
+inline Outcome TreeWalk(const Ast &ast)
+{
+    Outcome o;
+    try
+    {
+        o.value = evaluate(ast);
+        o.ok = true;
+    }
+    catch (const CalcError &e)
+    {
+        o.error = e.what();
+    }
+    return o;
+}
+
+// Исполнитель, вернувший ErrorCode, — в том же виде, что и обход дерева
+inline Outcome FromErrorCode(ErrorCode err, double value)
+{
+    Outcome o;
+    o.value = value;
+    o.ok = err == ErrorCode::OK;
+    if (!o.ok)
+        o.error = error_message(err);
+    return o;
+}
+
+// Случайное выражение по грамматике калькулятора; с with_x листьями бывает
+// и переменная x, а литералы чаще оказываются нулём и единицей
+inline std::string RandomExpr(std::mt19937 &rng, int depth, bool with_x = false)
+{
+    static const char *const kFuncs1[] = {"sin", "cos", "tan", "asin", "acos", "atan", "sqrt", "ln", "lg", "abs"};
+    static const char *const kFuncs2[] = {"pow", "root", "log"};
+    static const char *const kOps[] = {"+", "-", "*", "/", "^"};
+    std::uniform_int_distribution<int> pick(0, depth > 0 ? 7 : 1);
+    switch (pick(rng))
+    {
+    case 0:
+    {
+        if (!with_x)
+            return std::to_string(std::uniform_int_distribution<int>(0, 9)(rng));
+        static const char *const kAtoms[] = {"x", "x", "0", "1", "2", "-1", "-0", "e"};
+        return kAtoms[std::uniform_int_distribution<int>(0, 7)(rng)];
+    }
+    case 1:
+    {
+        static const char *const kAtoms[] = {"0.5", "2", "3'", "pi", "e", "phi", "1.25", "10"};
+        static const char *const kAtomsX[] = {"0.5", "2", "3'", "pi", "phi", "1.25", "10", "x"};
+        return (with_x ? kAtomsX : kAtoms)[std::uniform_int_distribution<int>(0, 7)(rng)];
+    }
+    case 2:
+    case 3:
+        return "(" + RandomExpr(rng, depth - 1, with_x) + kOps[std::uniform_int_distribution<int>(0, 4)(rng)] +
+               RandomExpr(rng, depth - 1, with_x) + ")";
+    case 4:
+        return kFuncs1[std::uniform_int_distribution<int>(0, 9)(rng)] + std::string("(") +
+               RandomExpr(rng, depth - 1, with_x) + ")";
+    case 5:
+        return kFuncs2[std::uniform_int_distribution<int>(0, 2)(rng)] + std::string("(") +
+               RandomExpr(rng, depth - 1, with_x) + "," + RandomExpr(rng, depth - 1, with_x) + ")";
+    case 6:
+        return "-" + RandomExpr(rng, depth - 1, with_x);
+    default:
+        return "(" + RandomExpr(rng, depth - 1, with_x) + ")!";
+    }
+}
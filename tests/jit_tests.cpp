@@ -0,0 +1,92 @@
+#include "../src/engine/jit.hpp"
+#include "expr_fuzz.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+#include <string>
+
+namespace
+{
+    Outcome Jit(const JitCode &jit)
+    {
+        double value = 0.0;
+        ErrorCode err = jit.run(nullptr, value);
+        return FromErrorCode(err, value);
+    }
+} // namespace
+
+TEST_CASE("JIT is available in this build", "[jit]")
+{
+    REQUIRE(jit_available());
+}
+
+TEST_CASE("JIT code is reusable and matches the tree walk", "[jit]")
+{
+    Ast ast;
+    Parse("sin(30')*2^10+pi/4-|1-sqrt(2)|", ast);
+    auto jit = JitCode::compile(compile(ast));
+    REQUIRE(jit);
+    for (int i = 0; i < 100; ++i)
+        REQUIRE(SameOutcome(TreeWalk(ast), Jit(*jit)));
+}
+
+TEST_CASE("JIT spills high registers around calls", "[jit]")
+{
+    // глубина стека 12: задействованы xmm8..xmm13, требующие префикса REX
+    Ast ast;
+    Parse("1+(2+(3+(4+(5+(6+(7+(8+(9+(10+(11+sin(asin(0.5)/ln(3))))))))))))", ast);
+    Program p = compile(ast);
+    REQUIRE(p.max_stack >= 12);
+    auto jit = JitCode::compile(p);
+    REQUIRE(jit);
+    REQUIRE(SameOutcome(TreeWalk(ast), Jit(*jit)));
+
+    Parse("1+(2+(3+(4+(5+(6+(7+(8+(9+(10+(11+1/(2-2)))))))))))", ast);
+    jit = JitCode::compile(compile(ast));
+    REQUIRE(jit);
+    REQUIRE(SameOutcome(TreeWalk(ast), Jit(*jit)));
+}
+
+TEST_CASE("JIT keeps domain checks of the tree walk", "[jit]")
+{
+    const char *const cases[] = {"1/0", "1/(-0)", "0^0", "(-1)!", "2.5!", "171!", "asin(2)", "asin(-1.5)",
+                                 "acos(-2)", "sqrt(-1)", "ln(0)", "lg(-1)", "root(2,0)", "root(-8,2)",
+                                 "log(-1,2)", "log(8,1)", "tan(90')", "2*3+1/(2-2)", "0^1", "1^0",
+                                 "asin(1)", "acos(-1)", "sqrt(0)"};
+    for (const char *expr : cases)
+    {
+        Ast ast;
+        Parse(expr, ast);
+        auto jit = JitCode::compile(compile(ast));
+        REQUIRE(jit);
+        INFO(expr);
+        REQUIRE(SameOutcome(TreeWalk(ast), Jit(*jit)));
+    }
+}
+
+TEST_CASE("JIT matches the tree walk on random expressions", "[jit]")
+{
+    std::mt19937 rng(777);
+    int compiled = 0;
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::string expr = RandomExpr(rng, 4);
+        Ast ast;
+        try
+        {
+            Parse(expr, ast);
+        }
+        catch (const std::exception &)
+        {
+            continue;
+        }
+        auto jit = JitCode::compile(compile(ast));
+        if (!jit)
+            continue; // слишком глубокий стек — остаётся VM
+        ++compiled;
+        INFO(expr);
+        REQUIRE(SameOutcome(TreeWalk(ast), Jit(*jit)));
+    }
+    REQUIRE(compiled > 0);
+}
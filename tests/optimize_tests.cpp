@@ -0,0 +1,609 @@
+#include "../src/engine/batch.hpp"
+#include "../src/engine/compiled_expr.hpp"
+#include "../src/engine/optimize.hpp"
+#include "expr_fuzz.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    Ast Parse(const std::string &expr, const std::vector<std::string> &variables = {"x"})
+    {
+        Arena arena;
+        Ast ast;
+        parsing_to_ast(lexing(expr, arena), ast, variables);
+        return ast;
+    }
+
+    bool HasOp(const Ast &ast, NodeOp op)
+    {
+        for (const AstNode &n : ast.nodes)
+            if (n.op == op)
+                return true;
+        return false;
+    }
+
+    bool HasOpCode(const Program &p, OpCode op)
+    {
+        for (const Instr &in : p.code)
+            if (in.op == op)
+                return true;
+        return false;
+    }
+
+    bool SameBits(double a, double b)
+    {
+        if (std::isnan(a) && std::isnan(b))
+            return true;
+        return std::memcmp(&a, &b, sizeof(double)) == 0;
+    }
+
+    // Результат и ошибка должны совпасть полностью, включая позицию
+    void CheckSameOutcome(const Ast &original, const Ast &optimized, double x)
+    {
+        EvalError before, after;
+        double a = evaluate(original, &x, before);
+        double b = evaluate(optimized, &x, after);
+        CHECK(SameBits(a, b));
+        CHECK(before.code == after.code);
+        CHECK(before.domain == after.domain);
+        CHECK(before.position == after.position);
+    }
+} // namespace
+
+TEST_CASE("Constant subtrees fold into literals", "[optimize]")
+{
+    Ast ast = Parse("sin(30')*2^10+pi/4*x");
+    Ast folded = ast;
+    fold_constants(folded);
+
+    // sin(30')*2^10 и pi/4 — по одному литералу; остаются x, умножение и сложение
+    CHECK(folded.nodes.size() == 5);
+    const AstNode &root = folded[folded.root()];
+    REQUIRE(root.op == NodeOp::ADD);
+    CHECK(folded[root.kids[0]].op == NodeOp::NUMBER);
+    CHECK(folded[root.kids[0]].number == sin(30.0 * (acos(-1.0) / 180.0)) * pow(2.0, 10.0));
+
+    for (double x : {0.0, 1.0, -2.5, 1e300})
+        CheckSameOutcome(ast, folded, x);
+
+    // без переменных выражение сворачивается в одно число
+    Ast constant = Parse("sqrt(phi)+e^2-lg(1000)", {});
+    fold_constants(constant);
+    REQUIRE(constant.nodes.size() == 1);
+    CHECK(constant[0].number == sqrt(get_const(ConstId::PHI)) + pow(get_const(ConstId::E), 2.0) - log10(1000.0));
+}
+
+TEST_CASE("Constants are computed once", "[optimize]")
+{
+    CHECK(get_const(ConstId::PI) == acos(-1.0));
+    CHECK(get_const(ConstId::E) == exp(1.0));
+    CHECK(get_const(ConstId::PHI) == (1.0 + sqrt(5.0)) / 2.0);
+    CHECK_THROWS_AS(get_const(ConstId::COUNT), CalcError);
+}
+
+TEST_CASE("Folding keeps domain errors in place", "[optimize]")
+{
+    for (const char *expr : {"x+sqrt(-1)", "1/0+2*3", "2*3+(0-x)!", "log(2,1)*x+ln(0)", "x*(0^0)+tan(pi/2)"})
+    {
+        INFO(expr);
+        Ast ast = Parse(expr);
+        Ast folded = ast;
+        fold_constants(folded);
+        for (double x : {0.0, 3.0, -1.0})
+            CheckSameOutcome(ast, folded, x);
+    }
+
+    // ошибочное поддерево не сворачивается, сообщение прежнее
+    std::string message;
+    try
+    {
+        eval_func("2*3+sqrt(-4)");
+    }
+    catch (const CalcError &e)
+    {
+        message = e.what();
+    }
+    CHECK(message == error_message(ErrorCode::SQRT_NEGATIVE));
+    EvalResult r = try_eval_func("1 + 2*3 + 1/0");
+    CHECK(r.error.code == CalcErrc::DOMAIN);
+    CHECK(r.error.domain == ErrorCode::DIV_ZERO);
+    CHECK(r.error.position == 11);
+}
+
+TEST_CASE("Folding matches the tree walk on random expressions", "[optimize]")
+{
+    std::mt19937 rng(2024);
+    int folded_nodes = 0;
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::string expr = RandomExpr(rng, 4, true);
+        Ast ast;
+        try
+        {
+            ast = Parse(expr);
+        }
+        catch (const CalcError &)
+        {
+            continue;
+        }
+        Ast folded = ast;
+        fold_constants(folded);
+        REQUIRE(folded.nodes.size() <= ast.nodes.size());
+        folded_nodes += int(ast.nodes.size() - folded.nodes.size());
+        INFO(expr);
+        for (double x : {0.0, 0.5, -3.0, 7.0})
+            CheckSameOutcome(ast, folded, x);
+
+        // скомпилированная программа со свёрткой даёт тот же результат
+        CompileOptions plain;
+        plain.optimize = false;
+        CompiledExpr with(ast, {"x"}), without(ast, {"x"}, plain);
+        double x = 0.5, a = 0.0, b = 0.0;
+        CHECK(with.try_evaluate(&x, a) == without.try_evaluate(&x, b));
+        CHECK(SameBits(a, b));
+        CHECK(with.program().code.size() <= without.program().code.size());
+    }
+    CHECK(folded_nodes > 0);
+}
+
+TEST_CASE("Exact identities are removed", "[optimize]")
+{
+    for (const char *expr : {"x*1", "1*x", "x/1", "x-0", "x+(-0)", "-0+x", "x^1", "pow(x,1)", "root(x,1)",
+                             "--x", "+x", "-(-x)*1"})
+    {
+        INFO(expr);
+        Ast ast = Parse(expr);
+        Ast simple = ast;
+        fold_constants(simple);
+        simplify(simple);
+        REQUIRE(simple.nodes.size() == 1);
+        CHECK(simple[0].op == NodeOp::VAR);
+        for (double x : {0.0, -0.0, 2.5, -7.0, double(INFINITY), double(NAN)})
+            CheckSameOutcome(ast, simple, x);
+    }
+
+    // |abs(x)| и abs(-x) — один abs
+    for (const char *expr : {"|abs(x)|", "abs(abs(x))", "abs(-x)"})
+    {
+        INFO(expr);
+        Ast simple = Parse(expr);
+        simplify(simple);
+        CHECK(simple.nodes.size() == 2);
+    }
+
+    // знаки сокращаются, проверка деления остаётся на месте
+    Ast ast = Parse("(-x)/(-(x-1))+x-(-2*x)");
+    Ast simple = ast;
+    fold_constants(simple);
+    simplify(simple);
+    CHECK_FALSE(HasOp(simple, NodeOp::NEG));
+    for (double x : {1.0, 0.0, -0.0, 3.0})
+        CheckSameOutcome(ast, simple, x);
+
+    // x+0 меняет -0 на +0, а x^2 через pow и x*x расходятся в последнем знаке
+    for (const char *expr : {"x+0", "0+x", "x^2", "pow(x,3)", "root(x,2)"})
+    {
+        INFO(expr);
+        Ast kept = Parse(expr);
+        size_t size = kept.nodes.size();
+        simplify(kept);
+        CHECK(kept.nodes.size() == size);
+    }
+}
+
+TEST_CASE("Simplification matches the tree walk on random expressions", "[optimize]")
+{
+    std::mt19937 rng(99);
+    int removed = 0;
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::string expr = RandomExpr(rng, 4, true);
+        Ast ast;
+        try
+        {
+            ast = Parse(expr);
+        }
+        catch (const CalcError &)
+        {
+            continue;
+        }
+        Ast simple = ast;
+        fold_constants(simple);
+        simplify(simple);
+        removed += int(ast.nodes.size() - simple.nodes.size());
+        INFO(expr);
+        for (double x : {0.0, -0.0, 1.0, -3.0, 0.5})
+            CheckSameOutcome(ast, simple, x);
+    }
+    CHECK(removed > 0);
+}
+
+TEST_CASE("Fast-math turns integer powers into multiplications", "[optimize]")
+{
+    for (const char *expr : {"x^2", "x^3", "pow(x,4)", "(x+1)^5", "(-x)^8", "root(x,2)", "x+0"})
+    {
+        INFO(expr);
+        Ast ast = Parse(expr);
+        Ast fast = ast;
+        simplify(fast, true);
+        CHECK_FALSE(HasOp(fast, NodeOp::POW));
+        for (const AstNode &n : fast.nodes)
+            CHECK_FALSE((n.op == NodeOp::CALL && (FuncId(n.id) == FuncId::POW || FuncId(n.id) == FuncId::ROOT)));
+        for (double x : {0.0, 1.5, -2.25, 3.0, 1e10})
+        {
+            EvalError e1, e2;
+            double exact = evaluate(ast, &x, e1);
+            double approx = evaluate(fast, &x, e2);
+            CHECK(e1.code == e2.code);
+            if (e1.code == CalcErrc::OK)
+                CHECK(std::fabs(approx - exact) <= 4e-16 * std::fabs(exact));
+        }
+    }
+
+    // основание — общий узел: sin(x)^3 вызывает sin один раз
+    Ast heavy = Parse("sin(x)^3");
+    simplify(heavy, true);
+    share_subexpressions(heavy);
+    CHECK_FALSE(HasOp(heavy, NodeOp::POW));
+    CHECK(heavy.nodes.size() == 4);
+
+    // root(x,2) от отрицательного — ошибка sqrt
+    Ast root = Parse("root(x,2)");
+    simplify(root, true);
+    double x = -4.0;
+    EvalError error;
+    evaluate(root, &x, error);
+    CHECK(error.domain == ErrorCode::SQRT_NEGATIVE);
+
+    CompileOptions fast;
+    fast.fast_math = true;
+    CompiledExpr cube("x^3-2*x", {"x"}, fast);
+    CHECK_FALSE(HasOpCode(cube.program(), OpCode::POW));
+    x = 1.25;
+    CHECK(std::fabs(cube.evaluate(&x) - (pow(1.25, 3.0) - 2.5)) < 1e-15);
+}
+
+TEST_CASE("FMA opcode runs in every executor", "[optimize]")
+{
+    const std::vector<std::string> vars = {"x", "y", "z"};
+    for (const char *expr : {"x*y+z", "z+x*y", "x*y-z", "z-x*y", "x*2+1", "sqrt(z)-(x*y)"})
+    {
+        INFO(expr);
+        Ast ast = Parse(expr, vars);
+        Program fused = compile(ast, 3, true);
+        REQUIRE(HasOpCode(fused, OpCode::FMA));
+        CHECK_FALSE(HasOpCode(compile(ast, 3), OpCode::FMA));
+
+        const size_t rows = 257;
+        std::vector<double> cx(rows), cy(rows), cz(rows), expected(rows);
+        for (size_t r = 0; r < rows; ++r)
+        {
+            cx[r] = 0.1 * double(r) - 3.0;
+            cy[r] = 1.0 / (double(r) + 3.0);
+            cz[r] = double(r % 7);
+            const double row[] = {cx[r], cy[r], cz[r]};
+            REQUIRE(run(fused, row, expected[r]) == ErrorCode::OK);
+
+            // одно округление: результат совпадает с std::fma, а не с x*y+z
+            EvalError error;
+            double separate = evaluate(ast, row, error);
+            CHECK(std::fabs(expected[r] - separate) <= 1e-15 * (1.0 + std::fabs(separate)));
+        }
+        const double first[] = {cx[5], cy[5], cz[5]};
+        if (std::string(expr) == "x*y+z")
+            CHECK(SameBits(expected[5], std::fma(first[0], first[1], first[2])));
+
+        const double *columns[] = {cx.data(), cy.data(), cz.data()};
+        std::vector<double> out(rows);
+        std::vector<uint64_t> mask(error_mask_words(rows));
+        BatchEvaluator batch(fused);
+        REQUIRE(batch.evaluate(columns, rows, out.data(), mask.data()) == 0);
+        for (size_t r = 0; r < rows; ++r)
+            CHECK(SameBits(out[r], expected[r]));
+
+        if (auto jit = JitCode::compile(fused))
+            for (size_t r = 0; r < rows; ++r)
+            {
+                const double row[] = {cx[r], cy[r], cz[r]};
+                double v = 0.0;
+                REQUIRE(jit->run(row, v) == ErrorCode::OK);
+                CHECK(SameBits(v, expected[r]));
+            }
+    }
+}
+
+TEST_CASE("Identical subtrees are shared and computed once", "[optimize]")
+{
+    const std::vector<std::string> vars = {"x", "y"};
+    const std::string expr = "sqrt(x^2+y^2)*2+sqrt(x^2+y^2)/3-sqrt(x^2+y^2)^sqrt(x^2+y^2)";
+    Ast ast = Parse(expr, vars);
+    Ast shared = ast;
+    share_subexpressions(shared);
+    // x, y, 2, x^2, y^2, +, sqrt, 3, *, /, +, ^, - : по одному разу
+    CHECK(shared.nodes.size() == 13);
+    CHECK(shared.nodes.size() < ast.nodes.size() / 2);
+
+    CompileOptions plain;
+    plain.optimize = false;
+    CompiledExpr with(expr, vars), without(expr, vars, plain);
+    // общий родитель у x^2+y^2 один — sqrt; во временной ячейке только sqrt(...),
+    // общий литерал 2 кладётся заново
+    CHECK(with.program().temps == 1);
+    CHECK(with.program().code.size() < without.program().code.size());
+
+    const double row[] = {3.0, 4.0};
+    EvalError e1, e2;
+    double expected = evaluate(ast, row, e1);
+    CHECK(SameBits(evaluate(shared, row, e2), expected));
+    CHECK(SameBits(with.evaluate(row), expected));
+    if (auto jit = JitCode::compile(with.program()))
+    {
+        double v = 0.0;
+        REQUIRE(jit->run(row, v) == ErrorCode::OK);
+        CHECK(SameBits(v, expected));
+    }
+
+    // пакет: общий столбец переживает последующие инструкции
+    const size_t rows = 3000;
+    std::vector<double> cx(rows), cy(rows), out(rows);
+    for (size_t r = 0; r < rows; ++r)
+    {
+        cx[r] = double(r % 17) * 0.25;
+        cy[r] = double(r % 5) + 0.5;
+    }
+    const double *columns[] = {cx.data(), cy.data()};
+    std::vector<uint64_t> mask(error_mask_words(rows));
+    BatchEvaluator batch(with.program());
+    REQUIRE(batch.evaluate(columns, rows, out.data(), mask.data()) == 0);
+    for (size_t r = 0; r < rows; r += 7)
+    {
+        const double v[] = {cx[r], cy[r]};
+        CHECK(SameBits(out[r], without.evaluate(v)));
+    }
+}
+
+TEST_CASE("Shared subtrees keep the first domain error", "[optimize]")
+{
+    for (const char *expr : {"ln(x-1)+ln(x-1)*2", "1/x+sqrt(1/x)", "(x-2)!+(x-2)!", "asin(x)+acos(x)*asin(x)"})
+    {
+        INFO(expr);
+        Ast ast = Parse(expr);
+        Ast shared = ast;
+        share_subexpressions(shared);
+        REQUIRE(shared.nodes.size() < ast.nodes.size());
+        CompiledExpr compiled(expr, {"x"});
+        for (double x : {0.0, 1.0, 2.0, 5.0, -3.0})
+        {
+            CheckSameOutcome(ast, shared, x);
+            EvalError error;
+            evaluate(ast, &x, error);
+            double v = 0.0;
+            CHECK(compiled.try_evaluate(&x, v) == error.domain);
+        }
+    }
+}
+
+TEST_CASE("Full pipeline matches the tree walk on random expressions", "[optimize]")
+{
+    std::mt19937 rng(4242);
+    for (int i = 0; i < 4000; ++i)
+    {
+        // повторяющиеся куски делают общие поддеревья частыми
+        std::string part = RandomExpr(rng, 2, true);
+        std::string expr = "(" + part + ")*" + RandomExpr(rng, 2, true) + "+(" + part + ")";
+        Ast ast;
+        try
+        {
+            ast = Parse(expr);
+        }
+        catch (const CalcError &)
+        {
+            continue;
+        }
+        Ast optimized = ast;
+        fold_constants(optimized);
+        simplify(optimized);
+        share_subexpressions(optimized);
+        INFO(expr);
+        CompiledExpr compiled(ast, {"x"});
+        auto jit = JitCode::compile(compiled.program());
+        for (double x : {0.0, 1.0, -2.0, 0.75})
+        {
+            CheckSameOutcome(ast, optimized, x);
+            EvalError error;
+            double expected = evaluate(ast, &x, error);
+            double v = 0.0;
+            CHECK(compiled.try_evaluate(&x, v) == error.domain);
+            if (error.code == CalcErrc::OK)
+                CHECK(SameBits(v, expected));
+            if (jit)
+            {
+                CHECK(jit->run(&x, v) == error.domain);
+                if (error.code == CalcErrc::OK)
+                    CHECK(SameBits(v, expected));
+            }
+        }
+    }
+}
+
+namespace
+{
+    // Длина самой длинной цепочки зависимостей от листа до корня
+    int Depth(const Ast &ast)
+    {
+        std::vector<int> depth(ast.nodes.size(), 1);
+        for (uint32_t i = 0; i < ast.nodes.size(); ++i)
+            for (uint32_t k = 0; k < kid_count(ast[i]); ++k)
+                depth[i] = std::max(depth[i], depth[ast[i].kids[k]] + 1);
+        return depth[ast.root()];
+    }
+
+    // Допуск для переставленной суммы одночленов: относительно суммы модулей членов
+    double PolyTolerance(const std::vector<double> &c, double x)
+    {
+        double sum = 0.0, power = 1.0;
+        for (double ck : c)
+        {
+            sum += std::fabs(ck * power);
+            power *= x;
+        }
+        return 1e-13 * (1.0 + sum);
+    }
+} // namespace
+
+TEST_CASE("Polynomials are evaluated by Horner and Estrin schemes", "[optimize]")
+{
+    struct Case
+    {
+        const char *expr;
+        std::vector<double> coefficients; // c[0], c[1], …
+    };
+    const Case cases[] = {
+        {"3*x^3-2*x^2+x-7", {-7, 1, -2, 3}},
+        {"x*(x^2+2*x-5)-6", {-6, -5, 2, 1}},
+        {"x^6/2+x^4-pow(x,2)*4+0.5", {0.5, 0, -4, 0, 1, 0, 0.5}},
+        {"-(2*x^3-x)/4+x^2", {0, 0.25, 1, -0.5}},
+        {"x^10+5*x^8+10*x^6+10*x^4+5*x^2+1", {1, 0, 5, 0, 10, 0, 10, 0, 5, 0, 1}},
+        {"1+x+x^2+x^3+x^4+x^5+x^6+x^7+x^8+x^9+x^10+x^11+x^12", {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}},
+    };
+    for (const Case &c : cases)
+    {
+        INFO(c.expr);
+        Ast ast = Parse(c.expr);
+        Ast poly = ast;
+        fold_constants(poly);
+        rewrite_polynomials(poly);
+        CHECK_FALSE(HasOp(poly, NodeOp::POW));
+        CHECK_FALSE(HasOp(poly, NodeOp::CALL));
+        const int degree = int(c.coefficients.size()) - 1;
+        // у Горнера цепочка по одному умножению и сложению на степень,
+        // у Эстрина — логарифм степени
+        if (degree >= 8)
+            CHECK(Depth(poly) < degree);
+
+        CompileOptions fast;
+        fast.fast_math = true;
+        CompiledExpr compiled(c.expr, {"x"}, fast);
+        CHECK_FALSE(HasOpCode(compiled.program(), OpCode::POW));
+        for (double x : {0.0, 1.0, -1.5, 0.3, 2.75, -7.0})
+        {
+            EvalError error;
+            double expected = evaluate(ast, &x, error);
+            REQUIRE(error.code == CalcErrc::OK);
+            CHECK(std::fabs(evaluate(poly, &x, error) - expected) <= PolyTolerance(c.coefficients, x));
+            CHECK(std::fabs(compiled.evaluate(&x) - expected) <= PolyTolerance(c.coefficients, x));
+        }
+    }
+}
+
+TEST_CASE("Products and powers of polynomials are not expanded", "[optimize]")
+{
+    // у кратного корня раскрытые коэффициенты сокращаются и теряют все знаки,
+    // поэтому значение должно остаться точным относительно, а не по сумме членов
+    struct Case
+    {
+        const char *expr;
+        double x;
+    };
+    const Case cases[] = {
+        {"(x-1)^8", 1.001},
+        {"1/(x-1)^8", 1.001},
+        {"(3+x)^12", -2.8},
+        {"(x+1)*(x-2)*(x+3)", 2.0001},
+        {"x^3+2*x+(x-1)^8", 1.001},
+        {"pow(x-1,5)*x^2", 1.0001},
+    };
+    CompileOptions fast;
+    fast.fast_math = true;
+    for (const Case &c : cases)
+    {
+        INFO(c.expr);
+        CompiledExpr strict(c.expr, {"x"}), relaxed(c.expr, {"x"}, fast);
+        double expected = strict.evaluate(&c.x);
+        double v = relaxed.evaluate(&c.x);
+        CHECK(std::fabs(v - expected) <= 1e-12 * std::fabs(expected));
+    }
+
+    Ast ast = Parse("(x-1)^8+x^2+x");
+    rewrite_polynomials(ast);
+    CHECK(HasOp(ast, NodeOp::POW));
+
+    // деление на степень у корня не превращается в деление на ноль
+    CompiledExpr quotient("1/(x-1)^8+x^2", {"x"}, fast);
+    const size_t rows = 1000;
+    std::vector<double> cx(rows), out(rows);
+    for (size_t r = 0; r < rows; ++r)
+        cx[r] = 1.0 + (double(r) - 500.5) * 1e-6;
+    const double *columns[] = {cx.data()};
+    std::vector<uint64_t> mask(error_mask_words(rows));
+    BatchEvaluator batch(quotient.program());
+    CHECK(batch.evaluate(columns, rows, out.data(), mask.data()) == 0);
+}
+
+TEST_CASE("Only single-variable polynomial subtrees are rewritten", "[optimize]")
+{
+    // sin(x) остаётся, многочлен рядом с ним переписывается
+    Ast mixed = Parse("sin(x)+3*x^2+x^3");
+    rewrite_polynomials(mixed);
+    CHECK_FALSE(HasOp(mixed, NodeOp::POW));
+    CHECK(HasOp(mixed, NodeOp::CALL));
+
+    // две переменные и деление на переменную — не многочлены от одной переменной
+    for (const char *expr : {"x^2+y^2", "x^3/y+x", "x^2*y"})
+    {
+        INFO(expr);
+        Ast ast = Parse(expr, {"x", "y"});
+        Ast same = ast;
+        rewrite_polynomials(same);
+        CHECK(same.nodes.size() == ast.nodes.size());
+        CHECK(HasOp(same, NodeOp::POW));
+    }
+
+    // x^0 — не член многочлена: 0^0 остаётся ошибкой
+    Ast zero = Parse("x^0+x^2+x");
+    rewrite_polynomials(zero);
+    double x = 0.0;
+    EvalError error;
+    evaluate(zero, &x, error);
+    CHECK(error.code != CalcErrc::OK);
+    CHECK(HasOp(zero, NodeOp::POW));
+}
+
+TEST_CASE("Polynomial programs give the same bits in VM, batch and JIT", "[optimize]")
+{
+    CompileOptions fast;
+    fast.fast_math = true;
+    for (const char *expr : {"2*x^4-3*x^3+x^2-x+5", "(x-1)^12+x^9/4", "sin(x)*(x^3+2*x)"})
+    {
+        INFO(expr);
+        CompiledExpr compiled(expr, {"x"}, fast);
+        const size_t rows = 1000;
+        std::vector<double> cx(rows), out(rows);
+        for (size_t r = 0; r < rows; ++r)
+            cx[r] = double(r) * 0.01 - 5.0;
+        const double *columns[] = {cx.data()};
+        std::vector<uint64_t> mask(error_mask_words(rows));
+        BatchEvaluator batch(compiled.program());
+        REQUIRE(batch.evaluate(columns, rows, out.data(), mask.data()) == 0);
+        auto jit = JitCode::compile(compiled.program());
+        for (size_t r = 0; r < rows; ++r)
+        {
+            double expected = compiled.evaluate(&cx[r]);
+            CHECK(SameBits(out[r], expected));
+            if (jit)
+            {
+                double v = 0.0;
+                REQUIRE(jit->run(&cx[r], v) == ErrorCode::OK);
+                CHECK(SameBits(v, expected));
+            }
+        }
+    }
+}
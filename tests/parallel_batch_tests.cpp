@@ -0,0 +1,115 @@
+#include "../src/engine/compiled_expr.hpp"
+#include "../src/engine/parallel_batch.hpp"
+#include "../src/engine/thread_pool.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_CASE("ThreadPool runs every index exactly once", "[parallel]")
+{
+    for (size_t threads : {1, 2, 3, 8})
+    {
+        ThreadPool pool(threads);
+        REQUIRE(pool.size() == threads);
+        for (size_t count : {0, 1, 5, 1000})
+        {
+            std::vector<std::atomic<int>> hits(count);
+            std::atomic<bool> bad_worker{false};
+            pool.parallel_for(count, [&](size_t index, size_t worker)
+                              {
+                hits[index].fetch_add(1);
+                if (worker >= threads)
+                    bad_worker = true; });
+            for (auto &h : hits)
+                REQUIRE(h.load() == 1);
+            REQUIRE_FALSE(bad_worker);
+        }
+    }
+}
+
+TEST_CASE("ThreadPool balances uneven work by stealing", "[parallel]")
+{
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> per_worker(pool.size());
+    // все тяжёлые задачи попадают в начальный диапазон потока 0
+    pool.parallel_for(64, [&](size_t index, size_t worker)
+                      {
+        volatile double sink = 0.0;
+        size_t spins = index < 16 ? 2000000 : 10;
+        for (size_t k = 0; k < spins; ++k)
+            sink = sink + std::sqrt(double(k));
+        per_worker[worker].fetch_add(1); });
+    int total = 0;
+    for (auto &w : per_worker)
+        total += w.load();
+    REQUIRE(total == 64);
+    // без перехвата поток 0 выполнил бы ровно свои 16 задач
+    REQUIRE(per_worker[0].load() < 64);
+}
+
+TEST_CASE("ThreadPool rethrows the exception of a task", "[parallel]")
+{
+    ThreadPool pool(3);
+    REQUIRE_THROWS_AS(pool.parallel_for(100, [](size_t index, size_t)
+                                        {
+        if (index == 42)
+            throw std::runtime_error("boom"); }),
+                      std::runtime_error);
+    // пул остаётся рабочим
+    std::atomic<size_t> sum{0};
+    pool.parallel_for(10, [&](size_t index, size_t)
+                      { sum += index; });
+    REQUIRE(sum == 45);
+}
+
+TEST_CASE("Parallel batch evaluation is identical to single-threaded", "[parallel]")
+{
+    const size_t rows = kParallelChunk * 5 + 1234;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> dist(-4.0, 4.0);
+    std::vector<double> xs(rows), ys(rows);
+    for (size_t r = 0; r < rows; ++r)
+    {
+        xs[r] = dist(rng);
+        ys[r] = r % 97 == 0 ? 0.0 : dist(rng);
+    }
+    const double *columns[] = {xs.data(), ys.data()};
+
+    for (Accuracy accuracy : {Accuracy::STRICT, Accuracy::FAST})
+    {
+        CompileOptions options;
+        options.accuracy = accuracy;
+        CompiledExpr compiled("sin(x)/y+ln(x)*pow(|y|,x)-(x*2)!", {"x", "y"}, options);
+
+        std::vector<double> expected(rows);
+        std::vector<uint64_t> expected_mask(error_mask_words(rows));
+        std::vector<ErrorCode> expected_codes(rows);
+        BatchEvaluator single(compiled.program());
+        size_t expected_failed = single.evaluate(columns, rows, expected.data(), expected_mask.data(),
+                                                 expected_codes.data());
+        REQUIRE(expected_failed > 0);
+
+        for (size_t threads : {1, 2, 7})
+        {
+            ThreadPool pool(threads);
+            ParallelBatchEvaluator parallel(compiled.program(), pool);
+            std::vector<double> out(rows);
+            std::vector<uint64_t> mask(error_mask_words(rows), ~uint64_t(0));
+            std::vector<ErrorCode> codes(rows);
+            size_t failed = parallel.evaluate(columns, rows, out.data(), mask.data(), codes.data());
+
+            INFO("threads " << threads);
+            REQUIRE(failed == expected_failed);
+            REQUIRE(mask == expected_mask);
+            REQUIRE(codes == expected_codes);
+            REQUIRE(std::memcmp(out.data(), expected.data(), rows * sizeof(double)) == 0);
+        }
+    }
+}
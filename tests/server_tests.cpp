@@ -0,0 +1,240 @@
+#include "../src/cli/protocol.hpp"
+#include "../src/cli/server.hpp"
+#include "../src/engine/compiled_expr.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    std::string SocketPath()
+    {
+        return (std::filesystem::temp_directory_path() / ("fast_calc_test_" + std::to_string(::getpid()) + ".sock")).string();
+    }
+
+    // Сервер в отдельном потоке на время теста
+    class RunningServer
+    {
+    public:
+        RunningServer() : path_(SocketPath()), server_(path_), thread_([this]
+                                                                      { server_.run(); })
+        {
+        }
+        ~RunningServer() { Stop(); }
+
+        void Stop()
+        {
+            if (!thread_.joinable())
+                return;
+            server_.stop();
+            thread_.join();
+        }
+        const std::string &path() const { return path_; }
+        // Только после Stop()
+        const ServerStats &stats() const { return server_.stats(); }
+
+    private:
+        std::string path_;
+        EvalServer server_;
+        std::thread thread_;
+    };
+
+    int Connect(const std::string &path)
+    {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        REQUIRE(fd >= 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.data(), path.size());
+        REQUIRE(::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+        return fd;
+    }
+
+    void SendAll(int fd, const std::string &data)
+    {
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            REQUIRE(n > 0);
+            sent += size_t(n);
+        }
+    }
+
+    // Читает count ответов; false, если сервер закрыл соединение раньше
+    bool ReadResponses(int fd, size_t count, std::vector<Response> &out)
+    {
+        std::string buffer;
+        char chunk[65536];
+        while (out.size() < count)
+        {
+            size_t consumed = 0;
+            Response r;
+            FrameResult result = parse_response(buffer, r, consumed);
+            REQUIRE(result != FrameResult::MALFORMED);
+            if (result == FrameResult::OK)
+            {
+                out.push_back(r);
+                buffer.erase(0, consumed);
+                continue;
+            }
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0)
+                return false;
+            buffer.append(chunk, size_t(n));
+        }
+        return true;
+    }
+} // namespace
+
+TEST_CASE("Protocol frames round-trip", "[server]")
+{
+    std::string wire;
+    append_request(wire, 42, "x*y", {{"x", 1.5}, {"y", -2.0}});
+    append_request(wire, 43, "pi");
+    RequestView request;
+    size_t consumed = 0;
+    REQUIRE(parse_request(wire, request, consumed) == FrameResult::OK);
+    CHECK(request.id == 42);
+    CHECK(request.expr == "x*y");
+    REQUIRE(request.bindings.size() == 2);
+    CHECK(request.bindings[1].name == "y");
+    CHECK(request.bindings[1].value == -2.0);
+    std::string_view rest = std::string_view(wire).substr(consumed);
+    REQUIRE(parse_request(rest, request, consumed) == FrameResult::OK);
+    CHECK(request.id == 43);
+    CHECK(request.bindings.empty());
+    CHECK(consumed == rest.size());
+    CHECK(parse_request(rest.substr(0, 5), request, consumed) == FrameResult::INCOMPLETE);
+
+    // длина кадра больше его содержимого по полям
+    std::string bad;
+    append_request(bad, 1, "1");
+    bad[0] = char(bad[0] + 1);
+    bad.push_back('\0');
+    CHECK(parse_request(bad, request, consumed) == FrameResult::MALFORMED);
+
+    std::string out;
+    append_response(out, 7, kStatusInvalid, 0.0, "текст");
+    Response response;
+    REQUIRE(parse_response(out, response, consumed) == FrameResult::OK);
+    CHECK(response.id == 7);
+    CHECK(response.status == kStatusInvalid);
+    CHECK(response.message == "текст");
+}
+
+TEST_CASE("Server answers pipelined requests in order and batches equal expressions", "[server]")
+{
+    RunningServer server;
+    int fd = Connect(server.path());
+
+    const size_t count = 3000;
+    std::string wire;
+    for (size_t i = 0; i < count; ++i)
+    {
+        double x = double(i) * 0.01 - 3.0;
+        if (i % 3 == 0)
+            append_request(wire, uint32_t(i), "sin(x)*y + ln(x)", {{"x", x}, {"y", 2.0}});
+        else if (i % 3 == 1)
+            append_request(wire, uint32_t(i), "sqrt(x) / y", {{"x", x}, {"y", double(i % 5)}});
+        else
+            append_request(wire, uint32_t(i), i % 100 == 2 ? "1 +" : "2^10");
+    }
+    SendAll(fd, wire);
+
+    std::vector<Response> responses;
+    REQUIRE(ReadResponses(fd, count, responses));
+    CompiledExpr first("sin(x)*y + ln(x)", {"x", "y"});
+    CompiledExpr second("sqrt(x) / y", {"x", "y"});
+    for (size_t i = 0; i < count; ++i)
+    {
+        INFO("request " << i);
+        const Response &r = responses[i];
+        REQUIRE(r.id == uint32_t(i));
+        double x = double(i) * 0.01 - 3.0;
+        if (i % 3 == 2)
+        {
+            if (i % 100 == 2)
+            {
+                REQUIRE(r.status == kStatusInvalid);
+                REQUIRE_FALSE(r.message.empty());
+            }
+            else
+                REQUIRE((r.status == 0 && r.value == 1024.0));
+            continue;
+        }
+        const double values[] = {x, i % 3 == 0 ? 2.0 : double(i % 5)};
+        double expected = 0.0;
+        ErrorCode code = (i % 3 == 0 ? first : second).try_evaluate(values, expected);
+        REQUIRE(r.status == uint8_t(code));
+        if (code == ErrorCode::OK)
+            REQUIRE(std::memcmp(&r.value, &expected, sizeof(double)) == 0);
+        else
+            REQUIRE(std::isnan(r.value));
+    }
+    ::close(fd);
+
+    server.Stop();
+    CHECK(server.stats().requests == count);
+    CHECK(server.stats().compiled == 4);
+    CHECK(server.stats().batched > 0);
+}
+
+TEST_CASE("Server keeps compiled expressions and serves several clients", "[server]")
+{
+    RunningServer server;
+    std::vector<int> fds;
+    for (int k = 0; k < 4; ++k)
+        fds.push_back(Connect(server.path()));
+    for (int round = 0; round < 3; ++round)
+        for (size_t k = 0; k < fds.size(); ++k)
+        {
+            std::string wire;
+            append_request(wire, uint32_t(round), "x^2 + 1", {{"x", double(k)}});
+            SendAll(fds[k], wire);
+            std::vector<Response> responses;
+            REQUIRE(ReadResponses(fds[k], 1, responses));
+            CHECK(responses[0].value == double(k * k + 1));
+        }
+    for (int fd : fds)
+        ::close(fd);
+    server.Stop();
+    CHECK(server.stats().connections == 4);
+    CHECK(server.stats().compiled == 1);
+}
+
+TEST_CASE("Server closes connections that break the protocol", "[server]")
+{
+    RunningServer server;
+    int fd = Connect(server.path());
+    std::string wire;
+    append_request(wire, 1, "1+1");
+    std::string bad;
+    append_request(bad, 2, "2+2");
+    bad[0] = char(bad[0] + 1);
+    bad.push_back('\0');
+    SendAll(fd, wire + bad + wire);
+
+    std::vector<Response> responses;
+    CHECK_FALSE(ReadResponses(fd, 3, responses));
+    REQUIRE(responses.size() == 1);
+    CHECK(responses[0].value == 2.0);
+    ::close(fd);
+
+    // сервер продолжает принимать новых клиентов
+    fd = Connect(server.path());
+    SendAll(fd, wire);
+    responses.clear();
+    CHECK(ReadResponses(fd, 1, responses));
+    ::close(fd);
+}
@@ -0,0 +1,178 @@
+#include "../src/calc.hpp"
+#include "../src/cli/shm_transport.hpp"
+#include "../src/engine/compiled_expr.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    std::string SegmentName() { return "/fast_calc_test_" + std::to_string(::getpid()); }
+
+    // Сервер в отдельном потоке на время теста
+    class RunningServer
+    {
+    public:
+        explicit RunningServer(size_t channels = 4)
+            : name_(SegmentName()), server_(name_, channels), thread_([this]
+                                                                    { server_.run(); })
+        {
+        }
+        ~RunningServer() { Stop(); }
+
+        void Stop()
+        {
+            if (!thread_.joinable())
+                return;
+            server_.stop();
+            thread_.join();
+        }
+        const std::string &name() const { return name_; }
+        // Только после Stop()
+        const ShmStats &stats() const { return server_.stats(); }
+
+    private:
+        std::string name_;
+        ShmServer server_;
+        std::thread thread_;
+    };
+} // namespace
+
+TEST_CASE("Shared memory client evaluates compiled expressions", "[shm]")
+{
+    RunningServer server;
+    ShmClient client(server.name());
+
+    uint32_t id = client.compile("sqrt(x) / y + pi", {"x", "y"});
+    CHECK(client.compile("sqrt(x) / y + pi", {"x", "y"}) == id);
+    uint32_t constant = client.compile("2^10");
+    CHECK(constant != id);
+
+    CompiledExpr reference("sqrt(x) / y + pi", {"x", "y"});
+    for (int i = -50; i < 200; ++i)
+    {
+        INFO("i = " << i);
+        const double args[] = {double(i) * 0.5, double(i % 7)};
+        double value = 0.0, expected = 0.0;
+        ErrorCode code = client.evaluate(id, args, 2, value);
+        REQUIRE(code == reference.try_evaluate(args, expected));
+        if (code == ErrorCode::OK)
+            REQUIRE(std::memcmp(&value, &expected, sizeof(double)) == 0);
+        else
+            REQUIRE(std::isnan(value));
+    }
+    double value = 0.0;
+    REQUIRE(client.evaluate(constant, nullptr, 0, value) == ErrorCode::OK);
+    CHECK(value == 1024.0);
+
+    CHECK_THROWS_AS(client.compile("1 +"), CalcError);
+    CHECK_THROWS_AS(client.compile("x + z", {"x"}), CalcError);
+    CHECK_THROWS_AS(client.evaluate(id, nullptr, 0, value), CalcError);
+    CHECK_THROWS_AS(client.evaluate(12345, nullptr, 0, value), CalcError);
+    CHECK_THROWS_AS(client.compile(std::string(300, '1')), std::length_error);
+
+    // номер выражения, которое evaluate() не может вызвать, не выдаётся
+    std::vector<std::string> many;
+    for (size_t k = 0; k <= kShmMaxArgs; ++k)
+        many.push_back("v" + std::to_string(k));
+    CHECK_THROWS_AS(client.compile("v0", many), CalcError);
+
+    server.Stop();
+    CHECK(server.stats().compiled == 2);
+}
+
+TEST_CASE("Shared memory channels serve concurrent clients", "[shm]")
+{
+    RunningServer server(3);
+    std::vector<std::thread> threads;
+    std::vector<int> ok(3, 0);
+    for (int t = 0; t < 3; ++t)
+        threads.emplace_back([&, t]
+                             {
+            ShmClient client(server.name());
+            uint32_t id = client.compile("x * k", {"x", "k"});
+            int good = 0;
+            for (int i = 0; i < 2000; ++i)
+            {
+                const double args[] = {double(i), double(t + 1)};
+                double value = 0.0;
+                good += client.evaluate(id, args, 2, value) == ErrorCode::OK && value == double(i * (t + 1));
+            }
+            ok[t] = good; });
+    for (auto &th : threads)
+        th.join();
+    for (int good : ok)
+        CHECK(good == 2000);
+
+    // все каналы заняты — четвёртый клиент не подключается
+    {
+        ShmClient a(server.name()), b(server.name()), c(server.name());
+        CHECK_THROWS_AS(ShmClient(server.name()), std::runtime_error);
+    }
+    // после освобождения канал снова доступен
+    ShmClient again(server.name());
+    double value = 0.0;
+    REQUIRE(again.evaluate(again.compile("1+1"), nullptr, 0, value) == ErrorCode::OK);
+    CHECK(value == 2.0);
+}
+
+TEST_CASE("Shared memory client wakes the sleeping server and notices shutdown", "[shm]")
+{
+    auto server = std::make_unique<RunningServer>();
+    ShmClient client(server->name());
+    uint32_t id = client.compile("x + 1", {"x"});
+    // сервер успевает заснуть на futex
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const double arg = 41.0;
+    double value = 0.0;
+    REQUIRE(client.evaluate(id, &arg, 1, value) == ErrorCode::OK);
+    CHECK(value == 42.0);
+
+    std::string name = server->name();
+    server.reset();
+    CHECK_THROWS_AS(client.evaluate(id, &arg, 1, value), std::runtime_error);
+    CHECK_THROWS_AS(ShmClient(name), std::runtime_error);
+}
+
+TEST_CASE("Shared memory channels of exited clients are reclaimed", "[shm]")
+{
+    RunningServer server(2);
+    // клиенты завершаются без деструктора, как при падении или kill
+    for (int k = 0; k < 2; ++k)
+    {
+        pid_t pid = ::fork();
+        REQUIRE(pid >= 0);
+        if (pid == 0)
+        {
+            ShmClient client(server.name());
+            const double arg = 1.0;
+            double value = 0.0;
+            client.evaluate(client.compile("x + 1", {"x"}), &arg, 1, value);
+            ::_exit(value == 2.0 ? 0 : 1);
+        }
+        int status = 0;
+        REQUIRE(::waitpid(pid, &status, 0) == pid);
+        REQUIRE(WIFEXITED(status));
+        REQUIRE(WEXITSTATUS(status) == 0);
+    }
+
+    ShmClient first(server.name());
+    ShmClient second(server.name());
+    CHECK_THROWS_AS(ShmClient(server.name()), std::runtime_error);
+    const double arg = 2.0;
+    for (ShmClient *client : {&first, &second})
+    {
+        double value = 0.0;
+        REQUIRE(client->evaluate(client->compile("x * 3", {"x"}), &arg, 1, value) == ErrorCode::OK);
+        CHECK(value == 6.0);
+    }
+}
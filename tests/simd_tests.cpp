@@ -0,0 +1,250 @@
+#include "../src/engine/batch.hpp"
+#include "../src/engine/compiled_expr.hpp"
+#include "../src/engine/dispatch.hpp"
+#include "../src/engine/simd.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Расстояние в ULP между двумя double; NaN с NaN и +0 с -0 считаются равными
+    double UlpDistance(double a, double b)
+    {
+        if ((std::isnan(a) && std::isnan(b)) || a == b)
+            return 0.0;
+        if (std::isnan(a) || std::isnan(b))
+            return std::numeric_limits<double>::infinity();
+        auto ordered = [](double x)
+        {
+            int64_t i;
+            std::memcpy(&i, &x, sizeof(double));
+            return i < 0 ? std::numeric_limits<int64_t>::min() - i : i;
+        };
+        int64_t ia = ordered(a), ib = ordered(b);
+        return double(ia > ib ? uint64_t(ia) - uint64_t(ib) : uint64_t(ib) - uint64_t(ia));
+    }
+
+    // Векторные наборы, которые можно выполнять на этой машине
+    std::vector<const KernelSet *> FastSets()
+    {
+        std::vector<const KernelSet *> sets;
+        for (int l = 1; l <= int(detected_simd_level()); ++l)
+            if (const KernelSet *k = kernels_for_level(SimdLevel(l)))
+                sets.push_back(k);
+        return sets;
+    }
+
+    struct Case
+    {
+        FuncId f;
+        double lo, hi;
+        double max_ulp;
+    };
+
+    // Границы погрешности из document/engine.md
+    const Case kCases[] = {
+        {FuncId::SIN, -1e5, 1e5, 2}, {FuncId::SIN, -4, 4, 2}, {FuncId::COS, -1e5, 1e5, 2},
+        {FuncId::COS, -4, 4, 2}, {FuncId::TAN, -10, 10, 4}, {FuncId::ASIN, -1, 1, 4},
+        {FuncId::ACOS, -1, 1, 4}, {FuncId::ATAN, -100, 100, 2}, {FuncId::LN, 1e-6, 1e6, 2},
+        {FuncId::LG, 1e-6, 1e6, 2}, {FuncId::SQRT, 0, 1e6, 0}, {FuncId::ABS, -1e6, 1e6, 0}};
+} // namespace
+
+TEST_CASE("Fast kernels stay within documented error bounds", "[simd]")
+{
+    const KernelSet &strict = strict_kernels();
+    std::mt19937_64 rng(7);
+    const size_t n = 50000;
+    std::vector<double> x(n), fast(n), exact(n);
+    for (const KernelSet *set : FastSets())
+        for (const Case &c : kCases)
+        {
+            std::uniform_real_distribution<double> dist(c.lo, c.hi);
+            for (double &v : x)
+                v = dist(rng);
+            set->fn1[size_t(c.f)](x.data(), fast.data(), n);
+            strict.fn1[size_t(c.f)](x.data(), exact.data(), n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                INFO(set->name << " " << func_info(c.f).name << "(" << x[i] << ")");
+                REQUIRE(UlpDistance(fast[i], exact[i]) <= c.max_ulp);
+            }
+        }
+}
+
+TEST_CASE("Fast pow error grows with the magnitude of b*ln(a)", "[simd]")
+{
+    std::mt19937_64 rng(11);
+    const size_t n = 50000;
+    std::vector<double> a(n), b(n), out(n);
+    std::uniform_real_distribution<double> base(0.01, 100.0), power(-700.0, 700.0);
+    for (const KernelSet *set : FastSets())
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            a[i] = base(rng);
+            b[i] = power(rng) / std::log(a[i]);
+        }
+        set->fn2[size_t(FuncId::POW)](a.data(), b.data(), out.data(), n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double y = std::fabs(b[i] * std::log(a[i]));
+            INFO(set->name << " pow(" << a[i] << ", " << b[i] << ")");
+            REQUIRE(UlpDistance(out[i], std::pow(a[i], b[i])) <= 2.0 + 2.0 * y);
+        }
+    }
+}
+
+TEST_CASE("Fast kernels fall back to libm outside the polynomial range", "[simd]")
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double den = std::numeric_limits<double>::denorm_min();
+    const std::vector<double> x = {inf, -inf, nan, 1e300, -3e7, den, 0.0, -0.0, 1e-310};
+    std::vector<double> fast(x.size()), exact(x.size());
+    const FuncId exact_funcs[] = {FuncId::SIN, FuncId::COS, FuncId::TAN, FuncId::LN, FuncId::LG};
+    for (const KernelSet *set : FastSets())
+        for (FuncId f : exact_funcs)
+        {
+            set->fn1[size_t(f)](x.data(), fast.data(), x.size());
+            strict_kernels().fn1[size_t(f)](x.data(), exact.data(), x.size());
+            for (size_t i = 0; i < x.size(); ++i)
+            {
+                INFO(set->name << " " << func_info(f).name << "(" << x[i] << ")");
+                // нули попадают в полиномиальную ветвь и дают ноль
+                if (x[i] == 0.0 && f != FuncId::LN && f != FuncId::LG)
+                    REQUIRE(UlpDistance(fast[i], exact[i]) == 0.0);
+                else
+                    REQUIRE(std::memcmp(&fast[i], &exact[i], sizeof(double)) == 0);
+            }
+        }
+
+    // дробные степени отрицательных оснований, нули и переполнение считает libm
+    const std::vector<double> a = {-8.0, 10.0, 0.0, 2.0, -0.0, -inf, nan};
+    const std::vector<double> b = {1.0 / 3.0, 400.0, 2.0, -1100.0, -3.0, 3.0, 0.0};
+    std::vector<double> out(a.size());
+    for (const KernelSet *set : FastSets())
+    {
+        set->fn2[size_t(FuncId::POW)](a.data(), b.data(), out.data(), a.size());
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            double expected = std::pow(a[i], b[i]);
+            INFO(set->name << " pow(" << a[i] << ", " << b[i] << ")");
+            REQUIRE(std::memcmp(&out[i], &expected, sizeof(double)) == 0);
+        }
+    }
+}
+
+TEST_CASE("Fast pow takes the sign of negative bases from integer exponents", "[simd]")
+{
+    const std::vector<double> a = {-2.0, -2.0, -1.5, -3.0, -10.0, -7.25};
+    const std::vector<double> b = {3.0, 2.0, -5.0, 1e16, 0.0, 31.0};
+    std::vector<double> out(a.size());
+    for (const KernelSet *set : FastSets())
+    {
+        set->fn2[size_t(FuncId::POW)](a.data(), b.data(), out.data(), a.size());
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            double expected = std::pow(a[i], b[i]);
+            INFO(set->name << " pow(" << a[i] << ", " << b[i] << ")");
+            REQUIRE(std::signbit(out[i]) == std::signbit(expected));
+            REQUIRE(UlpDistance(out[i], expected) <= 2.0 + 2.0 * std::fabs(b[i] * std::log(-a[i])));
+        }
+    }
+}
+
+TEST_CASE("Fast kernel results do not depend on position in the array", "[simd]")
+{
+    std::vector<double> x(37);
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = 0.37 * double(i) - 5.0;
+    for (const KernelSet *set : FastSets())
+    {
+        std::vector<double> whole(x.size());
+        set->fn1[size_t(FuncId::SIN)](x.data(), whole.data(), x.size());
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            double one = 0.0;
+            set->fn1[size_t(FuncId::SIN)](&x[i], &one, 1);
+            REQUIRE(std::memcmp(&one, &whole[i], sizeof(double)) == 0);
+        }
+        // на месте: out совпадает со входом
+        std::vector<double> inplace = x;
+        set->fn1[size_t(FuncId::SIN)](inplace.data(), inplace.data(), inplace.size());
+        REQUIRE(inplace == whole);
+    }
+}
+
+TEST_CASE("Batch evaluation picks the accuracy tier per compiled expression", "[simd]")
+{
+    const size_t rows = kBatchBlock + 77;
+    std::vector<double> xs(rows);
+    for (size_t r = 0; r < rows; ++r)
+        xs[r] = -1.5 + 3.0 * double(r) / double(rows);
+    xs[10] = 0.0; // ln(0) — ошибка строки на обоих уровнях
+
+    CompileOptions fast_options;
+    fast_options.accuracy = Accuracy::FAST;
+    const std::string expr = "sin(x)*cos(x)+ln(x)+x^2.5+atan(x)/2";
+    CompiledExpr strict(expr, {"x"});
+    CompiledExpr fast(expr, {"x"}, fast_options);
+    REQUIRE(strict.program().accuracy == Accuracy::STRICT);
+    REQUIRE(fast.program().accuracy == Accuracy::FAST);
+
+    const double *columns[] = {xs.data()};
+    std::vector<double> out_strict(rows), out_fast(rows);
+    std::vector<uint64_t> mask_strict(error_mask_words(rows)), mask_fast(error_mask_words(rows));
+    BatchEvaluator(strict.program()).evaluate(columns, rows, out_strict.data(), mask_strict.data());
+    BatchEvaluator(fast.program()).evaluate(columns, rows, out_fast.data(), mask_fast.data());
+
+    REQUIRE(mask_strict == mask_fast);
+    REQUIRE(row_failed(mask_fast.data(), 10));
+    for (size_t r = 0; r < rows; ++r)
+    {
+        INFO("row " << r);
+        if (row_failed(mask_strict.data(), r))
+            continue;
+        double value = 0.0;
+        REQUIRE(strict.try_evaluate(&xs[r], value) == ErrorCode::OK);
+        REQUIRE(std::memcmp(&out_strict[r], &value, sizeof(double)) == 0);
+        REQUIRE(std::fabs(out_fast[r] - value) <= 1e-13 * (1.0 + std::fabs(value)));
+    }
+}
+
+TEST_CASE("SIMD level can be limited but never raised above the detected one", "[simd]")
+{
+    SimdLevel detected = detected_simd_level();
+    REQUIRE(kernels_for_level(detected) != nullptr);
+    REQUIRE(kernels_for_level(SimdLevel::SCALAR) == &strict_kernels());
+
+    REQUIRE(limit_simd_level(SimdLevel::SCALAR) == SimdLevel::SCALAR);
+    REQUIRE(active_simd_level() == SimdLevel::SCALAR);
+    REQUIRE(&fast_kernels() == &strict_kernels());
+
+    REQUIRE(limit_simd_level(SimdLevel::AVX512) == detected);
+    REQUIRE(&fast_kernels() == kernels_for_level(detected));
+    REQUIRE(std::string(fast_kernels().name) == std::string(detected == SimdLevel::SCALAR ? "strict" : simd_level_name(detected)));
+
+    if (detected >= SimdLevel::AVX2)
+        REQUIRE(limit_simd_level(SimdLevel::SSE2) == SimdLevel::SSE2);
+    limit_simd_level(SimdLevel::AVX512);
+}
+
+TEST_CASE("SIMD level names round-trip", "[simd]")
+{
+    for (int l = 0; l < int(SimdLevel::COUNT); ++l)
+    {
+        SimdLevel parsed = SimdLevel::COUNT;
+        REQUIRE(parse_simd_level(simd_level_name(SimdLevel(l)), parsed));
+        REQUIRE(parsed == SimdLevel(l));
+    }
+    SimdLevel unused;
+    REQUIRE_FALSE(parse_simd_level("avx1024", unused));
+}
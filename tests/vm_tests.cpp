@@ -0,0 +1,79 @@
+#include "../src/engine/vm.hpp"
+#include "expr_fuzz.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+#include <string>
+
+namespace
+{
+    Outcome Vm(const Ast &ast)
+    {
+        double value = 0.0;
+        ErrorCode err = run(compile(ast), nullptr, value);
+        return FromErrorCode(err, value);
+    }
+} // namespace
+
+TEST_CASE("Bytecode uses explicit domain checks", "[vm]")
+{
+    Ast ast;
+    Parse("1/sqrt(2)", ast);
+    Program p = compile(ast);
+    int checks = 0;
+    for (const Instr &in : p.code)
+        if (in.op == OpCode::CHECK)
+            ++checks;
+    REQUIRE(checks == 2);
+    REQUIRE(p.code.back().op == OpCode::RET);
+    REQUIRE(p.max_stack == 2);
+}
+
+TEST_CASE("Compiled program is reusable", "[vm]")
+{
+    Ast ast;
+    Parse("sin(30')*2^10+pi/4", ast);
+    Program p = compile(ast);
+    double first = run_or_throw(p);
+    for (int i = 0; i < 100; ++i)
+        REQUIRE(run_or_throw(p) == first);
+    REQUIRE(first == evaluate(ast));
+}
+
+TEST_CASE("VM reports the same domain errors as the tree walk", "[vm]")
+{
+    const char *const cases[] = {"1/0", "0^0", "(-1)!", "2.5!", "171!", "asin(2)", "acos(-2)",
+                                 "sqrt(-1)", "ln(0)", "lg(-1)", "root(2,0)", "root(-8,2)",
+                                 "log(-1,2)", "log(8,1)", "tan(90')+1/0"};
+    for (const char *expr : cases)
+    {
+        Ast ast;
+        Parse(expr, ast);
+        Outcome tree = TreeWalk(ast);
+        Outcome vm = Vm(ast);
+        INFO(expr);
+        REQUIRE_FALSE(tree.ok);
+        REQUIRE(SameOutcome(tree, vm));
+    }
+}
+
+TEST_CASE("VM matches the tree walk on random expressions", "[vm]")
+{
+    std::mt19937 rng(12345);
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::string expr = RandomExpr(rng, 4);
+        Ast ast;
+        try
+        {
+            Parse(expr, ast);
+        }
+        catch (const std::exception &)
+        {
+            continue; // слишком длинные выражения
+        }
+        INFO(expr);
+        REQUIRE(SameOutcome(TreeWalk(ast), Vm(ast)));
+    }
+}